@@ -0,0 +1,680 @@
+#include "../src/Backend/BackendLogger.h"
+#include "../src/Backend/FrameArena.h"
+#include "../src/Backend/MemoryTracker.h"
+#include "../src/Backend/Profiler.h"
+#include "../src/Backend/ResourcePool.h"
+#include "../src/Renderer/Renderer.h"
+#include "../src/Renderer/Renderer2D.h"
+#include "../src/Renderer/RendererAPI.h"
+#include "../src/Renderer/FrameBuffer.h"
+#include "../src/Renderer/GLIntercept.h"
+#include "../src/Renderer/Texture.h"
+#include "../src/Scene/Scene.h"
+#include "../src/Scene/Entity.hpp"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <json.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Headless stress benchmark: builds procedural scenes, renders a fixed number of frames
+// into an offscreen framebuffer and prints the results as JSON.
+//
+//   gl_engine_bench [--scene all|sprites|quads|lights|characters] [--count N] [--frames N]
+//                   [--warmup N] [--width N] [--height N] [--output file.json]
+//
+// Frames end with glFinish(), so software rasterizers (Mesa llvmpipe) are measured end to end.
+
+namespace Utils {
+
+	struct BenchConfig
+	{
+		std::string SceneName = "all";
+		uint32_t Count = 10000;
+		uint32_t Frames = 300;
+		uint32_t Warmup = 30;
+		uint32_t Width = 1280;
+		uint32_t Height = 720;
+		std::string OutputPath;
+		bool GLStats = false;
+	};
+
+	// Deterministic so every run draws exactly the same thing
+	struct Random
+	{
+		uint32_t State = 0x9E3779B9u;
+
+		float Float()
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+			return (State >> 8) * (1.0f / 16777216.0f);
+		}
+
+		float Range(float min, float max) { return min + (max - min) * Float(); }
+	};
+
+	static double Percentile(const std::vector<double>& sorted, double percentile)
+	{
+		if (sorted.empty())
+			return 0.0;
+
+		double rank = percentile / 100.0 * (sorted.size() - 1);
+		size_t lower = (size_t)rank;
+		size_t upper = std::min(lower + 1, sorted.size() - 1);
+		return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+	}
+
+	static int64_t TotalBytes(const MemoryStats* stats, size_t count)
+	{
+		int64_t total = 0;
+		for (size_t i = 0; i < count; i++)
+			total += stats[i].CurrentBytes;
+		return total;
+	}
+
+	static Handle<Texture> CreateCheckerTexture(uint32_t size, uint32_t cell, uint32_t colorA, uint32_t colorB)
+	{
+		TextureSpecification spec;
+		spec.Width = size;
+		spec.Height = size;
+
+		std::vector<uint32_t> pixels(size * size);
+		for (uint32_t y = 0; y < size; y++)
+			for (uint32_t x = 0; x < size; x++)
+				pixels[y * size + x] = ((x / cell + y / cell) & 1) ? colorA : colorB;
+
+		Handle<Texture> texture = Texture::Create(spec);
+		texture->SetData(pixels.data(), (uint32_t)(pixels.size() * sizeof(uint32_t)));
+		return texture;
+	}
+
+	// Radial falloff used to splat lights additively
+	static Handle<Texture> CreateLightTexture(uint32_t size)
+	{
+		TextureSpecification spec;
+		spec.Width = size;
+		spec.Height = size;
+
+		std::vector<uint32_t> pixels(size * size);
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				float dx = (x + 0.5f) / size * 2.0f - 1.0f;
+				float dy = (y + 0.5f) / size * 2.0f - 1.0f;
+				float falloff = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+				uint32_t alpha = (uint32_t)(falloff * falloff * 255.0f);
+				pixels[y * size + x] = (alpha << 24) | 0x00FFFFFFu;
+			}
+		}
+
+		Handle<Texture> texture = Texture::Create(spec);
+		texture->SetData(pixels.data(), (uint32_t)(pixels.size() * sizeof(uint32_t)));
+		return texture;
+	}
+
+	static bool ParseNumber(const char* arg, const char* value, uint32_t& result)
+	{
+		const char* end = value + strlen(value);
+		auto [last, error] = std::from_chars(value, end, result);
+		if (error != std::errc() || last != end)
+		{
+			std::cerr << "Invalid value " << value << " for " << arg << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	static bool ParseArgs(int argc, char** argv, BenchConfig& config)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+			if (!strcmp(arg, "--help") || !strcmp(arg, "-h"))
+				return false;
+			if (!strcmp(arg, "--gl-stats"))
+			{
+				config.GLStats = true;
+				continue;
+			}
+			if (!value)
+			{
+				std::cerr << "Missing value for " << arg << "\n";
+				return false;
+			}
+
+			if (!strcmp(arg, "--scene"))        config.SceneName = value;
+			else if (!strcmp(arg, "--count"))   { if (!ParseNumber(arg, value, config.Count)) return false; }
+			else if (!strcmp(arg, "--frames"))  { if (!ParseNumber(arg, value, config.Frames)) return false; }
+			else if (!strcmp(arg, "--warmup"))  { if (!ParseNumber(arg, value, config.Warmup)) return false; }
+			else if (!strcmp(arg, "--width"))   { if (!ParseNumber(arg, value, config.Width)) return false; }
+			else if (!strcmp(arg, "--height"))  { if (!ParseNumber(arg, value, config.Height)) return false; }
+			else if (!strcmp(arg, "--output"))  config.OutputPath = value;
+			else
+			{
+				std::cerr << "Unknown argument " << arg << "\n";
+				return false;
+			}
+			i++;
+		}
+
+		return config.Frames > 0 && config.Count > 0 && config.Width > 0 && config.Height > 0;
+	}
+}
+
+struct BenchScene
+{
+	virtual ~BenchScene() = default;
+
+	virtual const char* GetName() const = 0;
+	virtual void Build(uint32_t count) = 0;
+	virtual void Render(float time, EditorCamera& camera) = 0;
+};
+
+// N colored sprite entities rendered through Scene, the editor path
+struct SpriteBench : BenchScene
+{
+	const char* GetName() const override { return "sprites"; }
+
+	void Build(uint32_t count) override
+	{
+		m_Scene = CreateRef<Scene>();
+
+		Utils::Random random;
+		uint32_t side = (uint32_t)std::ceil(std::sqrt((float)count));
+		float spacing = 8.0f / side;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Entity entity = m_Scene->CreateEntity("Sprite");
+			auto& transform = entity.GetComponent<TransformComponent>();
+			transform.Position = { (i % side) * spacing - 4.0f, (i / side) * spacing - 4.0f, 0.0f };
+			transform.Scale = glm::vec3(spacing * 0.9f);
+			entity.AddComponent<SpriteComponent>(glm::vec4(random.Float(), random.Float(), random.Float(), 1.0f));
+		}
+	}
+
+	void Render(float time, EditorCamera& camera) override
+	{
+		m_Scene->OnUpdateEditor(DeltaTime(), camera);
+	}
+
+private:
+	Ref<Scene> m_Scene;
+};
+
+// N textured quads submitted straight to Renderer2D, cycling through more textures than one batch holds
+struct TexturedQuadBench : BenchScene
+{
+	static constexpr uint32_t TextureCount = 48;
+
+	const char* GetName() const override { return "quads"; }
+
+	~TexturedQuadBench() override
+	{
+		for (auto texture : m_Textures)
+			Texture::Destroy(texture);
+	}
+
+	void Build(uint32_t count) override
+	{
+		Utils::Random random;
+		for (uint32_t i = 0; i < TextureCount; i++)
+		{
+			uint32_t color = 0xFF000000u | ((uint32_t)(random.Float() * 0xFFFFFF));
+			m_Textures.push_back(Utils::CreateCheckerTexture(64, 8 << (i % 3), color, 0xFFFFFFFFu));
+		}
+
+		uint32_t side = (uint32_t)std::ceil(std::sqrt((float)count));
+		float spacing = 8.0f / side;
+		m_Quads.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_Quads[i].Position = { (i % side) * spacing - 4.0f, (i / side) * spacing - 4.0f, 0.0f };
+			m_Quads[i].Size = glm::vec2(spacing * 0.9f);
+			m_Quads[i].Rotation = random.Range(0.0f, 6.2831853f);
+			m_Quads[i].TextureIndex = i % TextureCount;
+		}
+	}
+
+	void Render(float time, EditorCamera& camera) override
+	{
+		Renderer2D::BeginScene(camera);
+		for (const auto& quad : m_Quads)
+			Renderer2D::DrawRotatedQuad(quad.Position, quad.Size, quad.Rotation + time, m_Textures[quad.TextureIndex]);
+		Renderer2D::EndScene();
+	}
+
+private:
+	struct Quad
+	{
+		glm::vec3 Position;
+		glm::vec2 Size;
+		float Rotation;
+		uint32_t TextureIndex;
+	};
+
+	std::vector<Handle<Texture>> m_Textures;
+	std::vector<Quad> m_Quads;
+};
+
+// N moving point lights splatted additively over a backdrop
+struct LightBench : BenchScene
+{
+	const char* GetName() const override { return "lights"; }
+
+	~LightBench() override
+	{
+		Texture::Destroy(m_LightTexture);
+		Texture::Destroy(m_FloorTexture);
+	}
+
+	void Build(uint32_t count) override
+	{
+		m_LightTexture = Utils::CreateLightTexture(128);
+		m_FloorTexture = Utils::CreateCheckerTexture(256, 16, 0xFF303030u, 0xFF505050u);
+
+		Utils::Random random;
+		m_Lights.resize(count);
+		for (auto& light : m_Lights)
+		{
+			light.Center = { random.Range(-4.0f, 4.0f), random.Range(-4.0f, 4.0f) };
+			light.Orbit = random.Range(0.1f, 1.0f);
+			light.Speed = random.Range(0.5f, 2.0f);
+			light.Radius = random.Range(0.3f, 1.2f);
+			light.Color = { random.Float(), random.Float(), random.Float(), 1.0f };
+		}
+	}
+
+	void Render(float time, EditorCamera& camera) override
+	{
+		Renderer2D::BeginScene(camera);
+		Renderer2D::DrawQuad(glm::vec3(0.0f, 0.0f, -0.01f), glm::vec2(8.0f), m_FloorTexture, 8.0f);
+		Renderer2D::EndScene();
+
+		RendererAPI::SetBlendFunc(GL_SRC_ALPHA, GL_ONE);
+		RendererAPI::SetDepthWrite(false);
+
+		Renderer2D::BeginScene(camera);
+		for (const auto& light : m_Lights)
+		{
+			float angle = time * light.Speed;
+			glm::vec3 position = { light.Center.x + std::cos(angle) * light.Orbit, light.Center.y + std::sin(angle) * light.Orbit, 0.0f };
+			Renderer2D::DrawQuad(position, glm::vec2(light.Radius * 2.0f), m_LightTexture, 1.0f, light.Color);
+		}
+		Renderer2D::EndScene();
+
+		RendererAPI::SetDepthWrite(true);
+		RendererAPI::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+private:
+	struct Light
+	{
+		glm::vec2 Center;
+		float Orbit;
+		float Speed;
+		float Radius;
+		glm::vec4 Color;
+	};
+
+	Handle<Texture> m_LightTexture;
+	Handle<Texture> m_FloorTexture;
+	std::vector<Light> m_Lights;
+};
+
+// N articulated characters (torso, head, two arms, two legs) whose limbs are animated
+// every frame through their TransformComponents before the scene is rendered
+struct CharacterBench : BenchScene
+{
+	static constexpr uint32_t PartsPerCharacter = 6;
+
+	const char* GetName() const override { return "characters"; }
+
+	void Build(uint32_t count) override
+	{
+		m_Scene = CreateRef<Scene>();
+
+		static const glm::vec3 s_Offsets[PartsPerCharacter] = {
+			{ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.65f, 0.0f },
+			{ -0.4f, 0.05f, 0.0f }, { 0.4f, 0.05f, 0.0f },
+			{ -0.15f, -0.7f, 0.0f }, { 0.15f, -0.7f, 0.0f }
+		};
+		static const glm::vec3 s_Scales[PartsPerCharacter] = {
+			{ 0.5f, 0.8f, 1.0f }, { 0.35f, 0.35f, 1.0f },
+			{ 0.15f, 0.6f, 1.0f }, { 0.15f, 0.6f, 1.0f },
+			{ 0.18f, 0.65f, 1.0f }, { 0.18f, 0.65f, 1.0f }
+		};
+
+		Utils::Random random;
+		uint32_t side = (uint32_t)std::ceil(std::sqrt((float)count));
+		float spacing = 8.0f / side;
+		m_Characters.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto& character = m_Characters[i];
+			character.Origin = { (i % side) * spacing - 4.0f, (i / side) * spacing - 4.0f, 0.0f };
+			character.Scale = spacing * 0.45f;
+			character.Phase = random.Range(0.0f, 6.2831853f);
+
+			glm::vec4 color = { random.Float(), random.Float(), random.Float(), 1.0f };
+			for (uint32_t part = 0; part < PartsPerCharacter; part++)
+			{
+				Entity entity = m_Scene->CreateEntity("Part");
+				auto& transform = entity.GetComponent<TransformComponent>();
+				transform.Scale = s_Scales[part] * character.Scale;
+				character.Offsets[part] = s_Offsets[part] * character.Scale;
+				character.Parts[part] = entity;
+				entity.AddComponent<SpriteComponent>(color);
+			}
+		}
+	}
+
+	void Render(float time, EditorCamera& camera) override
+	{
+		for (auto& character : m_Characters)
+		{
+			float swing = std::sin(time * 4.0f + character.Phase) * 0.6f;
+			float bob = std::abs(std::sin(time * 4.0f + character.Phase)) * 0.1f * character.Scale;
+			const float rotations[PartsPerCharacter] = { 0.0f, swing * 0.2f, swing, -swing, -swing, swing };
+
+			for (uint32_t part = 0; part < PartsPerCharacter; part++)
+			{
+				auto& transform = character.Parts[part].GetComponent<TransformComponent>();
+				transform.Position = character.Origin + character.Offsets[part] + glm::vec3(0.0f, bob, 0.0f);
+				transform.Rotation.z = rotations[part];
+			}
+		}
+
+		m_Scene->OnUpdateEditor(DeltaTime(), camera);
+	}
+
+private:
+	struct Character
+	{
+		glm::vec3 Origin;
+		float Scale;
+		float Phase;
+		Entity Parts[PartsPerCharacter];
+		glm::vec3 Offsets[PartsPerCharacter];
+	};
+
+	Ref<Scene> m_Scene;
+	std::vector<Character> m_Characters;
+};
+
+static Scope<BenchScene> CreateBenchScene(const std::string& name)
+{
+	if (name == "sprites")    return CreateScope<SpriteBench>();
+	if (name == "quads")      return CreateScope<TexturedQuadBench>();
+	if (name == "lights")     return CreateScope<LightBench>();
+	if (name == "characters") return CreateScope<CharacterBench>();
+	return nullptr;
+}
+
+static nlohmann::json MemoryToJson(const MemorySnapshot& snapshot)
+{
+	nlohmann::json memory;
+	for (size_t i = 0; i < (size_t)MemoryTag::Count; i++)
+		memory["cpu"][MemoryTracker::TagToString((MemoryTag)i)] = { { "current", snapshot.CPU[i].CurrentBytes }, { "peak", snapshot.CPU[i].PeakBytes } };
+	for (size_t i = 0; i < (size_t)GPUMemoryKind::Count; i++)
+		memory["gpu"][MemoryTracker::GPUKindToString((GPUMemoryKind)i)] = { { "current", snapshot.GPU[i].CurrentBytes }, { "peak", snapshot.GPU[i].PeakBytes } };
+	memory["cpuTotal"] = Utils::TotalBytes(snapshot.CPU, (size_t)MemoryTag::Count);
+	memory["gpuTotal"] = Utils::TotalBytes(snapshot.GPU, (size_t)GPUMemoryKind::Count);
+	return memory;
+}
+
+static nlohmann::json RunBenchScene(BenchScene& scene, const Utils::BenchConfig& config, Handle<Framebuffer> framebuffer)
+{
+	using Clock = std::chrono::steady_clock;
+
+	EditorCamera camera(45.0f, (float)config.Width / config.Height, 0.1f, 1000.0f);
+	camera.SetViewportSize((float)config.Width, (float)config.Height);
+
+	MemorySnapshot before = MemoryTracker::TakeSnapshot();
+	auto buildStart = Clock::now();
+	scene.Build(config.Count);
+	glFinish();
+	double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(config.Frames);
+	uint64_t drawCalls = 0, quads = 0, stateCalls = 0, redundantStateCalls = 0;
+	uint64_t glCalls = 0, glBytes = 0;
+	std::map<std::string, std::pair<uint64_t, uint64_t>> glZones, glFunctions;
+
+	// Fixed time step, results must not depend on how fast the machine is
+	const float timeStep = 1.0f / 60.0f;
+	for (uint32_t frame = 0; frame < config.Warmup + config.Frames; frame++)
+	{
+		auto frameStart = Clock::now();
+
+		Profiler::BeginFrame();
+		RendererAPI::BeginGPUFrame();
+		FrameArena::BeginFrame();
+		ResourcePools::CollectGarbage();
+
+		Renderer2D::ResetStats();
+		framebuffer->Bind();
+		RendererAPI::SetClearColor({ 0.1f, 0.1f, 0.1f, 1.0f });
+		RendererAPI::Clear();
+
+		{
+			GABGL_PROFILE_SCOPE(scene.GetName());
+			scene.Render(frame * timeStep, camera);
+		}
+
+		framebuffer->Unbind();
+		glFinish();
+		RendererAPI::EndStateFrame();
+		GLIntercept::EndFrame();
+
+		double frameMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+		if (frame < config.Warmup)
+			continue;
+
+		frameTimes.push_back(frameMs);
+		drawCalls += Renderer2D::GetStats().DrawCalls;
+		quads += Renderer2D::GetStats().QuadCount;
+		stateCalls += RendererAPI::GetStateStats().GetTotalIssued();
+		redundantStateCalls += RendererAPI::GetStateStats().GetTotalSkipped();
+
+		const GLFrameStats& glFrame = GLIntercept::GetLastFrame();
+		glCalls += glFrame.Calls;
+		glBytes += glFrame.Bytes;
+		for (const auto& zone : glFrame.Zones)
+		{
+			auto& totals = glZones[zone.Zone];
+			totals.first += zone.Calls;
+			totals.second += zone.Bytes;
+		}
+		for (const auto& function : glFrame.Functions)
+		{
+			auto& totals = glFunctions[function.Name];
+			totals.first += function.Calls;
+			totals.second += function.Bytes;
+		}
+	}
+
+	MemorySnapshot after = MemoryTracker::TakeSnapshot();
+
+	std::vector<double> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	double total = 0.0;
+	for (double time : frameTimes)
+		total += time;
+
+	nlohmann::json result;
+	result["scene"] = scene.GetName();
+	result["count"] = config.Count;
+	result["frames"] = config.Frames;
+	result["buildMs"] = buildMs;
+	result["frameMs"] = {
+		{ "mean", total / frameTimes.size() },
+		{ "min", sorted.front() },
+		{ "p50", Utils::Percentile(sorted, 50.0) },
+		{ "p90", Utils::Percentile(sorted, 90.0) },
+		{ "p95", Utils::Percentile(sorted, 95.0) },
+		{ "p99", Utils::Percentile(sorted, 99.0) },
+		{ "max", sorted.back() }
+	};
+	result["fps"] = 1000.0 * frameTimes.size() / total;
+	result["drawCallsPerFrame"] = (double)drawCalls / frameTimes.size();
+	result["quadsPerFrame"] = (double)quads / frameTimes.size();
+	result["stateCallsPerFrame"] = (double)stateCalls / frameTimes.size();
+	result["redundantStateCallsPerFrame"] = (double)redundantStateCalls / frameTimes.size();
+	if (GLIntercept::IsInstalled())
+	{
+		// Per-frame averages, by profiler zone and by entry point
+		auto perFrame = [&](const std::map<std::string, std::pair<uint64_t, uint64_t>>& totals)
+		{
+			nlohmann::json json = nlohmann::json::object();
+			for (const auto& [name, counts] : totals)
+				json[name] = { { "calls", (double)counts.first / frameTimes.size() }, { "bytes", (double)counts.second / frameTimes.size() } };
+			return json;
+		};
+
+		result["gl"] = {
+			{ "callsPerFrame", (double)glCalls / frameTimes.size() },
+			{ "bytesPerFrame", (double)glBytes / frameTimes.size() },
+			{ "zones", perFrame(glZones) },
+			{ "functions", perFrame(glFunctions) }
+		};
+	}
+	result["memory"] = MemoryToJson(after);
+	result["memoryDelta"] = {
+		{ "cpu", Utils::TotalBytes(after.CPU, (size_t)MemoryTag::Count) - Utils::TotalBytes(before.CPU, (size_t)MemoryTag::Count) },
+		{ "gpu", Utils::TotalBytes(after.GPU, (size_t)GPUMemoryKind::Count) - Utils::TotalBytes(before.GPU, (size_t)GPUMemoryKind::Count) }
+	};
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	Utils::BenchConfig config;
+	if (!Utils::ParseArgs(argc, argv, config))
+	{
+		std::cerr << "usage: gl_engine_bench [--scene all|sprites|quads|lights|characters] [--count N] [--frames N] [--warmup N] [--width N] [--height N] [--output file.json] [--gl-stats]\n";
+		return 1;
+	}
+
+	// Without --output the JSON report is stdout, log lines must not end up in it
+	Log::Init(config.OutputPath.empty());
+	Profiler::SetThreadName("Main");
+	FrameArena::Init();
+
+	if (!glfwInit())
+	{
+		std::cerr << "Failed to initialize GLFW\n";
+		return 1;
+	}
+
+	// A hidden window is the only portable way to get a context out of GLFW 3.3,
+	// everything is rendered into an offscreen framebuffer anyway
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(64, 64, "gl_engine_bench", nullptr, nullptr);
+	if (!window)
+	{
+		std::cerr << "Failed to create an OpenGL 4.5 context\n";
+		glfwTerminate();
+		return 1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cerr << "Failed to initialize Glad\n";
+		glfwTerminate();
+		return 1;
+	}
+	// Counting every call costs a little per call, frame times are only comparable between runs with the same setting
+	GLIntercept::SetEnabled(config.GLStats);
+	GLIntercept::Install();
+
+	Renderer::Init();
+	// Scenes are measured with the real shaders, not the placeholder
+	Shader::WaitForPending();
+
+	FramebufferSpecification fbSpec;
+	fbSpec.Attachments = { FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER, FramebufferTextureFormat::Depth };
+	fbSpec.Width = config.Width;
+	fbSpec.Height = config.Height;
+	Handle<Framebuffer> framebuffer = Framebuffer::Create(fbSpec);
+	RendererAPI::SetViewport(0, 0, config.Width, config.Height);
+
+	nlohmann::json report;
+	report["renderer"] = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	report["version"] = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	report["width"] = config.Width;
+	report["height"] = config.Height;
+	report["warmup"] = config.Warmup;
+	report["results"] = nlohmann::json::array();
+
+	const char* sceneNames[] = { "sprites", "quads", "lights", "characters" };
+	bool ran = false;
+	for (const char* name : sceneNames)
+	{
+		if (config.SceneName != "all" && config.SceneName != name)
+			continue;
+
+		Scope<BenchScene> scene = CreateBenchScene(name);
+		report["results"].push_back(RunBenchScene(*scene, config, framebuffer));
+		scene.reset();
+
+		// Let the deferred destructions of this scene go through before the next one is measured
+		for (uint32_t i = 0; i <= ResourcePools::FramesInFlight; i++)
+			ResourcePools::CollectGarbage();
+		ran = true;
+	}
+
+	int exitCode = 0;
+	if (!ran)
+	{
+		std::cerr << "Unknown scene " << config.SceneName << "\n";
+		exitCode = 1;
+	}
+	else if (!config.OutputPath.empty())
+	{
+		std::ofstream file(config.OutputPath);
+		if (file.is_open())
+			file << report.dump(4) << "\n";
+		else
+		{
+			std::cerr << "Could not write " << config.OutputPath << "\n";
+			exitCode = 1;
+		}
+	}
+	else
+		std::cout << report.dump(4) << "\n";
+
+	Framebuffer::Destroy(framebuffer);
+	ResourcePools::Shutdown();
+	Renderer::Shutdown();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	FrameArena::Shutdown();
+	Log::Shutdown();
+
+	return exitCode;
+}
@@ -0,0 +1,612 @@
+#include "../src/Backend/BackendLogger.h"
+#include "../src/Backend/OffsetAllocator.h"
+#include "../src/Renderer/BlockCompression.h"
+#include "../src/Renderer/ImageKernels.h"
+#include "../src/Renderer/Renderer2D.h"
+#include "../src/Renderer/Shader.h"
+#include "../src/Scene/Scene.h"
+#include "../src/Scene/Entity.hpp"
+#include "../src/Scene/Components.hpp"
+
+#include "../srcOG/Managers/AnimationSystem.h"
+#include "../srcOG/Managers/MeshOptimize.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <json.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// CPU-only microbenchmarks for engine hot paths, no GL context is created.
+//
+//   gl_engine_microbench [--filter text] [--min-time ms] [--res path] [--output file.json]
+//
+// Every benchmark runs at several sizes; a setup step (not timed) builds the input for a
+// size and returns the operation to time. Results are the median of several timed batches.
+
+namespace Utils {
+
+	struct MicroBenchConfig
+	{
+		std::string Filter;
+		double MinTimeMs = 50.0;
+		std::string ResPath = "../res";
+		std::string OutputPath;
+	};
+
+	using RunFn = std::function<void()>;
+	using SetupFn = std::function<RunFn(uint32_t size)>;
+
+	struct MicroBenchmark
+	{
+		std::string Name;
+		std::vector<uint32_t> Sizes;
+		SetupFn Setup;
+	};
+
+	// Results are folded in here so the compiler can't drop the work being measured
+	static volatile uint64_t s_Sink = 0;
+
+	template<typename T>
+	inline void Consume(const T& value)
+	{
+		uint8_t bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		s_Sink = s_Sink + bytes[0] + bytes[sizeof(T) - 1];
+	}
+
+	// Deterministic so every run measures the same input
+	struct Random
+	{
+		uint32_t State = 0x9E3779B9u;
+
+		uint32_t Next()
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+			return State;
+		}
+
+		float Range(float min, float max) { return min + (max - min) * ((Next() >> 8) * (1.0f / 16777216.0f)); }
+	};
+
+	// Square image of gradients with noise, like a photo more than like flat test colors
+	static Ref<std::vector<uint8_t>> CreateTestImage(uint32_t size, uint32_t channels)
+	{
+		Random random;
+		auto pixels = CreateRef<std::vector<uint8_t>>((size_t)size * size * channels);
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				uint8_t* pixel = pixels->data() + ((size_t)y * size + x) * channels;
+				for (uint32_t c = 0; c < channels; c++)
+					pixel[c] = (uint8_t)(((c & 1 ? y : x) * 240 / size) + random.Next() % 16);
+			}
+		}
+		return pixels;
+	}
+
+	static std::string ReadFile(const std::string& path)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+			return {};
+
+		std::stringstream stream;
+		stream << file.rdbuf();
+		return stream.str();
+	}
+
+	static bool ParseNumber(const char* arg, const char* value, double& result)
+	{
+		const char* end = value + strlen(value);
+		auto [last, error] = std::from_chars(value, end, result);
+		if (error != std::errc() || last != end)
+		{
+			std::cerr << "Invalid value " << value << " for " << arg << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	static bool ParseArgs(int argc, char** argv, MicroBenchConfig& config)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+			if (!strcmp(arg, "--help") || !strcmp(arg, "-h"))
+				return false;
+			if (!value)
+			{
+				std::cerr << "Missing value for " << arg << "\n";
+				return false;
+			}
+
+			if (!strcmp(arg, "--filter"))         config.Filter = value;
+			else if (!strcmp(arg, "--min-time"))  { if (!ParseNumber(arg, value, config.MinTimeMs)) return false; }
+			else if (!strcmp(arg, "--res"))       config.ResPath = value;
+			else if (!strcmp(arg, "--output"))    config.OutputPath = value;
+			else
+			{
+				std::cerr << "Unknown argument " << arg << "\n";
+				return false;
+			}
+			i++;
+		}
+
+		return config.MinTimeMs > 0.0;
+	}
+}
+
+// Skinned clip shared by the animation benchmarks, loaded once without any GL
+struct AnimationClip
+{
+	std::map<std::string, BoneInfo> BoneInfoMap;
+	int BoneCount = 0;
+	std::vector<Bone> Bones;
+	float Duration = 0.0f;
+	Scope<AnimationSystem> System;
+
+	bool Load(const std::string& path)
+	{
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate);
+		if (!scene || !scene->mRootNode || !scene->mNumAnimations)
+			return false;
+
+		// Same bone table AnimatedMesh builds while loading the skinned meshes
+		for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+		{
+			const aiMesh* mesh = scene->mMeshes[m];
+			for (unsigned int b = 0; b < mesh->mNumBones; b++)
+			{
+				std::string name = mesh->mBones[b]->mName.C_Str();
+				if (BoneInfoMap.find(name) != BoneInfoMap.end())
+					continue;
+
+				BoneInfoMap[name] = { BoneCount++, AssimpGLMHelpers::ConvertMatrixToGLMFormat(mesh->mBones[b]->mOffsetMatrix) };
+			}
+		}
+
+		const aiAnimation* animation = scene->mAnimations[0];
+		for (unsigned int c = 0; c < animation->mNumChannels; c++)
+			Bones.emplace_back(animation->mChannels[c]->mNodeName.C_Str(), (int)c, animation->mChannels[c]);
+		Duration = (float)animation->mDuration;
+
+		System = CreateScope<AnimationSystem>(path, BoneInfoMap, BoneCount);
+		return true;
+	}
+};
+
+static std::vector<Utils::MicroBenchmark> CreateBenchmarks(const Utils::MicroBenchConfig& config, AnimationClip* clip)
+{
+	std::vector<Utils::MicroBenchmark> benchmarks;
+
+	if (clip)
+	{
+		// Size = number of animated characters sampling the same clip
+		benchmarks.push_back({ "Bone::Update", { 1, 16, 128 }, [clip](uint32_t size) -> Utils::RunFn
+		{
+			auto bones = CreateRef<std::vector<Bone>>();
+			for (uint32_t i = 0; i < size; i++)
+				bones->insert(bones->end(), clip->Bones.begin(), clip->Bones.end());
+
+			float duration = clip->Duration;
+			return [bones, duration, time = 0.0f]() mutable
+			{
+				time = std::fmod(time + duration * 0.0137f, duration);
+				for (auto& bone : *bones)
+					bone.Update(time);
+				Utils::Consume(bones->back().GetLocalTransform());
+			};
+		} });
+
+		benchmarks.push_back({ "AnimationSystem::CalculateBoneTransform", { 1, 16, 128 }, [clip](uint32_t size) -> Utils::RunFn
+		{
+			auto systems = CreateRef<std::vector<AnimationSystem>>(size, *clip->System);
+			return [systems]()
+			{
+				for (auto& system : *systems)
+				{
+					system.UpdateAnimation(1.0f / 60.0f);
+					Utils::Consume(system.GetFinalBoneMatrices().front());
+				}
+			};
+		} });
+	}
+
+	benchmarks.push_back({ "TransformComponent::GetTransform", { 1000, 10000, 100000 }, [](uint32_t size) -> Utils::RunFn
+	{
+		Utils::Random random;
+		auto transforms = CreateRef<std::vector<TransformComponent>>(size);
+		for (auto& transform : *transforms)
+		{
+			transform.Position = { random.Range(-100.0f, 100.0f), random.Range(-100.0f, 100.0f), random.Range(-100.0f, 100.0f) };
+			transform.Rotation = { random.Range(-3.0f, 3.0f), random.Range(-3.0f, 3.0f), random.Range(-3.0f, 3.0f) };
+			transform.Scale = glm::vec3(random.Range(0.5f, 2.0f));
+		}
+
+		return [transforms]()
+		{
+			glm::mat4 sum(0.0f);
+			for (const auto& transform : *transforms)
+				sum += transform.GetTransform();
+			Utils::Consume(sum);
+		};
+	} });
+
+	benchmarks.push_back({ "Renderer2D::WriteQuadVertices", { 1000, 10000, 100000 }, [](uint32_t size) -> Utils::RunFn
+	{
+		Utils::Random random;
+		auto transforms = CreateRef<std::vector<glm::mat4>>(size);
+		for (auto& transform : *transforms)
+		{
+			TransformComponent component;
+			component.Position = { random.Range(-10.0f, 10.0f), random.Range(-10.0f, 10.0f), 0.0f };
+			component.Rotation.z = random.Range(-3.0f, 3.0f);
+			transform = component.GetTransform();
+		}
+
+		auto vertices = CreateRef<std::vector<QuadVertex>>(size * 4);
+		return [transforms, vertices]()
+		{
+			QuadVertex* vertex = vertices->data();
+			for (uint32_t i = 0; i < transforms->size(); i++, vertex += 4)
+				Renderer2D::WriteQuadVertices(vertex, (*transforms)[i], glm::vec4(1.0f), 0.0f, 1.0f, (int)i);
+			Utils::Consume(vertices->back().Position);
+		};
+	} });
+
+	// Includes destroying the copy, the editor does both on every play/stop
+	benchmarks.push_back({ "Scene::Copy", { 10000, 100000 }, [](uint32_t size) -> Utils::RunFn
+	{
+		Utils::Random random;
+		auto scene = CreateRef<Scene>();
+		for (uint32_t i = 0; i < size; i++)
+		{
+			Entity entity = scene->CreateEntity("Entity");
+			entity.GetComponent<TransformComponent>().Position = { random.Range(-100.0f, 100.0f), random.Range(-100.0f, 100.0f), 0.0f };
+			if (i % 2 == 0)
+				entity.AddComponent<SpriteComponent>(glm::vec4(1.0f));
+		}
+
+		return [scene]()
+		{
+			Ref<Scene> copy = Scene::Copy(scene);
+			Utils::Consume(copy.get());
+		};
+	} });
+
+	// Size = number of "#type" sections, built by repeating the 2D quad shader
+	std::string shaderSource = Utils::ReadFile(config.ResPath + "/shaders/Renderer2D_Quad.glsl");
+	if (!shaderSource.empty())
+	{
+		benchmarks.push_back({ "Shader::ParseSources", { 2, 32, 512 }, [shaderSource](uint32_t size) -> Utils::RunFn
+		{
+			auto source = CreateRef<std::string>();
+			for (uint32_t i = 0; i < size / 2; i++)
+				*source += shaderSource;
+
+			return [source]()
+			{
+				auto sections = Shader::ParseSources(*source);
+				Utils::Consume(sections.size());
+			};
+		} });
+	}
+	else
+		std::cerr << "Skipping Shader::ParseSources, could not read " << config.ResPath << "/shaders/Renderer2D_Quad.glsl\n";
+
+	// Size = vertex count of a jittered grid whose triangles are shuffled
+	benchmarks.push_back({ "Mesh::optimizeMesh", { 1024, 16384, 262144 }, [](uint32_t size) -> Utils::RunFn
+	{
+		Utils::Random random;
+		uint32_t side = (uint32_t)std::sqrt((float)size);
+
+		std::vector<Vertex> vertices(side * side);
+		for (uint32_t y = 0; y < side; y++)
+		{
+			for (uint32_t x = 0; x < side; x++)
+			{
+				Vertex& vertex = vertices[y * side + x];
+				std::memset(&vertex, 0, sizeof(Vertex));
+				vertex.Position = { (float)x, random.Range(-0.5f, 0.5f), (float)y };
+				vertex.Normal = { 0.0f, 1.0f, 0.0f };
+				vertex.TexCoords = { (float)x / side, (float)y / side };
+			}
+		}
+
+		std::vector<uint32_t> triangles;
+		for (uint32_t y = 0; y + 1 < side; y++)
+		{
+			for (uint32_t x = 0; x + 1 < side; x++)
+			{
+				uint32_t i = y * side + x;
+				triangles.insert(triangles.end(), { i, i + side, i + 1, i + 1, i + side, i + side + 1 });
+			}
+		}
+		for (size_t t = triangles.size() / 3; t > 1; t--)
+		{
+			size_t other = random.Next() % t;
+			for (size_t k = 0; k < 3; k++)
+				std::swap(triangles[(t - 1) * 3 + k], triangles[other * 3 + k]);
+		}
+
+		auto sourceVertices = CreateRef<std::vector<Vertex>>(std::move(vertices));
+		auto sourceIndices = CreateRef<std::vector<uint32_t>>(std::move(triangles));
+		return [sourceVertices, sourceIndices]()
+		{
+			std::vector<Vertex> vertices = *sourceVertices;
+			std::vector<unsigned int> indices = *sourceIndices;
+			optimizeMesh(vertices, indices);
+			Utils::Consume(indices.front());
+		};
+	} });
+
+	// Mesh-sized ranges allocated and then freed in random order, the pattern the geometry buffer sees
+	benchmarks.push_back({ "OffsetAllocator::AllocateFree", { 1000, 10000, 100000 }, [](uint32_t size) -> Utils::RunFn
+	{
+		Utils::Random random;
+		auto sizes = CreateRef<std::vector<uint32_t>>(size);
+		for (auto& rangeSize : *sizes)
+			rangeSize = 16 + random.Next() % 4096;
+
+		auto freeOrder = CreateRef<std::vector<uint32_t>>(size);
+		for (uint32_t i = 0; i < size; i++)
+			(*freeOrder)[i] = i;
+		for (uint32_t i = size; i > 1; i--)
+			std::swap((*freeOrder)[i - 1], (*freeOrder)[random.Next() % i]);
+
+		auto allocator = CreateRef<OffsetAllocator>(size * 4096u);
+		auto allocations = CreateRef<std::vector<OffsetAllocation>>(size);
+		return [sizes, freeOrder, allocator, allocations]()
+		{
+			for (size_t i = 0; i < sizes->size(); i++)
+				(*allocations)[i] = allocator->Allocate((*sizes)[i]);
+			for (uint32_t i : *freeOrder)
+				allocator->Free((*allocations)[i]);
+			Utils::Consume(allocator->GetLargestFree());
+		};
+	} });
+
+	// Size = side of a square RGBA image, gradients with noise so endpoint fitting has work to do
+	for (TextureCompression compression : { TextureCompression::BC1, TextureCompression::BC7 })
+	{
+		const char* name = compression == TextureCompression::BC1 ? "BlockCompression::EncodeBC1" : "BlockCompression::EncodeBC7";
+		benchmarks.push_back({ name, { 64, 256, 1024 }, [compression](uint32_t size) -> Utils::RunFn
+		{
+			Utils::Random random;
+			auto pixels = CreateRef<std::vector<uint8_t>>((size_t)size * size * 4);
+			for (uint32_t y = 0; y < size; y++)
+			{
+				for (uint32_t x = 0; x < size; x++)
+				{
+					uint8_t* pixel = pixels->data() + ((size_t)y * size + x) * 4;
+					pixel[0] = (uint8_t)(x * 240 / size + random.Next() % 16);
+					pixel[1] = (uint8_t)(y * 240 / size + random.Next() % 16);
+					pixel[2] = (uint8_t)((x + y) * 127 / size);
+					pixel[3] = 255;
+				}
+			}
+
+			auto output = CreateRef<std::vector<uint8_t>>(BlockCompression::GetCompressedSize(compression, size, size));
+			return [compression, size, pixels, output]()
+			{
+				BlockCompression::Encode(compression, pixels->data(), size, size, 4, output->data());
+				Utils::Consume(output->front());
+			};
+		} });
+	}
+
+	// Size = side of a square image, once per instruction set the CPU has. RGB is what the JPG
+	// sets decode to; the level is set on every run, the benchmarks share it
+	for (uint32_t index = 0; index <= (uint32_t)ImageKernels::GetSupportedLevel(); index++)
+	{
+		SimdLevel level = (SimdLevel)index;
+		std::string suffix = std::string("/") + ImageKernels::GetLevelName(level);
+
+		benchmarks.push_back({ "ImageKernels::Downsample" + suffix, { 256, 1024, 4096 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 3);
+			auto output = CreateRef<std::vector<uint8_t>>((size_t)(size / 2) * (size / 2) * 3);
+			return [level, size, pixels, output]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::Downsample(pixels->data(), size, size, 3, output->data());
+				Utils::Consume(output->front());
+			};
+		} });
+
+		benchmarks.push_back({ "ImageKernels::DownsampleSRGB" + suffix, { 256, 1024 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 3);
+			auto output = CreateRef<std::vector<uint8_t>>((size_t)(size / 2) * (size / 2) * 3);
+			return [level, size, pixels, output]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::DownsampleSRGB(pixels->data(), size, size, 3, output->data());
+				Utils::Consume(output->front());
+			};
+		} });
+
+		benchmarks.push_back({ "ImageKernels::ExpandRGBToRGBA" + suffix, { 256, 1024, 4096 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 3);
+			auto output = CreateRef<std::vector<uint8_t>>((size_t)size * size * 4);
+			return [level, size, pixels, output]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::ExpandRGBToRGBA(pixels->data(), output->data(), (size_t)size * size);
+				Utils::Consume(output->back());
+			};
+		} });
+
+		// In place: repeated runs change the values, not the work
+		benchmarks.push_back({ "ImageKernels::PremultiplyAlpha" + suffix, { 256, 1024 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 4);
+			return [level, size, pixels]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::PremultiplyAlpha(pixels->data(), (size_t)size * size);
+				Utils::Consume(pixels->front());
+			};
+		} });
+
+		benchmarks.push_back({ "ImageKernels::UnpremultiplyAlpha" + suffix, { 256, 1024 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 4);
+			return [level, size, pixels]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::UnpremultiplyAlpha(pixels->data(), (size_t)size * size);
+				Utils::Consume(pixels->front());
+			};
+		} });
+
+		benchmarks.push_back({ "ImageKernels::SRGBToLinear" + suffix, { 256, 1024 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 3);
+			auto output = CreateRef<std::vector<float>>((size_t)size * size * 3);
+			return [level, pixels, output]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::SRGBToLinear(pixels->data(), output->data(), pixels->size());
+				Utils::Consume(output->back());
+			};
+		} });
+
+		benchmarks.push_back({ "ImageKernels::LinearToSRGB" + suffix, { 256, 1024 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			Utils::Random random;
+			auto values = CreateRef<std::vector<float>>((size_t)size * size * 3);
+			for (float& value : *values)
+				value = random.Range(0.0f, 1.0f);
+			auto output = CreateRef<std::vector<uint8_t>>(values->size());
+			return [level, values, output]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::LinearToSRGB(values->data(), output->data(), values->size());
+				Utils::Consume(output->back());
+			};
+		} });
+
+		benchmarks.push_back({ "ImageKernels::RenormalizeNormals" + suffix, { 256, 1024 }, [level](uint32_t size) -> Utils::RunFn
+		{
+			auto pixels = Utils::CreateTestImage(size, 3);
+			return [level, size, pixels]()
+			{
+				ImageKernels::SetLevel(level);
+				ImageKernels::RenormalizeNormals(pixels->data(), (size_t)size * size, 3);
+				Utils::Consume(pixels->front());
+			};
+		} });
+	}
+
+	return benchmarks;
+}
+
+static nlohmann::json RunMicroBenchmark(const Utils::MicroBenchmark& benchmark, uint32_t size, double minTimeMs)
+{
+	using Clock = std::chrono::steady_clock;
+	constexpr uint32_t samples = 7;
+
+	Utils::RunFn run = benchmark.Setup(size);
+
+	// Grow the batch until one sample is long enough to trust the clock
+	uint64_t iterations = 1;
+	for (;;)
+	{
+		auto start = Clock::now();
+		for (uint64_t i = 0; i < iterations; i++)
+			run();
+		double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		if (elapsedMs * samples >= minTimeMs || iterations >= (1ull << 30))
+			break;
+		iterations *= elapsedMs > 0.0 ? std::max<uint64_t>(2, (uint64_t)(minTimeMs / samples / elapsedMs) + 1) : 16;
+	}
+
+	std::vector<double> times;
+	for (uint32_t sample = 0; sample < samples; sample++)
+	{
+		auto start = Clock::now();
+		for (uint64_t i = 0; i < iterations; i++)
+			run();
+		times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+	}
+	std::sort(times.begin(), times.end());
+
+	double median = times[samples / 2];
+	nlohmann::json result;
+	result["name"] = benchmark.Name;
+	result["size"] = size;
+	result["iterations"] = iterations;
+	result["nsPerOp"] = { { "min", times.front() }, { "median", median }, { "max", times.back() } };
+	result["nsPerItem"] = median / size;
+	result["itemsPerSecond"] = size * 1e9 / median;
+
+	std::cerr << benchmark.Name << "/" << size << ": " << median / 1e3 << " us/op, " << median / size << " ns/item\n";
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	Utils::MicroBenchConfig config;
+	if (!Utils::ParseArgs(argc, argv, config))
+	{
+		std::cerr << "usage: gl_engine_microbench [--filter text] [--min-time ms] [--res path] [--output file.json]\n";
+		return 1;
+	}
+
+	// Without --output the JSON report is stdout, log lines must not end up in it
+	Log::Init(config.OutputPath.empty());
+
+	AnimationClip clip;
+	bool hasClip = clip.Load(config.ResPath + "/lowpoly/MaleSurvivor1.glb");
+	if (!hasClip)
+		std::cerr << "Skipping animation benchmarks, could not load " << config.ResPath << "/lowpoly/MaleSurvivor1.glb\n";
+
+	nlohmann::json report;
+	report["minTimeMs"] = config.MinTimeMs;
+	report["results"] = nlohmann::json::array();
+
+	for (const auto& benchmark : CreateBenchmarks(config, hasClip ? &clip : nullptr))
+	{
+		if (!config.Filter.empty() && benchmark.Name.find(config.Filter) == std::string::npos)
+			continue;
+
+		for (uint32_t size : benchmark.Sizes)
+			report["results"].push_back(RunMicroBenchmark(benchmark, size, config.MinTimeMs));
+	}
+
+	if (config.OutputPath.empty())
+	{
+		std::cout << report.dump(4) << "\n";
+		return 0;
+	}
+
+	std::ofstream file(config.OutputPath);
+	if (!file.is_open())
+	{
+		std::cerr << "Could not write " << config.OutputPath << "\n";
+		return 1;
+	}
+	file << report.dump(4) << "\n";
+	return 0;
+}
@@ -56,6 +56,13 @@ layout (location = 4) in flat int v_EntityID;
 
 layout (binding = 0) uniform sampler2D u_Textures[32];
 
+// Specialized when the shader is loaded from cooked SPIR-V
+#ifdef GL_SPIRV
+layout(constant_id = 0) const float ALPHA_CUTOFF = 0.0;
+#else
+const float ALPHA_CUTOFF = 0.0;
+#endif
+
 void main()
 {
 	vec4 texColor = Input.Color;
@@ -96,7 +103,7 @@ void main()
 		case 31: texColor *= texture(u_Textures[31], Input.TexCoord * Input.TilingFactor); break;
 	}
 
-	if (texColor.a == 0.0)
+	if (texColor.a <= ALPHA_CUTOFF)
 		discard;
 
 	o_Color = texColor;
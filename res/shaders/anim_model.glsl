@@ -1,5 +1,7 @@
+#pragma variant POINT_LIGHTS DIRECTIONAL_LIGHTS SPOT_LIGHTS TONEMAP_ACES LARGE_SKELETON
+
 #type VERTEX
-#version 330 core
+#version 430 core
 
 layout(location = 0) in vec3 pos;
 layout(location = 1) in vec3 norm;
@@ -18,11 +20,22 @@ out VS_OUT{
     mat3 TBN;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time;
+};
+
 uniform mat4 model;
 
+#ifdef LARGE_SKELETON
 const int MAX_BONES = 100;
+#else
+const int MAX_BONES = 32;
+#endif
 const int MAX_BONE_INFLUENCE = 4;
 uniform mat4 finalBonesMatrices[MAX_BONES];
 
@@ -57,7 +70,7 @@ void main()
     vs_out.TBN_FragPos = vs_out.TBN * vs_out.FragPos;
 
     // Final transformation
-    gl_Position = projection * view * model * totalPosition;
+    gl_Position = u_ViewProjection * model * totalPosition;
 
     // Set output texture coordinates
     vs_out.TexCoords = tex;
@@ -115,7 +128,15 @@ layout(std430, binding = 6) buffer LightTypes {
     int lightTypes[];
 };
 
-uniform vec3 viewPos;  // Camera position
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time;
+};
+
 uniform Material material;
 uniform Light light;    // Shared light properties for all lights
 
@@ -200,7 +221,7 @@ vec3 calculateSpotlight(Light light, vec3 fragPos, vec3 normal, vec3 viewDir, ve
 void main() {
     vec3 color = texture(material.diffuse, fs_in.TexCoords).rgb;
     vec3 normal = normalize(fs_in.Normal);
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(u_CameraPosition.xyz - fs_in.FragPos);
 
     vec3 lighting = vec3(0.0);
 
@@ -216,19 +237,26 @@ void main() {
         currentLight.outerCutOff = 0.9;
 
         
-        if (lightTypes[i] == 0) { 
+#ifdef POINT_LIGHTS
+        if (lightTypes[i] == 0)
             lighting += calculatePointLight(currentLight, fs_in.FragPos, normal, viewDir, color);
-        } else if (lightTypes[i] == 1) { 
+#endif
+#ifdef DIRECTIONAL_LIGHTS
+        if (lightTypes[i] == 1)
             lighting += calculateDirectionalLight(currentLight, normal, viewDir, color);
-        } else if (lightTypes[i] == 2) { 
+#endif
+#ifdef SPOT_LIGHTS
+        if (lightTypes[i] == 2)
             lighting += calculateSpotlight(currentLight, fs_in.FragPos, normal, viewDir, color);
-        }
+#endif
     }
 
     vec3 result = lighting;
 
     // Apply tone mapping and gamma correction
+#ifdef TONEMAP_ACES
     result = toneMappingACES(result);
+#endif
     // result = gammaCorrection(result);
 
     float brightness = dot(result, vec3(0.2126, 0.7152, 0.0722));
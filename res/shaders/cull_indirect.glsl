@@ -0,0 +1,71 @@
+#type COMPUTE
+#version 430 core
+
+// Frustum culls every object of an IndirectDrawList and appends a draw command for each visible
+// one to its batch. Layouts match IndirectObject and DrawElementsIndirectCommand in IndirectDraw.h.
+layout (local_size_x = 64) in;
+
+struct Object
+{
+    mat4 Transform;
+    vec4 BoundsCenter;
+    vec4 BoundsExtents;
+    uvec4 Draw;     // index count, first index, base vertex, batch
+    uvec4 Command;  // first command slot of the batch
+};
+
+struct DrawCommand
+{
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+layout(std430, binding = 7) readonly buffer Objects {
+    Object objects[];
+};
+layout(std430, binding = 8) writeonly buffer Commands {
+    DrawCommand commands[];
+};
+layout(std430, binding = 9) buffer Counts {
+    uint counts[];
+};
+
+uniform vec4 u_Planes[6];
+uniform int u_ObjectCount;
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= uint(u_ObjectCount))
+        return;
+
+    Object object = objects[id];
+    if (object.Draw.x == 0u)
+        return;
+
+    // World space AABB of the transformed local box
+    vec3 center = vec3(object.Transform * vec4(object.BoundsCenter.xyz, 1.0));
+    mat3 axes = mat3(object.Transform);
+    vec3 extents = abs(axes[0]) * object.BoundsExtents.x + abs(axes[1]) * object.BoundsExtents.y + abs(axes[2]) * object.BoundsExtents.z;
+
+    for (int i = 0; i < 6; i++)
+    {
+        vec4 plane = u_Planes[i];
+        if (dot(plane.xyz, center) + plane.w + dot(abs(plane.xyz), extents) < 0.0)
+            return;
+    }
+
+    uint batch = object.Draw.w;
+    uint slot = atomicAdd(counts[batch], 1u);
+
+    DrawCommand command;
+    command.Count = object.Draw.x;
+    command.InstanceCount = 1u;
+    command.FirstIndex = object.Draw.y;
+    command.BaseVertex = int(object.Draw.z);
+    command.BaseInstance = id;
+    commands[object.Command.x + slot] = command;
+}
@@ -0,0 +1,23 @@
+#ifndef UNIFORMS_GLSL
+#define UNIFORMS_GLSL
+
+// Standard uniform blocks, bindings match UniformBinding in Buffer.h.
+// Frame is uploaded once per scene, Object comes out of the per-frame ring for every draw.
+
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time; // x seconds, y delta time
+};
+
+layout(std140, binding = 2) uniform Object
+{
+    mat4 u_Transform;
+    mat4 u_NormalMatrix;
+    ivec4 u_EntityID;
+};
+
+#endif
@@ -1,5 +1,5 @@
 #type VERTEX
-#version 330 core
+#version 430 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
@@ -10,8 +10,15 @@ out VS_OUT {
     vec2 TexCoords;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time;
+};
+
 uniform mat4 model;
 
 void main()
@@ -22,7 +29,7 @@ void main()
     // mat3 normalMatrix = transpose(inverse(mat3(model)));
     // vs_out.Normal = normalize(normalMatrix * aNormal);
     
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = u_ViewProjection * model * vec4(aPos, 1.0);
 }
  
 
@@ -1,14 +1,46 @@
+#pragma variant POINT_LIGHTS DIRECTIONAL_LIGHTS SPOT_LIGHTS TONEMAP_ACES PER_DRAW_TRANSFORM
+
 #type VERTEX
-#version 330 core
+#version 430 core
+#ifndef PER_DRAW_TRANSFORM
+#extension GL_ARB_shader_draw_parameters : require
+#endif
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in vec3 tangent;
 layout (location = 4) in vec3 bitangent;
 
+#ifdef PER_DRAW_TRANSFORM
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+mat4 GetModelMatrix() { return model; }
+#else
+// Drawn through IndirectDrawList, the culling pass stores the object index as the base instance
+struct Object
+{
+    mat4 Transform;
+    vec4 BoundsCenter;
+    vec4 BoundsExtents;
+    uvec4 Draw;
+    uvec4 Command;
+};
+
+layout(std430, binding = 7) readonly buffer Objects {
+    Object objects[];
+};
+
+mat4 GetModelMatrix() { return objects[gl_BaseInstanceARB].Transform; }
+#endif
+
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time;
+};
 
 out VS_OUT{
     vec2 TexCoords;
@@ -20,19 +52,20 @@ out VS_OUT{
 
 void main()
 {
-    vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
-    vs_out.Normal = mat3(transpose(inverse(model))) * aNormal;  
+    mat4 transform = GetModelMatrix();
+    vs_out.FragPos = vec3(transform * vec4(aPos, 1.0));
+    vs_out.Normal = mat3(transpose(inverse(transform))) * aNormal;  
 
     // Tangent space matrix (TBN)
-    vec3 T = normalize(mat3(model) * tangent);
-    vec3 B = normalize(mat3(model) * bitangent);
-    vec3 N = normalize(mat3(model) * aNormal);
+    vec3 T = normalize(mat3(transform) * tangent);
+    vec3 B = normalize(mat3(transform) * bitangent);
+    vec3 N = normalize(mat3(transform) * aNormal);
     vs_out.TBN = mat3(T, B, N);
 
     // Tangent-space position for fragment shader
     vs_out.TBN_FragPos = vs_out.TBN * vs_out.FragPos;
 
-    gl_Position = projection * view * vec4(vs_out.FragPos, 1.0);
+    gl_Position = u_ViewProjection * vec4(vs_out.FragPos, 1.0);
     vs_out.TexCoords = aTexCoords;
 }
 
@@ -88,7 +121,15 @@ layout(std430, binding = 6) buffer LightTypes {
     int lightTypes[];
 };
 
-uniform vec3 viewPos;  // Camera position
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time;
+};
+
 uniform Material material;
 uniform Light light;    // Shared light properties for all lights
 
@@ -174,7 +215,7 @@ vec3 calculateSpotlight(Light light, vec3 fragPos, vec3 normal, vec3 viewDir, ve
 void main() {
     vec3 color = texture(material.diffuse, fs_in.TexCoords).rgb;
     vec3 normal = normalize(fs_in.Normal);
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(u_CameraPosition.xyz - fs_in.FragPos);
 
     vec3 lighting = vec3(0.0);
 
@@ -189,19 +230,26 @@ void main() {
         currentLight.cutOff = cos(radians(12.5));
         currentLight.outerCutOff = cos(radians(17.5));
         
-        if (lightTypes[i] == 0) { 
+#ifdef POINT_LIGHTS
+        if (lightTypes[i] == 0)
             lighting += calculatePointLight(currentLight, fs_in.FragPos, normal, viewDir, color);
-        } else if (lightTypes[i] == 1) { 
+#endif
+#ifdef DIRECTIONAL_LIGHTS
+        if (lightTypes[i] == 1)
             lighting += calculateDirectionalLight(currentLight, normal, viewDir, color);
-        } else if (lightTypes[i] == 2) { 
+#endif
+#ifdef SPOT_LIGHTS
+        if (lightTypes[i] == 2)
             lighting += calculateSpotlight(currentLight, fs_in.FragPos, normal, viewDir, color);
-        }
+#endif
     }
 
     vec3 result = lighting;
 
     // Apply tone mapping and gamma correction
+#ifdef TONEMAP_ACES
     result = toneMappingACES(result);
+#endif
     // result = gammaCorrection(result);
 
     float brightness = dot(result, vec3(0.2126, 0.7152, 0.0722));
@@ -1,16 +1,23 @@
 #type VERTEX
-#version 330 core
+#version 430 core
 layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout(std140, binding = 1) uniform Frame
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Time;
+};
 
 void main()
 {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    // Rotation only, the sky stays centred on the camera
+    vec4 pos = u_Projection * mat4(mat3(u_View)) * vec4(aPos, 1.0);
     gl_Position = pos.xyww;
 }  
 
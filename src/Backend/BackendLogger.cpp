@@ -3,13 +3,116 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace Utils {
+
+	struct LogRecord
+	{
+		std::atomic<uint32_t> Sequence{ 0 };
+		LogLevel Level = LogLevel::Trace;
+		uint16_t Length = 0;
+		uint32_t Suppressed = 0;
+		int64_t Time = 0;
+		char Text[Log::MaxMessageSize];
+	};
+
+	static spdlog::level::level_enum ToSpdlogLevel(LogLevel level)
+	{
+		switch (level)
+		{
+			case LogLevel::Trace:    return spdlog::level::trace;
+			case LogLevel::Info:     return spdlog::level::info;
+			case LogLevel::Warn:     return spdlog::level::warn;
+			case LogLevel::Error:    return spdlog::level::err;
+			case LogLevel::Critical: return spdlog::level::critical;
+		}
+
+		return spdlog::level::info;
+	}
+
+	static void WriteToSinks(spdlog::logger& logger, LogLevel level, spdlog::log_clock::time_point time, std::string_view text, uint32_t suppressed)
+	{
+		char buffer[Log::MaxMessageSize + 48];
+		if (suppressed)
+		{
+			auto result = fmt::format_to_n(buffer, sizeof(buffer), "{} ({} similar messages suppressed)", text, suppressed);
+			text = std::string_view(buffer, result.size < sizeof(buffer) ? result.size : sizeof(buffer));
+		}
+
+		logger.log(time, spdlog::source_loc{}, ToSpdlogLevel(level), text);
+	}
+}
 
 Ref<spdlog::logger> Log::s_CoreLogger;
 
-void Log::Init()
+// Bounded MPSC ring, each record carries a sequence number that tells producers
+// and the consumer whose turn it is, so neither side takes a lock
+struct LogData
+{
+	Utils::LogRecord Records[Log::QueueCapacity];
+	std::atomic<uint32_t> EnqueuePos{ 0 };
+	uint32_t DequeuePos = 0;
+
+	std::atomic<uint64_t> Enqueued{ 0 };
+	std::atomic<uint64_t> Written{ 0 };
+	std::atomic<uint64_t> Dropped{ 0 };
+
+	std::thread Worker;
+	std::atomic<bool> Running{ false };
+
+	~LogData()
+	{
+		Log::Shutdown();
+	}
+};
+
+static LogData s_Data;
+
+static bool DrainQueue(spdlog::logger& logger)
+{
+	bool wroteAny = false;
+	for (;;)
+	{
+		Utils::LogRecord& record = s_Data.Records[s_Data.DequeuePos & (Log::QueueCapacity - 1)];
+		if (record.Sequence.load(std::memory_order_acquire) != s_Data.DequeuePos + 1)
+			break;
+
+		spdlog::log_clock::time_point time{ spdlog::log_clock::duration(record.Time) };
+		Utils::WriteToSinks(logger, record.Level, time, std::string_view(record.Text, record.Length), record.Suppressed);
+
+		record.Sequence.store(s_Data.DequeuePos + Log::QueueCapacity, std::memory_order_release);
+		s_Data.DequeuePos++;
+		s_Data.Written.fetch_add(1, std::memory_order_release);
+		wroteAny = true;
+	}
+
+	return wroteAny;
+}
+
+static void LogWorker()
+{
+	while (s_Data.Running.load(std::memory_order_acquire))
+	{
+		if (DrainQueue(*Log::GetCoreLogger()))
+			Log::GetCoreLogger()->flush();
+		else
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	DrainQueue(*Log::GetCoreLogger());
+	Log::GetCoreLogger()->flush();
+}
+
+void Log::Init(bool consoleToStderr)
 {
 	std::vector<spdlog::sink_ptr> logSinks;
-	logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+	if (consoleToStderr)
+		logSinks.emplace_back(std::make_shared<spdlog::sinks::stderr_color_sink_mt>());
+	else
+		logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
 	logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>("GABGL.log", true));
 
 	logSinks[0]->set_pattern("%^[%T] %n: %v%$");
@@ -18,5 +121,101 @@ void Log::Init()
 	s_CoreLogger = std::make_shared<spdlog::logger>("GABGL", begin(logSinks), end(logSinks));
 	spdlog::register_logger(s_CoreLogger);
 	s_CoreLogger->set_level(spdlog::level::trace);
-	s_CoreLogger->flush_on(spdlog::level::trace);
+
+	for (uint32_t i = 0; i < QueueCapacity; i++)
+		s_Data.Records[i].Sequence.store(i, std::memory_order_relaxed);
+
+	s_Data.Running.store(true, std::memory_order_release);
+	s_Data.Worker = std::thread(LogWorker);
+}
+
+void Log::Shutdown()
+{
+	if (!s_Data.Running.exchange(false, std::memory_order_acq_rel))
+		return;
+
+	s_Data.Worker.join();
+
+	if (uint64_t dropped = s_Data.Dropped.load(std::memory_order_relaxed))
+		s_CoreLogger->warn("{0} log messages were dropped because the queue was full", dropped);
+	s_CoreLogger->flush();
+}
+
+void Log::Flush()
+{
+	if (!s_Data.Running.load(std::memory_order_acquire))
+		return;
+
+	uint64_t target = s_Data.Enqueued.load(std::memory_order_acquire);
+	while (s_Data.Written.load(std::memory_order_acquire) < target)
+		std::this_thread::yield();
+	s_CoreLogger->flush();
+}
+
+uint64_t Log::GetDroppedMessages()
+{
+	return s_Data.Dropped.load(std::memory_order_relaxed);
+}
+
+bool Log::Admit(LogSite& site, uint32_t& suppressed)
+{
+	constexpr uint64_t window = 1000000000ull;
+	uint64_t now = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	uint64_t windowStart = site.WindowStart.load(std::memory_order_relaxed);
+	if (now - windowStart >= window && site.WindowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+	{
+		site.Count.store(1, std::memory_order_relaxed);
+		suppressed = site.Suppressed.exchange(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	if (site.Count.fetch_add(1, std::memory_order_relaxed) < SiteMessagesPerSecond)
+		return true;
+
+	site.Suppressed.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+void Log::Enqueue(LogLevel level, std::string_view message, uint32_t suppressed)
+{
+	auto time = spdlog::log_clock::now();
+
+	// Before Init and after Shutdown there is no worker, write straight through
+	if (!s_Data.Running.load(std::memory_order_acquire))
+	{
+		if (s_CoreLogger)
+			Utils::WriteToSinks(*s_CoreLogger, level, time, message, suppressed);
+		return;
+	}
+
+	Utils::LogRecord* record = nullptr;
+	uint32_t pos = s_Data.EnqueuePos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		record = &s_Data.Records[pos & (QueueCapacity - 1)];
+		int32_t diff = (int32_t)(record->Sequence.load(std::memory_order_acquire) - pos);
+		if (diff == 0)
+		{
+			if (s_Data.EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			s_Data.Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+			pos = s_Data.EnqueuePos.load(std::memory_order_relaxed);
+	}
+
+	size_t length = message.size() < MaxMessageSize ? message.size() : MaxMessageSize;
+	std::memcpy(record->Text, message.data(), length);
+	record->Length = (uint16_t)length;
+	record->Level = level;
+	record->Suppressed = suppressed;
+	record->Time = time.time_since_epoch().count();
+
+	s_Data.Enqueued.fetch_add(1, std::memory_order_relaxed);
+	record->Sequence.store(pos + 1, std::memory_order_release);
 }
@@ -2,6 +2,10 @@
 
 #include "BackendScopeRef.h"
 
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/string_cast.hpp"
 
@@ -12,11 +16,65 @@
 #pragma warning(pop)
 
 
+enum class LogLevel : uint8_t
+{
+	Trace = 0,
+	Info,
+	Warn,
+	Error,
+	Critical
+};
+
+// One per logging call site, caps how often a site can fire
+struct LogSite
+{
+	std::atomic<uint64_t> WindowStart{ 0 };
+	std::atomic<uint32_t> Count{ 0 };
+	std::atomic<uint32_t> Suppressed{ 0 };
+};
+
+// Callers format into a fixed size record and push it on a lock-free queue,
+// a background thread hands the records to the spdlog sinks. A full queue drops
+// the message instead of blocking the caller.
 struct Log
 {
-	static void Init();
+	static constexpr uint32_t QueueCapacity = 4096;
+	static constexpr uint32_t MaxMessageSize = 256;
+	static constexpr uint32_t SiteMessagesPerSecond = 20;
+
+	// Tools that write their own output to stdout send the console sink to stderr instead
+	static void Init(bool consoleToStderr = false);
+	static void Shutdown();
+	// Blocks until everything logged so far reached the sinks
+	static void Flush();
+	static uint64_t GetDroppedMessages();
+
 	inline static Ref<spdlog::logger>& GetCoreLogger() { return s_CoreLogger; }
+
+	template<typename... Args>
+	static void Write(LogSite& site, LogLevel level, spdlog::format_string_t<Args...> format, Args&&... args)
+	{
+		uint32_t suppressed = 0;
+		if (!Admit(site, suppressed))
+			return;
+
+		char buffer[MaxMessageSize];
+		auto result = fmt::format_to_n(buffer, MaxMessageSize, format, std::forward<Args>(args)...);
+		Enqueue(level, std::string_view(buffer, result.size < MaxMessageSize ? result.size : MaxMessageSize), suppressed);
+	}
+
+	template<typename T>
+	static void Write(LogSite& site, LogLevel level, const T& message)
+	{
+		uint32_t suppressed = 0;
+		if (Admit(site, suppressed))
+			Enqueue(level, std::string_view(message), suppressed);
+	}
+
 private:
+	static bool Admit(LogSite& site, uint32_t& suppressed);
+	static void Enqueue(LogLevel level, std::string_view message, uint32_t suppressed);
+
 	static Ref<spdlog::logger> s_CoreLogger;
 };
 
@@ -39,74 +97,57 @@ inline OStream& operator<<(OStream& os, glm::qua<T, Q> quaternion)
 	return os << glm::to_string(quaternion);
 }
 
+// Levels below GABGL_LOG_LEVEL are compiled out, override it from the build to change the default
+#define GABGL_LOG_LEVEL_TRACE    0
+#define GABGL_LOG_LEVEL_INFO     1
+#define GABGL_LOG_LEVEL_WARN     2
+#define GABGL_LOG_LEVEL_ERROR    3
+#define GABGL_LOG_LEVEL_CRITICAL 4
+#define GABGL_LOG_LEVEL_OFF      5
+
+#ifndef GABGL_LOG_LEVEL
+	#ifdef DEBUG
+		#define GABGL_LOG_LEVEL GABGL_LOG_LEVEL_TRACE
+	#else
+		#define GABGL_LOG_LEVEL GABGL_LOG_LEVEL_WARN
+	#endif
+#endif
+
+#define GABGL_LOG(level, ...) do { static ::LogSite s_LogSite; ::Log::Write(s_LogSite, level, __VA_ARGS__); } while (0)
+
 // Core log macros
-#ifdef DEBUG
-	#define GABGL_TRACE(...)    ::Log::GetCoreLogger()->trace(__VA_ARGS__)
-	#define GABGL_INFO(...)     ::Log::GetCoreLogger()->info(__VA_ARGS__)
-	#define GABGL_WARN(...)     ::Log::GetCoreLogger()->warn(__VA_ARGS__)
-	#define GABGL_ERROR(...)    ::Log::GetCoreLogger()->error(__VA_ARGS__)
-	#define GABGL_CRITICAL(...) ::Log::GetCoreLogger()->critical(__VA_ARGS__)
+#if GABGL_LOG_LEVEL <= GABGL_LOG_LEVEL_TRACE
+	#define GABGL_TRACE(...)    GABGL_LOG(::LogLevel::Trace, __VA_ARGS__)
+#else
+	#define GABGL_TRACE(...)    ((void)0)
+#endif
+#if GABGL_LOG_LEVEL <= GABGL_LOG_LEVEL_INFO
+	#define GABGL_INFO(...)     GABGL_LOG(::LogLevel::Info, __VA_ARGS__)
+#else
+	#define GABGL_INFO(...)     ((void)0)
+#endif
+#if GABGL_LOG_LEVEL <= GABGL_LOG_LEVEL_WARN
+	#define GABGL_WARN(...)     GABGL_LOG(::LogLevel::Warn, __VA_ARGS__)
+#else
+	#define GABGL_WARN(...)     ((void)0)
+#endif
+#if GABGL_LOG_LEVEL <= GABGL_LOG_LEVEL_ERROR
+	#define GABGL_ERROR(...)    GABGL_LOG(::LogLevel::Error, __VA_ARGS__)
 #else
-	#define GABGL_TRACE(...)    
-	#define GABGL_INFO(...)     
-	#define GABGL_WARN(...)     
-	#define GABGL_ERROR(...)    
-	#define GABGL_CRITICAL(...) 
+	#define GABGL_ERROR(...)    ((void)0)
+#endif
+#if GABGL_LOG_LEVEL <= GABGL_LOG_LEVEL_CRITICAL
+	#define GABGL_CRITICAL(...) GABGL_LOG(::LogLevel::Critical, __VA_ARGS__)
+#else
+	#define GABGL_CRITICAL(...) ((void)0)
 #endif
 
-#define GABGL_ASSERT(x,...) { if(!(x)) { GABGL_ERROR("Assertion Failed: {0}",__VA_ARGS__); __debugbreak(); } }
-#define GABGL_ASSERT(x) { if(!(x)) { GABGL_ERROR("Assertion Failed"); __debugbreak(); } }
+#define GABGL_ASSERT(x,...) { if(!(x)) { GABGL_ERROR("Assertion Failed: {0}",__VA_ARGS__); ::Log::Flush(); __debugbreak(); } }
+#define GABGL_ASSERT(x) { if(!(x)) { GABGL_ERROR("Assertion Failed"); ::Log::Flush(); __debugbreak(); } }
 
 #define BIND_EVENT(fn) [this](auto&&... args) -> decltype(auto) { return this->fn(std::forward<decltype(args)>(args)...); }
 
 #include <chrono>
-#include <vector>
-
-struct ProfileResult
-{
-	const char* Name;
-	float Time;
-};
-
-template<typename Func>
-struct Profiler
-{
-	inline Profiler(const char* name, Func&& func) : m_Name(name), m_Stop(false), m_Func(func)
-	{
-		m_Start = std::chrono::high_resolution_clock::now();
-	}
-
-	inline ~Profiler()
-	{
-		if (!m_Stop) Stop();
-	}
-
-	inline void Stop()
-	{
-		auto endPoint = std::chrono::high_resolution_clock::now();
-
-		long long start = std::chrono::time_point_cast<std::chrono::milliseconds>(m_Start).time_since_epoch().count();
-		long long end = std::chrono::time_point_cast<std::chrono::milliseconds>(endPoint).time_since_epoch().count();
-
-		m_Stop = true;
-		float duration = (end - start) * 0.001f;
-		m_Func({ m_Name, duration });
-	}
-
-private:
-	Func m_Func;
-	bool m_Stop;
-	const char* m_Name;
-	std::chrono::time_point<std::chrono::high_resolution_clock> m_Start;
-};
-
-inline std::vector<ProfileResult> s_ProfileResults;
-
-#ifdef DEBUG
-	#define GABGL_PROFILE_SCOPE(name) Profiler profiler##__LINE__(name, [&](ProfileResult pr){ s_ProfileResults.push_back(pr);})
-#else
-	#define GABGL_PROFILE_SCOPE(name)
-#endif
 
 struct Timer
 {
@@ -0,0 +1,136 @@
+#include "FileWatcher.h"
+#include "BackendLogger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+	#include <sys/inotify.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+struct FileWatcherData
+{
+	std::unordered_set<std::string> Files;
+#ifdef __linux__
+	int INotify = -1;
+	std::unordered_map<int, std::string> Directories; // watch descriptor -> directory
+#else
+	std::unordered_map<std::string, std::filesystem::file_time_type> WriteTimes;
+	Timer LastPoll;
+#endif
+};
+
+static FileWatcherData s_Data;
+
+void FileWatcher::Init()
+{
+#ifdef __linux__
+	s_Data.INotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (s_Data.INotify < 0)
+		GABGL_ERROR("inotify_init1 failed ({0}), shader hot reload disabled", errno);
+#endif
+}
+
+void FileWatcher::Shutdown()
+{
+#ifdef __linux__
+	if (s_Data.INotify >= 0)
+		close(s_Data.INotify);
+	s_Data.INotify = -1;
+	s_Data.Directories.clear();
+#else
+	s_Data.WriteTimes.clear();
+#endif
+	s_Data.Files.clear();
+}
+
+std::string FileWatcher::NormalizePath(const std::string& path)
+{
+	std::error_code error;
+	std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+	return (error ? std::filesystem::path(path).lexically_normal() : normalized).generic_string();
+}
+
+void FileWatcher::Watch(const std::string& path)
+{
+	std::string file = NormalizePath(path);
+	if (!s_Data.Files.insert(file).second)
+		return;
+
+#ifdef __linux__
+	if (s_Data.INotify < 0)
+		return;
+
+	// Watch the directory, editors often save by writing a temp file and renaming it over the original
+	std::string directory = std::filesystem::path(file).parent_path().generic_string();
+	for (const auto& [descriptor, watched] : s_Data.Directories)
+	{
+		if (watched == directory)
+			return;
+	}
+
+	int descriptor = inotify_add_watch(s_Data.INotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (descriptor < 0)
+	{
+		GABGL_WARN("Could not watch {0} ({1})", directory, errno);
+		return;
+	}
+	s_Data.Directories[descriptor] = directory;
+#else
+	std::error_code error;
+	s_Data.WriteTimes[file] = std::filesystem::last_write_time(file, error);
+#endif
+}
+
+std::vector<std::string> FileWatcher::PollChanges()
+{
+	std::vector<std::string> changes;
+
+#ifdef __linux__
+	if (s_Data.INotify < 0)
+		return changes;
+
+	alignas(inotify_event) char buffer[4096];
+	for (;;)
+	{
+		ssize_t length = read(s_Data.INotify, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;
+
+		for (char* cursor = buffer; cursor < buffer + length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+			cursor += sizeof(inotify_event) + event->len;
+
+			auto directory = s_Data.Directories.find(event->wd);
+			if (directory == s_Data.Directories.end() || event->len == 0)
+				continue;
+
+			std::string file = directory->second + "/" + event->name;
+			if (s_Data.Files.count(file) && std::find(changes.begin(), changes.end(), file) == changes.end())
+				changes.push_back(file);
+		}
+	}
+#else
+	if (s_Data.LastPoll.ElapsedMillis() < PollIntervalMs)
+		return changes;
+	s_Data.LastPoll.Reset();
+
+	for (auto& [file, writeTime] : s_Data.WriteTimes)
+	{
+		std::error_code error;
+		auto current = std::filesystem::last_write_time(file, error);
+		if (error || current == writeTime)
+			continue;
+
+		writeTime = current;
+		changes.push_back(file);
+	}
+#endif
+
+	return changes;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Reports files that were written since the last poll. Backed by inotify on Linux;
+// elsewhere watched files are stat'ed at most every PollIntervalMs.
+struct FileWatcher
+{
+	static constexpr float PollIntervalMs = 250.0f;
+
+	static void Init();
+	static void Shutdown();
+
+	// Idempotent, the path does not need to exist yet
+	static void Watch(const std::string& path);
+	// Normalized paths, each at most once per call
+	static std::vector<std::string> PollChanges();
+
+	static std::string NormalizePath(const std::string& path);
+};
@@ -0,0 +1,125 @@
+#include "FrameArena.h"
+#include "BackendLogger.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace Utils {
+
+	static size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+struct FrameArenaBuffer
+{
+	uint8_t* Base = nullptr;
+	size_t Offset = 0;
+	std::vector<void*> Overflow;
+};
+
+struct FrameArenaData
+{
+	static constexpr uint32_t BufferCount = 2;
+
+	FrameArenaBuffer Buffers[BufferCount];
+	uint32_t Current = 0;
+	size_t Capacity = 0;
+	bool OverflowReported = false;
+
+	FrameArena::Statistics Stats;
+};
+
+static FrameArenaData s_Data;
+
+void FrameArena::Init(size_t capacityPerFrame)
+{
+	if (s_Data.Capacity)
+		Shutdown();
+
+	s_Data.Capacity = capacityPerFrame;
+	for (auto& buffer : s_Data.Buffers)
+	{
+		buffer.Base = static_cast<uint8_t*>(::operator new(capacityPerFrame, std::align_val_t(alignof(std::max_align_t))));
+		buffer.Offset = 0;
+	}
+
+	s_Data.Current = 0;
+	s_Data.Stats = {};
+	s_Data.Stats.Capacity = capacityPerFrame;
+}
+
+void FrameArena::Shutdown()
+{
+	for (auto& buffer : s_Data.Buffers)
+	{
+		for (void* ptr : buffer.Overflow)
+			::operator delete(ptr);
+		buffer.Overflow.clear();
+
+		::operator delete(buffer.Base, std::align_val_t(alignof(std::max_align_t)));
+		buffer.Base = nullptr;
+		buffer.Offset = 0;
+	}
+
+	s_Data.Capacity = 0;
+}
+
+void FrameArena::BeginFrame()
+{
+	if (!s_Data.Capacity)
+		Init();
+
+	s_Data.Stats.BytesLastFrame = s_Data.Stats.BytesThisFrame;
+	s_Data.Stats.BytesThisFrame = 0;
+
+	s_Data.Current = (s_Data.Current + 1) % FrameArenaData::BufferCount;
+
+	FrameArenaBuffer& buffer = s_Data.Buffers[s_Data.Current];
+	buffer.Offset = 0;
+	for (void* ptr : buffer.Overflow)
+		::operator delete(ptr);
+	buffer.Overflow.clear();
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	if (!s_Data.Capacity)
+		Init();
+
+	FrameArenaBuffer& buffer = s_Data.Buffers[s_Data.Current];
+
+	size_t offset = Utils::AlignUp(buffer.Offset, alignment);
+	if (offset + size > s_Data.Capacity)
+	{
+		// Arena is exhausted, hand out heap memory owned by this buffer and release it on the next rewind
+		if (!s_Data.OverflowReported)
+		{
+			GABGL_WARN("FrameArena exhausted ({0} bytes per frame), falling back to heap allocations", s_Data.Capacity);
+			s_Data.OverflowReported = true;
+		}
+
+		void* ptr = ::operator new(size + alignment);
+		buffer.Overflow.push_back(ptr);
+		s_Data.Stats.OverflowAllocations++;
+		s_Data.Stats.BytesThisFrame += size;
+		if (s_Data.Stats.BytesThisFrame > s_Data.Stats.PeakBytes)
+			s_Data.Stats.PeakBytes = s_Data.Stats.BytesThisFrame;
+
+		return reinterpret_cast<void*>(Utils::AlignUp(reinterpret_cast<uintptr_t>(ptr), alignment));
+	}
+
+	buffer.Offset = offset + size;
+
+	s_Data.Stats.BytesThisFrame += size;
+	if (s_Data.Stats.BytesThisFrame > s_Data.Stats.PeakBytes)
+		s_Data.Stats.PeakBytes = s_Data.Stats.BytesThisFrame;
+
+	return buffer.Base + offset;
+}
+
+const FrameArena::Statistics& FrameArena::GetStats()
+{
+	return s_Data.Stats;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+// Double-buffered linear allocator for data that only lives for a frame or two.
+// BeginFrame() flips to the other buffer and rewinds it, so memory handed out
+// during frame N stays valid until frame N+2 starts. Main thread only.
+struct FrameArena
+{
+	static void Init(size_t capacityPerFrame = 4 * 1024 * 1024);
+	static void Shutdown();
+
+	static void BeginFrame();
+
+	static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	static T* Allocate(size_t count = 1)
+	{
+		return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	struct Statistics
+	{
+		size_t BytesThisFrame = 0;
+		size_t BytesLastFrame = 0;
+		size_t PeakBytes = 0;
+		size_t Capacity = 0;
+		uint32_t OverflowAllocations = 0;
+	};
+
+	static const Statistics& GetStats();
+};
+
+template<typename T>
+struct FrameAllocator
+{
+	using value_type = T;
+
+	FrameAllocator() noexcept = default;
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+	T* allocate(size_t n) { return FrameArena::Allocate<T>(n); }
+	void deallocate(T*, size_t) noexcept {}
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+template<typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+using FrameUnorderedMap = std::unordered_map<K, V, Hash, Eq, FrameAllocator<std::pair<const K, V>>>;
@@ -0,0 +1,323 @@
+#include "FrameTelemetry.h"
+#include "BackendLogger.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <json.hpp>
+
+namespace Utils {
+
+	// Hitches are judged against the median of the last few seconds, not the whole ring
+	static constexpr uint32_t MedianWindow = 120;
+
+	static float Percentile(const std::vector<float>& sorted, float percentile)
+	{
+		if (sorted.empty())
+			return 0.0f;
+
+		float rank = percentile / 100.0f * (sorted.size() - 1);
+		size_t lower = (size_t)rank;
+		size_t upper = std::min(lower + 1, sorted.size() - 1);
+		return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+	}
+
+	static void TagHitch(FrameHitch& hitch)
+	{
+		uint32_t trackIDs[8];
+		bool trackFlags[8];
+		uint32_t trackCount = 0;
+
+		for (const auto& event : Profiler::GetLastFrameEvents())
+		{
+			// Depth 0 is the whole frame, tracks like the GPU lag a few frames behind
+			if (event.Depth == 0)
+				continue;
+
+			uint32_t t = 0;
+			while (t < trackCount && trackIDs[t] != event.ThreadID)
+				t++;
+			if (t == trackCount)
+			{
+				if (trackCount == 8)
+					continue;
+				trackIDs[trackCount] = event.ThreadID;
+				trackFlags[trackCount++] = Profiler::IsTrack(event.ThreadID);
+			}
+			if (trackFlags[t])
+				continue;
+
+			float ms = (event.End - event.Start) / 1e6f;
+
+			uint32_t slot = 0;
+			while (slot < hitch.TagCount && strcmp(hitch.Tags[slot], event.Name) != 0)
+				slot++;
+			if (slot < hitch.TagCount)
+			{
+				hitch.TagMs[slot] += ms;
+				continue;
+			}
+
+			if (hitch.TagCount < FrameHitch::MaxTags)
+				slot = hitch.TagCount++;
+			else
+			{
+				slot = 0;
+				for (uint32_t i = 1; i < hitch.TagCount; i++)
+					slot = hitch.TagMs[i] < hitch.TagMs[slot] ? i : slot;
+				if (hitch.TagMs[slot] >= ms)
+					continue;
+			}
+			hitch.Tags[slot] = event.Name;
+			hitch.TagMs[slot] = ms;
+		}
+
+		// Longest first
+		for (uint32_t i = 1; i < hitch.TagCount; i++)
+		{
+			for (uint32_t j = i; j > 0 && hitch.TagMs[j] > hitch.TagMs[j - 1]; j--)
+			{
+				std::swap(hitch.TagMs[j], hitch.TagMs[j - 1]);
+				std::swap(hitch.Tags[j], hitch.Tags[j - 1]);
+			}
+		}
+	}
+}
+
+struct FrameTelemetryData
+{
+	FrameSample Samples[FrameTelemetry::HistorySize];
+	uint32_t SampleHead = 0;
+	uint32_t SampleCount = 0;
+
+	FrameHitch Hitches[FrameTelemetry::MaxHitches];
+	uint32_t HitchHead = 0;
+	uint32_t HitchCount = 0;
+
+	uint64_t PendingCounters[(size_t)FrameCounter::Count] = {};
+	uint64_t TotalFrames = 0;
+	uint64_t TotalHitches = 0;
+
+	float HitchThresholdMs = 33.3f;
+	float HitchMedianFactor = 2.0f;
+
+	FrameTelemetryStats Stats;
+	bool StatsDirty = true;
+	std::vector<float> Scratch;
+};
+
+static FrameTelemetryData s_Data;
+
+void FrameTelemetry::EndFrame()
+{
+	uint64_t start = Profiler::GetLastFrameStart();
+	uint64_t end = Profiler::GetLastFrameEnd();
+	if (end <= start)
+		return;
+
+	FrameSample& sample = s_Data.Samples[s_Data.SampleHead];
+	sample.FrameIndex = s_Data.TotalFrames++;
+	sample.FrameMs = (end - start) / 1e6f;
+	std::memcpy(sample.Counters, s_Data.PendingCounters, sizeof(sample.Counters));
+	std::memset(s_Data.PendingCounters, 0, sizeof(s_Data.PendingCounters));
+
+	float threshold = s_Data.HitchThresholdMs;
+	uint32_t window = std::min(s_Data.SampleCount, Utils::MedianWindow);
+	if (window)
+	{
+		s_Data.Scratch.clear();
+		for (uint32_t i = 1; i <= window; i++)
+			s_Data.Scratch.push_back(s_Data.Samples[(s_Data.SampleHead + HistorySize - i) % HistorySize].FrameMs);
+
+		auto middle = s_Data.Scratch.begin() + s_Data.Scratch.size() / 2;
+		std::nth_element(s_Data.Scratch.begin(), middle, s_Data.Scratch.end());
+		threshold = std::max(threshold, *middle * s_Data.HitchMedianFactor);
+	}
+
+	sample.Hitch = sample.FrameMs > threshold;
+	if (sample.Hitch)
+	{
+		FrameHitch& hitch = s_Data.Hitches[s_Data.HitchHead];
+		hitch = FrameHitch();
+		hitch.FrameIndex = sample.FrameIndex;
+		hitch.FrameMs = sample.FrameMs;
+		hitch.ThresholdMs = threshold;
+		Utils::TagHitch(hitch);
+
+		s_Data.HitchHead = (s_Data.HitchHead + 1) % MaxHitches;
+		s_Data.HitchCount = std::min(s_Data.HitchCount + 1, MaxHitches);
+		s_Data.TotalHitches++;
+	}
+
+	s_Data.SampleHead = (s_Data.SampleHead + 1) % HistorySize;
+	s_Data.SampleCount = std::min(s_Data.SampleCount + 1, HistorySize);
+	s_Data.StatsDirty = true;
+}
+
+void FrameTelemetry::SetCounter(FrameCounter counter, uint64_t value)
+{
+	s_Data.PendingCounters[(size_t)counter] = value;
+}
+
+void FrameTelemetry::SetHitchThreshold(float milliseconds, float medianFactor)
+{
+	s_Data.HitchThresholdMs = milliseconds;
+	s_Data.HitchMedianFactor = medianFactor;
+}
+
+float FrameTelemetry::GetHitchThresholdMs()
+{
+	return s_Data.HitchThresholdMs;
+}
+
+float FrameTelemetry::GetHitchMedianFactor()
+{
+	return s_Data.HitchMedianFactor;
+}
+
+uint32_t FrameTelemetry::GetSampleCount()
+{
+	return s_Data.SampleCount;
+}
+
+const FrameSample& FrameTelemetry::GetSample(uint32_t index)
+{
+	GABGL_ASSERT(index < s_Data.SampleCount, "Frame sample index out of range!");
+	return s_Data.Samples[(s_Data.SampleHead + HistorySize - s_Data.SampleCount + index) % HistorySize];
+}
+
+uint32_t FrameTelemetry::GetHitchCount()
+{
+	return s_Data.HitchCount;
+}
+
+const FrameHitch& FrameTelemetry::GetHitch(uint32_t index)
+{
+	GABGL_ASSERT(index < s_Data.HitchCount, "Frame hitch index out of range!");
+	return s_Data.Hitches[(s_Data.HitchHead + MaxHitches - s_Data.HitchCount + index) % MaxHitches];
+}
+
+uint64_t FrameTelemetry::GetTotalFrames()
+{
+	return s_Data.TotalFrames;
+}
+
+uint64_t FrameTelemetry::GetTotalHitches()
+{
+	return s_Data.TotalHitches;
+}
+
+const FrameTelemetryStats& FrameTelemetry::GetStats()
+{
+	if (!s_Data.StatsDirty)
+		return s_Data.Stats;
+
+	s_Data.Scratch.clear();
+	double total = 0.0;
+	for (uint32_t i = 0; i < s_Data.SampleCount; i++)
+	{
+		s_Data.Scratch.push_back(GetSample(i).FrameMs);
+		total += GetSample(i).FrameMs;
+	}
+	std::sort(s_Data.Scratch.begin(), s_Data.Scratch.end());
+
+	FrameTelemetryStats& stats = s_Data.Stats;
+	stats.P50 = Utils::Percentile(s_Data.Scratch, 50.0f);
+	stats.P95 = Utils::Percentile(s_Data.Scratch, 95.0f);
+	stats.P99 = Utils::Percentile(s_Data.Scratch, 99.0f);
+	stats.Max = s_Data.Scratch.empty() ? 0.0f : s_Data.Scratch.back();
+	stats.Mean = s_Data.SampleCount ? (float)(total / s_Data.SampleCount) : 0.0f;
+	stats.SampleCount = s_Data.SampleCount;
+
+	s_Data.StatsDirty = false;
+	return stats;
+}
+
+bool FrameTelemetry::Export(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		GABGL_ERROR("Could not write frame telemetry to {0}", path);
+		return false;
+	}
+
+	bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+	if (csv)
+	{
+		file << "frame,ms,hitch";
+		for (size_t c = 0; c < (size_t)FrameCounter::Count; c++)
+			file << "," << CounterToString((FrameCounter)c);
+		file << "\n";
+
+		for (uint32_t i = 0; i < s_Data.SampleCount; i++)
+		{
+			const FrameSample& sample = GetSample(i);
+			file << sample.FrameIndex << "," << sample.FrameMs << "," << (sample.Hitch ? 1 : 0);
+			for (size_t c = 0; c < (size_t)FrameCounter::Count; c++)
+				file << "," << sample.Counters[c];
+			file << "\n";
+		}
+	}
+	else
+	{
+		const FrameTelemetryStats& stats = GetStats();
+
+		nlohmann::json telemetry;
+		telemetry["totalFrames"] = s_Data.TotalFrames;
+		telemetry["totalHitches"] = s_Data.TotalHitches;
+		telemetry["hitchThresholdMs"] = s_Data.HitchThresholdMs;
+		telemetry["hitchMedianFactor"] = s_Data.HitchMedianFactor;
+		telemetry["stats"] = {
+			{ "samples", stats.SampleCount },
+			{ "mean", stats.Mean },
+			{ "p50", stats.P50 },
+			{ "p95", stats.P95 },
+			{ "p99", stats.P99 },
+			{ "max", stats.Max }
+		};
+
+		nlohmann::json& frames = telemetry["frames"] = nlohmann::json::array();
+		for (uint32_t i = 0; i < s_Data.SampleCount; i++)
+		{
+			const FrameSample& sample = GetSample(i);
+			nlohmann::json frame = { { "frame", sample.FrameIndex }, { "ms", sample.FrameMs }, { "hitch", sample.Hitch } };
+			for (size_t c = 0; c < (size_t)FrameCounter::Count; c++)
+				frame[CounterToString((FrameCounter)c)] = sample.Counters[c];
+			frames.push_back(frame);
+		}
+
+		nlohmann::json& hitches = telemetry["hitches"] = nlohmann::json::array();
+		for (uint32_t i = 0; i < s_Data.HitchCount; i++)
+		{
+			const FrameHitch& hitch = GetHitch(i);
+			nlohmann::json entry = { { "frame", hitch.FrameIndex }, { "ms", hitch.FrameMs }, { "thresholdMs", hitch.ThresholdMs } };
+			entry["subsystems"] = nlohmann::json::array();
+			for (uint32_t t = 0; t < hitch.TagCount; t++)
+				entry["subsystems"].push_back({ { "name", hitch.Tags[t] }, { "ms", hitch.TagMs[t] } });
+			hitches.push_back(entry);
+		}
+
+		file << telemetry.dump(4);
+	}
+
+	GABGL_INFO("Frame telemetry written to {0}", path);
+	return true;
+}
+
+const char* FrameTelemetry::CounterToString(FrameCounter counter)
+{
+	switch (counter)
+	{
+		case FrameCounter::DrawCalls:  return "drawCalls";
+		case FrameCounter::Quads:      return "quads";
+		case FrameCounter::ArenaBytes: return "arenaBytes";
+		case FrameCounter::StateCalls: return "stateCalls";
+		case FrameCounter::RedundantStateCalls: return "redundantStateCalls";
+		case FrameCounter::Count: break;
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+enum class FrameCounter : uint8_t
+{
+	DrawCalls = 0,
+	Quads,
+	ArenaBytes,
+	StateCalls,
+	RedundantStateCalls,
+
+	Count
+};
+
+struct FrameSample
+{
+	uint64_t FrameIndex = 0;
+	float FrameMs = 0.0f;
+	uint64_t Counters[(size_t)FrameCounter::Count] = {};
+	bool Hitch = false;
+};
+
+struct FrameHitch
+{
+	static constexpr uint32_t MaxTags = 4;
+
+	uint64_t FrameIndex = 0;
+	float FrameMs = 0.0f;
+	float ThresholdMs = 0.0f;
+	// Longest profiler zones of the frame, names point at string literals
+	const char* Tags[MaxTags] = {};
+	float TagMs[MaxTags] = {};
+	uint32_t TagCount = 0;
+};
+
+struct FrameTelemetryStats
+{
+	float P50 = 0.0f;
+	float P95 = 0.0f;
+	float P99 = 0.0f;
+	float Max = 0.0f;
+	float Mean = 0.0f;
+	uint32_t SampleCount = 0;
+};
+
+// Ring of the last HistorySize frames. EndFrame() closes the frame the Profiler just
+// drained, so call it right after Profiler::BeginFrame(). Main thread only.
+// A frame is a hitch when it takes longer than both the fixed threshold and
+// HitchMedianFactor times the rolling median.
+struct FrameTelemetry
+{
+	static constexpr uint32_t HistorySize = 4096;
+	static constexpr uint32_t MaxHitches = 256;
+
+	static void EndFrame();
+	static void SetCounter(FrameCounter counter, uint64_t value);
+
+	static void SetHitchThreshold(float milliseconds, float medianFactor = 2.0f);
+	static float GetHitchThresholdMs();
+	static float GetHitchMedianFactor();
+
+	static uint32_t GetSampleCount();
+	// 0 is the oldest sample still in the ring
+	static const FrameSample& GetSample(uint32_t index);
+	static uint32_t GetHitchCount();
+	static const FrameHitch& GetHitch(uint32_t index);
+	static uint64_t GetTotalFrames();
+	static uint64_t GetTotalHitches();
+
+	// Rolling statistics over the ring, recomputed at most once per frame
+	static const FrameTelemetryStats& GetStats();
+
+	// Writes CSV for a .csv path and JSON otherwise
+	static bool Export(const std::string& path);
+
+	static const char* CounterToString(FrameCounter counter);
+};
@@ -0,0 +1,108 @@
+#include "JobSystem.h"
+#include "BackendLogger.h"
+#include "Profiler.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct JobSystemData
+{
+	std::vector<std::thread> Workers;
+	std::deque<std::function<void()>> Queue;
+	std::mutex QueueMutex;
+	std::condition_variable QueueCondition;
+	uint32_t Running = 0;
+	bool Stopping = false;
+};
+
+static JobSystemData s_Data;
+
+static void JobWorker(uint32_t index)
+{
+	std::string name = "Job " + std::to_string(index);
+	Profiler::SetThreadName(name.c_str());
+
+	std::unique_lock<std::mutex> lock(s_Data.QueueMutex);
+	for (;;)
+	{
+		s_Data.QueueCondition.wait(lock, [] { return s_Data.Stopping || !s_Data.Queue.empty(); });
+		if (s_Data.Stopping)
+			return;
+
+		std::function<void()> job = std::move(s_Data.Queue.front());
+		s_Data.Queue.pop_front();
+		s_Data.Running++;
+
+		lock.unlock();
+		job();
+		lock.lock();
+
+		s_Data.Running--;
+	}
+}
+
+void JobSystem::Init(uint32_t workerCount)
+{
+	GABGL_ASSERT(s_Data.Workers.empty(), "JobSystem already initialized!");
+
+	if (workerCount == 0)
+	{
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	s_Data.Stopping = false;
+	for (uint32_t i = 0; i < workerCount; i++)
+		s_Data.Workers.emplace_back(JobWorker, i);
+}
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_Data.QueueMutex);
+		s_Data.Stopping = true;
+		if (!s_Data.Queue.empty())
+			GABGL_WARN("JobSystem shutting down with {0} jobs left, they are dropped", s_Data.Queue.size());
+		s_Data.Queue.clear();
+	}
+	s_Data.QueueCondition.notify_all();
+
+	for (std::thread& worker : s_Data.Workers)
+		worker.join();
+	s_Data.Workers.clear();
+}
+
+void JobSystem::Submit(std::function<void()> job)
+{
+	if (s_Data.Workers.empty())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_Data.QueueMutex);
+		s_Data.Queue.push_back(std::move(job));
+	}
+	s_Data.QueueCondition.notify_one();
+}
+
+bool JobSystem::IsInitialized()
+{
+	return !s_Data.Workers.empty();
+}
+
+uint32_t JobSystem::GetWorkerCount()
+{
+	return (uint32_t)s_Data.Workers.size();
+}
+
+uint32_t JobSystem::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(s_Data.QueueMutex);
+	return (uint32_t)s_Data.Queue.size() + s_Data.Running;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Fixed pool of worker threads running fire-and-forget jobs in submission order. Jobs must not
+// touch GL; results go back to the main thread through a queue the owner polls once per frame.
+struct JobSystem
+{
+	// 0 picks one worker per hardware thread minus the main thread, at least one
+	static void Init(uint32_t workerCount = 0);
+	// Drops jobs that have not started and joins the workers once the running ones return
+	static void Shutdown();
+
+	// Runs the job on the calling thread when the pool is not initialized
+	static void Submit(std::function<void()> job);
+
+	static bool IsInitialized();
+	static uint32_t GetWorkerCount();
+	// Queued plus running
+	static uint32_t GetPendingCount();
+};
@@ -0,0 +1,249 @@
+#include "MemoryTracker.h"
+#include "BackendLogger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <json.hpp>
+
+namespace Utils {
+
+	struct AtomicMemoryStats
+	{
+		std::atomic<int64_t> CurrentBytes{ 0 };
+		std::atomic<int64_t> PeakBytes{ 0 };
+		std::atomic<int64_t> Allocations{ 0 };
+		std::atomic<int64_t> LiveAllocations{ 0 };
+
+		void Add(int64_t bytes)
+		{
+			int64_t current = CurrentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+			int64_t peak = PeakBytes.load(std::memory_order_relaxed);
+			while (current > peak && !PeakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+
+			Allocations.fetch_add(1, std::memory_order_relaxed);
+			LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void Remove(int64_t bytes)
+		{
+			CurrentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+			LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		MemoryStats Load() const
+		{
+			MemoryStats stats;
+			stats.CurrentBytes = CurrentBytes.load(std::memory_order_relaxed);
+			stats.PeakBytes = PeakBytes.load(std::memory_order_relaxed);
+			stats.Allocations = Allocations.load(std::memory_order_relaxed);
+			stats.LiveAllocations = LiveAllocations.load(std::memory_order_relaxed);
+			return stats;
+		}
+	};
+
+	// Sits right in front of every pointer handed out by operator new
+	struct alignas(16) AllocationHeader
+	{
+		uint64_t Size;
+		uint32_t Offset;
+		MemoryTag Tag;
+	};
+	static_assert(sizeof(AllocationHeader) == 16);
+
+	static AtomicMemoryStats s_CPUStats[(size_t)MemoryTag::Count];
+	static AtomicMemoryStats s_GPUStats[(size_t)GPUMemoryKind::Count];
+	static thread_local MemoryTag s_CurrentTag = MemoryTag::Untagged;
+
+	static void* TrackedAlloc(size_t size, size_t alignment) noexcept
+	{
+		if (alignment < alignof(AllocationHeader))
+			alignment = alignof(AllocationHeader);
+
+		uint8_t* raw = static_cast<uint8_t*>(std::malloc(size + sizeof(AllocationHeader) + alignment - alignof(AllocationHeader)));
+		if (!raw)
+			return nullptr;
+
+		uintptr_t user = (reinterpret_cast<uintptr_t>(raw) + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+		AllocationHeader* header = reinterpret_cast<AllocationHeader*>(user) - 1;
+		header->Size = size;
+		header->Offset = (uint32_t)(user - reinterpret_cast<uintptr_t>(raw));
+		header->Tag = s_CurrentTag;
+
+		s_CPUStats[(size_t)header->Tag].Add((int64_t)size);
+
+		return reinterpret_cast<void*>(user);
+	}
+
+	static void TrackedFree(void* ptr) noexcept
+	{
+		if (!ptr)
+			return;
+
+		AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+		s_CPUStats[(size_t)header->Tag].Remove((int64_t)header->Size);
+
+		std::free(static_cast<uint8_t*>(ptr) - header->Offset);
+	}
+
+	static void* TrackedAllocOrThrow(size_t size, size_t alignment)
+	{
+		for (;;)
+		{
+			if (void* ptr = TrackedAlloc(size, alignment))
+				return ptr;
+
+			std::new_handler handler = std::get_new_handler();
+			if (!handler)
+				throw std::bad_alloc();
+			handler();
+		}
+	}
+
+	static nlohmann::json StatsDiffToJson(const MemoryStats& before, const MemoryStats& after)
+	{
+		return {
+			{ "before", before.CurrentBytes },
+			{ "after", after.CurrentBytes },
+			{ "delta", after.CurrentBytes - before.CurrentBytes },
+			{ "peak", after.PeakBytes },
+			{ "allocations", after.Allocations - before.Allocations },
+			{ "liveAllocationsDelta", after.LiveAllocations - before.LiveAllocations }
+		};
+	}
+}
+
+void* operator new(size_t size) { return Utils::TrackedAllocOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return Utils::TrackedAllocOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment) { return Utils::TrackedAllocOrThrow(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return Utils::TrackedAllocOrThrow(size, (size_t)alignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Utils::TrackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Utils::TrackedAlloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Utils::TrackedAlloc(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Utils::TrackedAlloc(size, (size_t)alignment); }
+
+void operator delete(void* ptr) noexcept { Utils::TrackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { Utils::TrackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Utils::TrackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Utils::TrackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Utils::TrackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Utils::TrackedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Utils::TrackedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { Utils::TrackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Utils::TrackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Utils::TrackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Utils::TrackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Utils::TrackedFree(ptr); }
+
+MemoryTag MemoryTracker::GetCurrentTag()
+{
+	return Utils::s_CurrentTag;
+}
+
+MemoryTag MemoryTracker::SetCurrentTag(MemoryTag tag)
+{
+	MemoryTag previous = Utils::s_CurrentTag;
+	Utils::s_CurrentTag = tag;
+	return previous;
+}
+
+void MemoryTracker::TrackGPUAlloc(GPUMemoryKind kind, int64_t bytes)
+{
+	Utils::s_GPUStats[(size_t)kind].Add(bytes);
+}
+
+void MemoryTracker::TrackGPUFree(GPUMemoryKind kind, int64_t bytes)
+{
+	Utils::s_GPUStats[(size_t)kind].Remove(bytes);
+}
+
+MemorySnapshot MemoryTracker::TakeSnapshot()
+{
+	static const auto s_Start = std::chrono::steady_clock::now();
+
+	MemorySnapshot snapshot;
+	snapshot.Time = std::chrono::duration<double>(std::chrono::steady_clock::now() - s_Start).count();
+
+	for (size_t i = 0; i < (size_t)MemoryTag::Count; i++)
+		snapshot.CPU[i] = Utils::s_CPUStats[i].Load();
+	for (size_t i = 0; i < (size_t)GPUMemoryKind::Count; i++)
+		snapshot.GPU[i] = Utils::s_GPUStats[i].Load();
+
+	return snapshot;
+}
+
+bool MemoryTracker::WriteSnapshotDiff(const std::string& path, const MemorySnapshot& before, const MemorySnapshot& after)
+{
+	nlohmann::json diff;
+	diff["beforeTime"] = before.Time;
+	diff["afterTime"] = after.Time;
+
+	int64_t cpuDelta = 0, gpuDelta = 0;
+	for (size_t i = 0; i < (size_t)MemoryTag::Count; i++)
+	{
+		diff["cpu"][TagToString((MemoryTag)i)] = Utils::StatsDiffToJson(before.CPU[i], after.CPU[i]);
+		cpuDelta += after.CPU[i].CurrentBytes - before.CPU[i].CurrentBytes;
+	}
+	for (size_t i = 0; i < (size_t)GPUMemoryKind::Count; i++)
+	{
+		diff["gpu"][GPUKindToString((GPUMemoryKind)i)] = Utils::StatsDiffToJson(before.GPU[i], after.GPU[i]);
+		gpuDelta += after.GPU[i].CurrentBytes - before.GPU[i].CurrentBytes;
+	}
+	diff["cpuDelta"] = cpuDelta;
+	diff["gpuDelta"] = gpuDelta;
+
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		GABGL_ERROR("Could not write memory snapshot diff to {0}", path);
+		return false;
+	}
+
+	file << diff.dump(4);
+	GABGL_INFO("Memory snapshot diff written to {0}", path);
+	return true;
+}
+
+const char* MemoryTracker::TagToString(MemoryTag tag)
+{
+	switch (tag)
+	{
+		case MemoryTag::Untagged: return "Untagged";
+		case MemoryTag::Renderer: return "Renderer";
+		case MemoryTag::Scene:    return "Scene";
+		case MemoryTag::Assets:   return "Assets";
+		case MemoryTag::Physics:  return "Physics";
+		case MemoryTag::Count:    break;
+	}
+
+	return "Unknown";
+}
+
+const char* MemoryTracker::GPUKindToString(GPUMemoryKind kind)
+{
+	switch (kind)
+	{
+		case GPUMemoryKind::Texture:     return "Textures";
+		case GPUMemoryKind::Buffer:      return "Buffers";
+		case GPUMemoryKind::Framebuffer: return "Framebuffers";
+		case GPUMemoryKind::Count:       break;
+	}
+
+	return "Unknown";
+}
+
+int64_t MemoryTracker::GetTextureBytes(uint32_t width, uint32_t height, uint32_t bytesPerPixel, uint32_t mipLevels, uint32_t samples)
+{
+	int64_t total = 0;
+	for (uint32_t level = 0; level < mipLevels; level++)
+	{
+		total += (int64_t)width * height * bytesPerPixel;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return total * samples;
+}
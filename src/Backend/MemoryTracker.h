@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+enum class MemoryTag : uint8_t
+{
+	Untagged = 0,
+	Renderer,
+	Scene,
+	Assets,
+	Physics,
+
+	Count
+};
+
+enum class GPUMemoryKind : uint8_t
+{
+	Texture = 0,
+	Buffer,
+	// Framebuffer attachments, textures too but sized by the viewport rather than by assets
+	Framebuffer,
+
+	Count
+};
+
+struct MemoryStats
+{
+	int64_t CurrentBytes = 0;
+	int64_t PeakBytes = 0;
+	int64_t Allocations = 0;
+	int64_t LiveAllocations = 0;
+};
+
+struct MemorySnapshot
+{
+	double Time = 0.0;
+	MemoryStats CPU[(size_t)MemoryTag::Count];
+	MemoryStats GPU[(size_t)GPUMemoryKind::Count];
+};
+
+// CPU numbers come from the global operator new/delete replacements in MemoryTracker.cpp,
+// every allocation is charged to the tag active on the allocating thread.
+// GPU numbers are reported by the renderer wrappers when they (re)allocate storage.
+struct MemoryTracker
+{
+	static MemoryTag GetCurrentTag();
+	static MemoryTag SetCurrentTag(MemoryTag tag);
+
+	static void TrackGPUAlloc(GPUMemoryKind kind, int64_t bytes);
+	static void TrackGPUFree(GPUMemoryKind kind, int64_t bytes);
+
+	static MemorySnapshot TakeSnapshot();
+	static bool WriteSnapshotDiff(const std::string& path, const MemorySnapshot& before, const MemorySnapshot& after);
+
+	static const char* TagToString(MemoryTag tag);
+	static const char* GPUKindToString(GPUMemoryKind kind);
+
+	static int64_t GetTextureBytes(uint32_t width, uint32_t height, uint32_t bytesPerPixel, uint32_t mipLevels = 1, uint32_t samples = 1);
+};
+
+struct MemoryTagScope
+{
+	MemoryTagScope(MemoryTag tag) : m_Previous(MemoryTracker::SetCurrentTag(tag)) {}
+	~MemoryTagScope() { MemoryTracker::SetCurrentTag(m_Previous); }
+
+	MemoryTagScope(const MemoryTagScope&) = delete;
+	MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+private:
+	MemoryTag m_Previous;
+};
+
+#define GABGL_MEMORY_TAG_CONCAT_INNER(a, b) a##b
+#define GABGL_MEMORY_TAG_CONCAT(a, b) GABGL_MEMORY_TAG_CONCAT_INNER(a, b)
+#define GABGL_MEMORY_TAG(tag) MemoryTagScope GABGL_MEMORY_TAG_CONCAT(memoryTag, __LINE__)(MemoryTag::tag)
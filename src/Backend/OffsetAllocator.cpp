@@ -0,0 +1,267 @@
+#include "OffsetAllocator.h"
+#include "BackendLogger.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace Utils {
+
+	static constexpr uint32_t MantissaBits = 3;
+	static constexpr uint32_t MantissaValue = 1u << MantissaBits;
+	static constexpr uint32_t MantissaMask = MantissaValue - 1;
+
+	// Sizes below MantissaValue get a bin each, above that every power of two is split in 8
+	static uint32_t SizeToBin(uint32_t size, bool roundUp)
+	{
+		if (size < MantissaValue)
+			return size;
+
+		uint32_t highestBit = 31 - (uint32_t)std::countl_zero(size);
+		uint32_t mantissaStart = highestBit - MantissaBits;
+		uint32_t exponent = mantissaStart + 1;
+		uint32_t mantissa = (size >> mantissaStart) & MantissaMask;
+
+		// A carry out of the mantissa lands in the exponent, which is the next bin up anyway
+		if (roundUp && (size & ((1u << mantissaStart) - 1)))
+			mantissa++;
+		return (exponent << MantissaBits) + mantissa;
+	}
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t size)
+{
+	Reset(size);
+}
+
+void OffsetAllocator::Reset(uint32_t size)
+{
+	m_Size = 0;
+	m_FreeStorage = 0;
+	m_AllocationCount = 0;
+	m_Tail = Unused;
+	m_UsedTopBins = 0;
+	std::fill(std::begin(m_UsedLeafBins), std::end(m_UsedLeafBins), (uint8_t)0);
+	std::fill(std::begin(m_BinHeads), std::end(m_BinHeads), Unused);
+	m_Nodes.clear();
+	m_FreeNodes.clear();
+
+	Grow(size);
+}
+
+void OffsetAllocator::Grow(uint32_t newSize)
+{
+	if (newSize <= m_Size)
+		return;
+
+	uint32_t extra = newSize - m_Size;
+	if (m_Tail != Unused && !m_Nodes[m_Tail].Used)
+	{
+		RemoveFromBin(m_Tail);
+		m_Nodes[m_Tail].Size += extra;
+		AddToBin(m_Tail);
+	}
+	else
+	{
+		uint32_t nodeIndex = NewNode();
+		Node& node = m_Nodes[nodeIndex];
+		node.Offset = m_Size;
+		node.Size = extra;
+		node.NeighborPrev = m_Tail;
+		if (m_Tail != Unused)
+			m_Nodes[m_Tail].NeighborNext = nodeIndex;
+		m_Tail = nodeIndex;
+		AddToBin(nodeIndex);
+	}
+	m_Size = newSize;
+}
+
+OffsetAllocation OffsetAllocator::Allocate(uint32_t size)
+{
+	if (size == 0 || size > m_FreeStorage)
+		return {};
+
+	uint32_t minBin = Utils::SizeToBin(size, true);
+	uint32_t top = minBin / LeafBins;
+	uint32_t leaf = minBin % LeafBins;
+
+	// Smallest non-empty bin at or above minBin: first within the same top bin, then any higher one
+	uint32_t nodeIndex = Unused;
+	uint32_t leafMask = (m_UsedTopBins & (1u << top)) ? m_UsedLeafBins[top] & (0xFFu << leaf) : 0;
+	uint32_t topMask = top + 1 < TopBins ? m_UsedTopBins & (~0u << (top + 1)) : 0;
+	if (leafMask)
+		nodeIndex = m_BinHeads[top * LeafBins + (uint32_t)std::countr_zero(leafMask)];
+	else if (topMask)
+	{
+		uint32_t nextTop = (uint32_t)std::countr_zero(topMask);
+		nodeIndex = m_BinHeads[nextTop * LeafBins + (uint32_t)std::countr_zero((uint32_t)m_UsedLeafBins[nextTop])];
+	}
+	else
+	{
+		// The bin below minBin can still hold a range that fits, like the whole space when it is all free
+		for (uint32_t candidate = m_BinHeads[Utils::SizeToBin(size, false)]; candidate != Unused; candidate = m_Nodes[candidate].BinNext)
+		{
+			if (m_Nodes[candidate].Size >= size)
+			{
+				nodeIndex = candidate;
+				break;
+			}
+		}
+		if (nodeIndex == Unused)
+			return {};
+	}
+
+	RemoveFromBin(nodeIndex);
+
+	uint32_t offset = m_Nodes[nodeIndex].Offset;
+	uint32_t remainder = m_Nodes[nodeIndex].Size - size;
+	m_Nodes[nodeIndex].Size = size;
+	m_Nodes[nodeIndex].Used = true;
+
+	if (remainder > 0)
+	{
+		// NewNode() may reallocate m_Nodes, so no references are held across it
+		uint32_t splitIndex = NewNode();
+		uint32_t next = m_Nodes[nodeIndex].NeighborNext;
+		Node& split = m_Nodes[splitIndex];
+		split.Offset = offset + size;
+		split.Size = remainder;
+		split.NeighborPrev = nodeIndex;
+		split.NeighborNext = next;
+		if (next != Unused)
+			m_Nodes[next].NeighborPrev = splitIndex;
+		else
+			m_Tail = splitIndex;
+		m_Nodes[nodeIndex].NeighborNext = splitIndex;
+		AddToBin(splitIndex);
+	}
+
+	m_AllocationCount++;
+	return { offset, nodeIndex };
+}
+
+void OffsetAllocator::Free(OffsetAllocation allocation)
+{
+	if (!allocation)
+		return;
+
+	uint32_t nodeIndex = allocation.Node;
+	GABGL_ASSERT(nodeIndex < m_Nodes.size() && m_Nodes[nodeIndex].Used, "Freeing a range that is not allocated!");
+
+	Node node = m_Nodes[nodeIndex];
+	uint32_t prev = node.NeighborPrev;
+	uint32_t next = node.NeighborNext;
+
+	if (prev != Unused && !m_Nodes[prev].Used)
+	{
+		node.Offset = m_Nodes[prev].Offset;
+		node.Size += m_Nodes[prev].Size;
+		RemoveFromBin(prev);
+		uint32_t prevPrev = m_Nodes[prev].NeighborPrev;
+		ReleaseNode(prev);
+		prev = prevPrev;
+	}
+
+	if (next != Unused && !m_Nodes[next].Used)
+	{
+		node.Size += m_Nodes[next].Size;
+		RemoveFromBin(next);
+		uint32_t nextNext = m_Nodes[next].NeighborNext;
+		ReleaseNode(next);
+		next = nextNext;
+	}
+
+	node.Used = false;
+	node.NeighborPrev = prev;
+	node.NeighborNext = next;
+	m_Nodes[nodeIndex] = node;
+	if (prev != Unused)
+		m_Nodes[prev].NeighborNext = nodeIndex;
+	if (next != Unused)
+		m_Nodes[next].NeighborPrev = nodeIndex;
+	else
+		m_Tail = nodeIndex;
+
+	AddToBin(nodeIndex);
+	m_AllocationCount--;
+}
+
+uint32_t OffsetAllocator::GetLargestFree() const
+{
+	if (!m_UsedTopBins)
+		return 0;
+
+	uint32_t top = 31 - (uint32_t)std::countl_zero(m_UsedTopBins);
+	uint32_t leaf = 31 - (uint32_t)std::countl_zero((uint32_t)m_UsedLeafBins[top]);
+
+	uint32_t largest = 0;
+	for (uint32_t nodeIndex = m_BinHeads[top * LeafBins + leaf]; nodeIndex != Unused; nodeIndex = m_Nodes[nodeIndex].BinNext)
+		largest = std::max(largest, m_Nodes[nodeIndex].Size);
+	return largest;
+}
+
+uint32_t OffsetAllocator::GetAllocationSize(OffsetAllocation allocation) const
+{
+	return allocation ? m_Nodes[allocation.Node].Size : 0;
+}
+
+void OffsetAllocator::AddToBin(uint32_t nodeIndex)
+{
+	Node& node = m_Nodes[nodeIndex];
+	uint32_t bin = Utils::SizeToBin(node.Size, false);
+	uint32_t top = bin / LeafBins;
+	uint32_t leaf = bin % LeafBins;
+
+	node.BinPrev = Unused;
+	node.BinNext = m_BinHeads[bin];
+	if (node.BinNext != Unused)
+		m_Nodes[node.BinNext].BinPrev = nodeIndex;
+	m_BinHeads[bin] = nodeIndex;
+
+	m_UsedTopBins |= 1u << top;
+	m_UsedLeafBins[top] |= (uint8_t)(1u << leaf);
+	m_FreeStorage += node.Size;
+}
+
+void OffsetAllocator::RemoveFromBin(uint32_t nodeIndex)
+{
+	Node& node = m_Nodes[nodeIndex];
+	uint32_t bin = Utils::SizeToBin(node.Size, false);
+
+	if (node.BinPrev != Unused)
+		m_Nodes[node.BinPrev].BinNext = node.BinNext;
+	else
+		m_BinHeads[bin] = node.BinNext;
+	if (node.BinNext != Unused)
+		m_Nodes[node.BinNext].BinPrev = node.BinPrev;
+
+	if (m_BinHeads[bin] == Unused)
+	{
+		uint32_t top = bin / LeafBins;
+		m_UsedLeafBins[top] &= (uint8_t)~(1u << (bin % LeafBins));
+		if (!m_UsedLeafBins[top])
+			m_UsedTopBins &= ~(1u << top);
+	}
+
+	node.BinPrev = Unused;
+	node.BinNext = Unused;
+	m_FreeStorage -= node.Size;
+}
+
+uint32_t OffsetAllocator::NewNode()
+{
+	if (!m_FreeNodes.empty())
+	{
+		uint32_t nodeIndex = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+		m_Nodes[nodeIndex] = Node{};
+		return nodeIndex;
+	}
+
+	m_Nodes.emplace_back();
+	return (uint32_t)m_Nodes.size() - 1;
+}
+
+void OffsetAllocator::ReleaseNode(uint32_t nodeIndex)
+{
+	m_FreeNodes.push_back(nodeIndex);
+}
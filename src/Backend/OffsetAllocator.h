@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct OffsetAllocation
+{
+	static constexpr uint32_t NoSpace = 0xFFFFFFFF;
+
+	uint32_t Offset = NoSpace;
+	uint32_t Node = NoSpace;
+
+	explicit operator bool() const { return Offset != NoSpace; }
+};
+
+// Hands out ranges of an abstract [0, size) space, the caller decides what a unit is (a vertex,
+// an index, a byte). Two-level segregated fit: free ranges sit in 256 bins laid out like a tiny
+// float (5 bit exponent, 3 bit mantissa), two bitmasks find a fitting bin in O(1) and freed
+// ranges merge with free neighbours right away. Nothing is ever moved, compacting is up to
+// the owner of the memory.
+struct OffsetAllocator
+{
+	OffsetAllocator(uint32_t size = 0);
+
+	void Reset(uint32_t size);
+	// Extends the space at its end, existing allocations keep their offsets
+	void Grow(uint32_t newSize);
+
+	OffsetAllocation Allocate(uint32_t size);
+	void Free(OffsetAllocation allocation);
+
+	uint32_t GetSize() const { return m_Size; }
+	uint32_t GetFreeStorage() const { return m_FreeStorage; }
+	uint32_t GetLargestFree() const;
+	uint32_t GetAllocationCount() const { return m_AllocationCount; }
+	uint32_t GetAllocationSize(OffsetAllocation allocation) const;
+
+private:
+	static constexpr uint32_t TopBins = 32;
+	static constexpr uint32_t LeafBins = 8;
+	static constexpr uint32_t Unused = 0xFFFFFFFF;
+
+	struct Node
+	{
+		uint32_t Offset = 0;
+		uint32_t Size = 0;
+		uint32_t BinPrev = Unused;
+		uint32_t BinNext = Unused;
+		uint32_t NeighborPrev = Unused;
+		uint32_t NeighborNext = Unused;
+		bool Used = false;
+	};
+
+	void AddToBin(uint32_t nodeIndex);
+	void RemoveFromBin(uint32_t nodeIndex);
+	uint32_t NewNode();
+	void ReleaseNode(uint32_t nodeIndex);
+
+	uint32_t m_Size = 0;
+	uint32_t m_FreeStorage = 0;
+	uint32_t m_AllocationCount = 0;
+	uint32_t m_Tail = Unused; // highest-offset node, Grow() extends it
+
+	uint32_t m_UsedTopBins = 0;
+	uint8_t m_UsedLeafBins[TopBins] = {};
+	uint32_t m_BinHeads[TopBins * LeafBins];
+
+	std::vector<Node> m_Nodes;
+	std::vector<uint32_t> m_FreeNodes;
+};
@@ -0,0 +1,321 @@
+#include "Profiler.h"
+#include "BackendLogger.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace Utils {
+
+	struct ProfileRing
+	{
+		ProfileEvent Events[Profiler::RingCapacity];
+		std::atomic<uint32_t> Head{ 0 }; // written by the owning thread
+		std::atomic<uint32_t> Tail{ 0 }; // written by the draining thread
+		std::atomic<bool> InUse{ true };
+		uint32_t ThreadID = 0;
+		std::string ThreadName;
+	};
+
+	struct ThreadState
+	{
+		ProfileRing* Ring = nullptr;
+		uint32_t Depth = 0;
+		const char* ZoneNames[Profiler::MaxZoneDepth] = {};
+
+		// Hand the ring back when the thread exits so short-lived threads don't pile up buffers
+		~ThreadState()
+		{
+			if (Ring)
+				Ring->InUse.store(false, std::memory_order_release);
+		}
+	};
+
+	static void WriteJsonString(std::ofstream& out, const char* text)
+	{
+		out << '"';
+		for (const char* c = text; *c; c++)
+		{
+			switch (*c)
+			{
+				case '"':  out << "\\\""; break;
+				case '\\': out << "\\\\"; break;
+				case '\n': out << "\\n"; break;
+				default:   out << *c; break;
+			}
+		}
+		out << '"';
+	}
+}
+
+struct ProfilerData
+{
+	std::atomic<bool> Enabled{ true };
+	std::atomic<uint64_t> DroppedEvents{ 0 };
+
+	std::mutex RingsMutex;
+	std::vector<Scope<Utils::ProfileRing>> Rings;
+	std::atomic<uint32_t> NextThreadID{ 0 };
+
+	struct Track
+	{
+		uint32_t ID;
+		std::string Name;
+	};
+	std::vector<Track> Tracks;
+
+	std::vector<ProfileEvent> LastFrameEvents;
+	uint64_t LastFrameStart = 0;
+	uint64_t LastFrameEnd = 0;
+	uint64_t CurrentFrameStart = 0;
+
+	bool Capturing = false;
+	std::vector<ProfileEvent> CaptureEvents;
+};
+
+static ProfilerData s_Data;
+static thread_local Utils::ThreadState s_ThreadState;
+
+static Utils::ProfileRing& GetThreadRing()
+{
+	if (!s_ThreadState.Ring)
+	{
+		std::lock_guard<std::mutex> lock(s_Data.RingsMutex);
+		for (auto& ring : s_Data.Rings)
+		{
+			bool inUse = false;
+			if (ring->InUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+			{
+				s_ThreadState.Ring = ring.get();
+				return *s_ThreadState.Ring;
+			}
+		}
+
+		s_Data.Rings.push_back(CreateScope<Utils::ProfileRing>());
+		s_ThreadState.Ring = s_Data.Rings.back().get();
+		s_ThreadState.Ring->ThreadID = s_Data.NextThreadID++;
+		s_ThreadState.Ring->ThreadName = s_ThreadState.Ring->ThreadID == 0 ? "Main" : "Thread " + std::to_string(s_ThreadState.Ring->ThreadID);
+	}
+
+	return *s_ThreadState.Ring;
+}
+
+static void PushEvent(Utils::ProfileRing& ring, const ProfileEvent& event)
+{
+	uint32_t head = ring.Head.load(std::memory_order_relaxed);
+	uint32_t tail = ring.Tail.load(std::memory_order_acquire);
+	if (head - tail >= Profiler::RingCapacity)
+	{
+		s_Data.DroppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ring.Events[head & (Profiler::RingCapacity - 1)] = event;
+	ring.Head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::BeginFrame()
+{
+	uint64_t now = Now();
+
+	s_Data.LastFrameEvents.clear();
+	{
+		std::lock_guard<std::mutex> lock(s_Data.RingsMutex);
+		for (auto& ring : s_Data.Rings)
+		{
+			uint32_t tail = ring->Tail.load(std::memory_order_relaxed);
+			uint32_t head = ring->Head.load(std::memory_order_acquire);
+			for (; tail != head; tail++)
+				s_Data.LastFrameEvents.push_back(ring->Events[tail & (RingCapacity - 1)]);
+			ring->Tail.store(tail, std::memory_order_release);
+		}
+	}
+
+	s_Data.LastFrameStart = s_Data.CurrentFrameStart ? s_Data.CurrentFrameStart : now;
+	s_Data.LastFrameEnd = now;
+	s_Data.CurrentFrameStart = now;
+
+	if (s_Data.Capturing)
+	{
+		size_t room = MaxCaptureEvents - s_Data.CaptureEvents.size();
+		size_t count = s_Data.LastFrameEvents.size() < room ? s_Data.LastFrameEvents.size() : room;
+		s_Data.CaptureEvents.insert(s_Data.CaptureEvents.end(), s_Data.LastFrameEvents.begin(), s_Data.LastFrameEvents.begin() + count);
+	}
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	s_Data.Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsEnabled()
+{
+	return s_Data.Enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::Now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::BeginZone(const char* name)
+{
+	if (s_ThreadState.Depth < MaxZoneDepth)
+		s_ThreadState.ZoneNames[s_ThreadState.Depth] = name;
+	s_ThreadState.Depth++;
+}
+
+void Profiler::EndZone(const char* name, uint64_t start)
+{
+	uint64_t end = Now();
+	Utils::ProfileRing& ring = GetThreadRing();
+
+	s_ThreadState.Depth--;
+	PushEvent(ring, { name, start, end, s_ThreadState.Depth, ring.ThreadID });
+}
+
+const char* Profiler::GetCurrentZone()
+{
+	uint32_t depth = s_ThreadState.Depth;
+	if (depth == 0)
+		return nullptr;
+	return s_ThreadState.ZoneNames[(depth < MaxZoneDepth ? depth : MaxZoneDepth) - 1];
+}
+
+void Profiler::SubmitEvent(const ProfileEvent& event)
+{
+	PushEvent(GetThreadRing(), event);
+}
+
+uint32_t Profiler::CreateTrack(const char* name)
+{
+	std::lock_guard<std::mutex> lock(s_Data.RingsMutex);
+	s_Data.Tracks.push_back({ s_Data.NextThreadID++, name });
+	return s_Data.Tracks.back().ID;
+}
+
+bool Profiler::IsTrack(uint32_t threadID)
+{
+	std::lock_guard<std::mutex> lock(s_Data.RingsMutex);
+	for (auto& track : s_Data.Tracks)
+	{
+		if (track.ID == threadID)
+			return true;
+	}
+
+	return false;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	Utils::ProfileRing& ring = GetThreadRing();
+	std::lock_guard<std::mutex> lock(s_Data.RingsMutex);
+	ring.ThreadName = name;
+}
+
+uint32_t Profiler::GetThreadID()
+{
+	return GetThreadRing().ThreadID;
+}
+
+const char* Profiler::GetThreadName(uint32_t threadID)
+{
+	std::lock_guard<std::mutex> lock(s_Data.RingsMutex);
+	for (auto& ring : s_Data.Rings)
+	{
+		if (ring->ThreadID == threadID)
+			return ring->ThreadName.c_str();
+	}
+	for (auto& track : s_Data.Tracks)
+	{
+		if (track.ID == threadID)
+			return track.Name.c_str();
+	}
+
+	return "Unknown";
+}
+
+const std::vector<ProfileEvent>& Profiler::GetLastFrameEvents()
+{
+	return s_Data.LastFrameEvents;
+}
+
+uint64_t Profiler::GetLastFrameStart()
+{
+	return s_Data.LastFrameStart;
+}
+
+uint64_t Profiler::GetLastFrameEnd()
+{
+	return s_Data.LastFrameEnd;
+}
+
+uint64_t Profiler::GetDroppedEvents()
+{
+	return s_Data.DroppedEvents.load(std::memory_order_relaxed);
+}
+
+void Profiler::BeginCapture()
+{
+	s_Data.CaptureEvents.clear();
+	s_Data.Capturing = true;
+}
+
+void Profiler::EndCapture()
+{
+	s_Data.Capturing = false;
+}
+
+bool Profiler::IsCapturing()
+{
+	return s_Data.Capturing;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path)
+{
+	std::ofstream out(path);
+	if (!out.is_open())
+	{
+		GABGL_ERROR("Could not write trace to {0}", path);
+		return false;
+	}
+
+	uint64_t origin = s_Data.CaptureEvents.empty() ? 0 : s_Data.CaptureEvents.front().Start;
+	for (const auto& event : s_Data.CaptureEvents)
+		origin = event.Start < origin ? event.Start : origin;
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	bool first = true;
+	std::vector<uint32_t> namedThreads;
+	for (const auto& event : s_Data.CaptureEvents)
+	{
+		bool named = false;
+		for (uint32_t id : namedThreads)
+			named |= id == event.ThreadID;
+
+		if (!named)
+		{
+			namedThreads.push_back(event.ThreadID);
+			out << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << event.ThreadID << ",\"args\":{\"name\":";
+			Utils::WriteJsonString(out, GetThreadName(event.ThreadID));
+			out << "}}";
+			first = false;
+		}
+
+		out << (first ? "" : ",") << "{\"name\":";
+		Utils::WriteJsonString(out, event.Name);
+		out << ",\"cat\":\"" << (IsTrack(event.ThreadID) ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.ThreadID
+			<< ",\"ts\":" << (event.Start - origin) / 1000.0
+			<< ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+		first = false;
+	}
+
+	out << "]}";
+
+	GABGL_INFO("Exported {0} profile events to {1}", s_Data.CaptureEvents.size(), path);
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ProfileEvent
+{
+	const char* Name;
+	uint64_t Start; // ns
+	uint64_t End;   // ns
+	uint32_t Depth;
+	uint32_t ThreadID;
+};
+
+// Every thread records finished zones into its own single-producer ring, the main
+// thread drains all rings in BeginFrame(). Recording never locks or allocates.
+struct Profiler
+{
+	static constexpr uint32_t RingCapacity = 1 << 16;
+	static constexpr uint32_t MaxCaptureEvents = 1 << 21;
+	static constexpr uint32_t MaxZoneDepth = 64;
+
+	static void BeginFrame();
+
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled();
+
+	static uint64_t Now();
+
+	static void BeginZone(const char* name);
+	static void EndZone(const char* name, uint64_t start);
+	// Innermost open zone of the calling thread, nullptr outside any zone or while disabled
+	static const char* GetCurrentZone();
+	static void SubmitEvent(const ProfileEvent& event);
+
+	// Virtual timeline (e.g. the GPU) that other threads submit finished events into
+	static uint32_t CreateTrack(const char* name);
+	static bool IsTrack(uint32_t threadID);
+
+	static void SetThreadName(const char* name);
+	static uint32_t GetThreadID();
+	static const char* GetThreadName(uint32_t threadID);
+
+	// Events that finished during the last completed frame
+	static const std::vector<ProfileEvent>& GetLastFrameEvents();
+	static uint64_t GetLastFrameStart();
+	static uint64_t GetLastFrameEnd();
+	static uint64_t GetDroppedEvents();
+
+	static void BeginCapture();
+	static void EndCapture();
+	static bool IsCapturing();
+	static bool ExportChromeTrace(const std::string& path);
+};
+
+struct ProfileScope
+{
+	ProfileScope(const char* name)
+		: m_Name(name), m_Active(Profiler::IsEnabled())
+	{
+		if (m_Active)
+		{
+			Profiler::BeginZone(m_Name);
+			m_Start = Profiler::Now();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (m_Active)
+			Profiler::EndZone(m_Name, m_Start);
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+	const char* m_Name;
+	uint64_t m_Start = 0;
+	bool m_Active;
+};
+
+#define GABGL_PROFILE_CONCAT_INNER(a, b) a##b
+#define GABGL_PROFILE_CONCAT(a, b) GABGL_PROFILE_CONCAT_INNER(a, b)
+
+#ifndef GABGL_DISABLE_PROFILING
+	#define GABGL_PROFILE_SCOPE(name) ProfileScope GABGL_PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define GABGL_PROFILE_FUNCTION() GABGL_PROFILE_SCOPE(__func__)
+#else
+	#define GABGL_PROFILE_SCOPE(name)
+	#define GABGL_PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include "BackendLogger.h"
+#include "BackendScopeRef.h"
+
+// 32-bit generational handle: low 20 bits index a slot in the per-type pool,
+// high 12 bits hold the slot generation. Generation 0 is never handed out, so
+// a default constructed handle is null. Handles don't own anything; a handle
+// whose slot has been destroyed or reused simply stops resolving.
+template<typename T>
+struct Handle
+{
+	static constexpr uint32_t IndexBits = 20;
+	static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+	static constexpr uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+	uint32_t Value = 0;
+
+	Handle() = default;
+	Handle(uint32_t index, uint32_t generation)
+		: Value((generation << IndexBits) | (index & IndexMask)) {}
+
+	inline uint32_t GetIndex() const { return Value & IndexMask; }
+	inline uint32_t GetGeneration() const { return Value >> IndexBits; }
+
+	T* Get() const;
+	bool IsValid() const { return Get() != nullptr; }
+	explicit operator bool() const { return IsValid(); }
+
+	T* operator->() const;
+	T& operator*() const { return *operator->(); }
+
+	bool operator==(Handle other) const { return Value == other.Value; }
+	bool operator!=(Handle other) const { return Value != other.Value; }
+};
+
+struct ResourcePools
+{
+	static constexpr uint32_t FramesInFlight = 2;
+
+	// Releases deferred destructions that are old enough, call once per frame
+	static void CollectGarbage() { for (auto& pool : GetRegistry()) pool.Collect(pool.Instance); }
+	// Destroys everything still alive, call while the GL context is current
+	static void Shutdown() { for (auto& pool : GetRegistry()) pool.Clear(pool.Instance); }
+
+	struct Entry
+	{
+		void* Instance;
+		void (*Collect)(void*);
+		void (*Clear)(void*);
+	};
+
+	static std::vector<Entry>& GetRegistry()
+	{
+		static std::vector<Entry> s_Registry;
+		return s_Registry;
+	}
+};
+
+template<typename T>
+struct ResourcePool
+{
+	static constexpr uint32_t ChunkBits = 8;
+	static constexpr uint32_t ChunkSize = 1u << ChunkBits;
+
+	ResourcePool()
+	{
+		ResourcePools::GetRegistry().push_back({ this,
+			[](void* pool) { static_cast<ResourcePool*>(pool)->Collect(); },
+			[](void* pool) { static_cast<ResourcePool*>(pool)->Clear(); } });
+	}
+
+	~ResourcePool() { Clear(); }
+
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	template<typename ... Args>
+	Handle<T> Create(Args&& ... args)
+	{
+		uint32_t index;
+		if (!m_FreeList.empty())
+		{
+			index = m_FreeList.back();
+			m_FreeList.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)m_Generations.size();
+			GABGL_ASSERT(index <= Handle<T>::IndexMask, "Resource pool is full!");
+
+			if ((index >> ChunkBits) >= m_Chunks.size())
+				m_Chunks.push_back(CreateScope<Chunk>());
+
+			m_Generations.push_back(0);
+			m_Alive.push_back(false);
+		}
+
+		uint32_t& generation = m_Generations[index];
+		generation = (generation + 1) & Handle<T>::GenerationMask;
+		if (generation == 0)
+			generation = 1;
+
+		new (GetSlot(index)) T(std::forward<Args>(args)...);
+		m_Alive[index] = true;
+		m_AliveCount++;
+
+		return Handle<T>(index, generation);
+	}
+
+	inline T* Get(Handle<T> handle) const
+	{
+		uint32_t index = handle.GetIndex();
+		if (handle.GetGeneration() == 0 || index >= m_Generations.size() || m_Generations[index] != handle.GetGeneration())
+			return nullptr;
+
+		return GetSlot(index);
+	}
+
+	void Destroy(Handle<T> handle)
+	{
+		T* resource = Get(handle);
+		if (!resource)
+			return;
+
+		resource->~T();
+
+		uint32_t index = handle.GetIndex();
+		m_Generations[index] = (m_Generations[index] + 1) & Handle<T>::GenerationMask;
+		m_Alive[index] = false;
+		m_FreeList.push_back(index);
+		m_AliveCount--;
+	}
+
+	// Keeps the resource alive for FramesInFlight more frames so in-flight draws can still use it
+	void DestroyDeferred(Handle<T> handle)
+	{
+		if (Get(handle))
+			m_PendingDestroy.push_back({ handle, ResourcePools::FramesInFlight });
+	}
+
+	void Collect()
+	{
+		for (size_t i = 0; i < m_PendingDestroy.size();)
+		{
+			if (--m_PendingDestroy[i].FramesLeft == 0)
+			{
+				Destroy(m_PendingDestroy[i].Resource);
+				m_PendingDestroy[i] = m_PendingDestroy.back();
+				m_PendingDestroy.pop_back();
+			}
+			else
+				i++;
+		}
+	}
+
+	void Clear()
+	{
+		m_PendingDestroy.clear();
+		for (uint32_t index = 0; index < m_Generations.size(); index++)
+		{
+			if (m_Alive[index])
+				Destroy(Handle<T>(index, m_Generations[index]));
+		}
+	}
+
+	inline uint32_t GetAliveCount() const { return m_AliveCount; }
+	inline uint32_t GetCapacity() const { return (uint32_t)m_Chunks.size() * ChunkSize; }
+
+private:
+	struct Chunk
+	{
+		alignas(T) unsigned char Storage[ChunkSize][sizeof(T)];
+	};
+
+	struct PendingDestroy
+	{
+		Handle<T> Resource;
+		uint32_t FramesLeft;
+	};
+
+	inline T* GetSlot(uint32_t index) const
+	{
+		return std::launder(reinterpret_cast<T*>(m_Chunks[index >> ChunkBits]->Storage[index & (ChunkSize - 1)]));
+	}
+
+private:
+	// Chunks are never reallocated, so resources keep their address for their whole lifetime
+	std::vector<Scope<Chunk>> m_Chunks;
+	std::vector<uint32_t> m_Generations;
+	std::vector<bool> m_Alive;
+	std::vector<uint32_t> m_FreeList;
+	std::vector<PendingDestroy> m_PendingDestroy;
+	uint32_t m_AliveCount = 0;
+};
+
+template<typename T>
+inline ResourcePool<T> s_ResourcePool;
+
+template<typename T, typename ... Args>
+Handle<T> CreateHandle(Args&& ... args)
+{
+	return s_ResourcePool<T>.Create(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void DestroyHandle(Handle<T> handle)
+{
+	s_ResourcePool<T>.DestroyDeferred(handle);
+}
+
+template<typename T>
+inline T* Handle<T>::Get() const
+{
+	return s_ResourcePool<T>.Get(*this);
+}
+
+template<typename T>
+inline T* Handle<T>::operator->() const
+{
+	T* resource = Get();
+	GABGL_ASSERT(resource, "Stale or null resource handle!");
+	return resource;
+}
@@ -6,6 +6,7 @@
 #include "backends/imgui_impl_opengl3.h"
 
 #include "../Engine.h"
+#include "../Renderer/RendererAPI.h"
 
 #include "ImGuizmo.h"
 
@@ -69,7 +70,10 @@ void ImGuiLayer::End()
 	io.DisplaySize = ImVec2((float)m_Window->GetWidth(), (float)m_Window->GetHeight());
 
 	ImGui::Render();
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	{
+		GABGL_PROFILE_GPU_SCOPE("ImGui");
+		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	}
 
 	if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
 	{
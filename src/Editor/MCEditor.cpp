@@ -13,11 +13,18 @@
 #include "../Input/UserInput.h"
 #include "../Backend/Utils.hpp"
 #include "../Renderer/RendererAPI.h"
+#include "../Renderer/GLIntercept.h"
+#include "../Backend/FrameArena.h"
+#include "../Backend/Profiler.h"
+#include "../Backend/FrameTelemetry.h"
+#include "../Renderer/ShaderCache.h"
+#include "../Renderer/TextureLibrary.h"
+#include "../Renderer/TextureStreamer.h"
 
 MainEditor::MainEditor() : Layer("MainEditor"), m_BaseDirectory(Engine::GetInstance().GetCurrentProjectPath()), m_CurrentDirectory(m_BaseDirectory), m_GizmoType(ImGuizmo::OPERATION::TRANSLATE)
 {
-	m_FolderIcon = Texture::Create("../res/engineTextures/foldericon.png");
-	m_FileIcon = Texture::Create("../res/engineTextures/projfileicon.png");
+	m_FolderIcon = TextureLibrary::Load("../res/engineTextures/foldericon.png", TextureLoad::Blocking);
+	m_FileIcon = TextureLibrary::Load("../res/engineTextures/projfileicon.png", TextureLoad::Blocking);
 }
 
 void MainEditor::OnAttach()
@@ -36,11 +43,15 @@ void MainEditor::OnAttach()
 
 void MainEditor::OnDetach()
 {
-
+	Framebuffer::Destroy(m_Framebuffer);
+	TextureLibrary::Release(m_FolderIcon);
+	TextureLibrary::Release(m_FileIcon);
 }
 
 void MainEditor::OnUpdate(DeltaTime dt)
 {
+	GABGL_PROFILE_SCOPE("MainEditor::OnUpdate");
+
 	m_ActiveScene->OnViewportResize((uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y);
 
 	// Resize
@@ -53,6 +64,7 @@ void MainEditor::OnUpdate(DeltaTime dt)
 		m_EditorCamera.SetViewportSize(m_ViewportSize.x, m_ViewportSize.y);
 	}
 	Renderer2D::ResetStats();
+	GABGL_PROFILE_GPU_SCOPE("Viewport");
 	m_Framebuffer->Bind();
 	RendererAPI::SetClearColor({ 0.1f, 0.1f, 0.1f, 1 });
 	RendererAPI::Clear();
@@ -189,6 +201,8 @@ void MainEditor::OnImGuiRender()
 
 	DebugProfilerPanel();
 
+	MemoryPanel();
+
 	ViewportPanel();
 	// PANELS //
 
@@ -746,11 +760,10 @@ void MainEditor::DrawComponents(Entity entity)
 				{
 					const wchar_t* path = (const wchar_t*)payload->Data;
 					std::filesystem::path texturePath(path);
-					Ref<Texture> texture = Texture::Create(texturePath.string());
-					if (texture->IsLoaded())
-						component.Texture = texture;
-					else
-						GABGL_WARN("Could not load texture {0}", texturePath.filename().string());
+					// Shows the placeholder until the upload finishes, a failed load logs and keeps it.
+					// Sprites dropped from the same file share one texture
+					TextureLibrary::Release(component.Texture);
+					component.Texture = TextureLibrary::Load(texturePath.string());
 				}
 				ImGui::EndDragDropTarget();
 			}
@@ -816,7 +829,7 @@ void MainEditor::ContentBrowserPanel()
 			continue;
 
 		ImGui::PushID(filenameString.c_str());
-		Ref<Texture> icon = directoryEntry.is_directory() ? m_FolderIcon : m_FileIcon;
+		Handle<Texture> icon = directoryEntry.is_directory() ? m_FolderIcon : m_FileIcon;
 		ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
 		ImGui::ImageButton((ImTextureID)icon->GetRendererID(), { thumbnailSize, thumbnailSize }, { 0, 1 }, { 1, 0 });
 
@@ -851,17 +864,278 @@ void MainEditor::DebugProfilerPanel()
 	ImGui::Begin("Debug Instrumentation", nullptr, ImGuiWindowFlags_NoCollapse);
 	CenteredText("Debug Instrumentation");
 
-	if (ImGui::Button("Reload 2D Shaders")) puts("TO BE DONE");
-	if (ImGui::Button("Reload 3D Shaders")) puts("TO BE DONE");
+	if (ImGui::Button("Reload Shaders")) Shader::ReloadAll();
+	ImGui::SameLine();
+	bool hotReload = Shader::IsHotReloadEnabled();
+	if (ImGui::Checkbox("Hot Reload", &hotReload))
+		Shader::SetHotReload(hotReload);
+
+	bool profilerEnabled = Profiler::IsEnabled();
+	if (ImGui::Checkbox("Profiler", &profilerEnabled))
+		Profiler::SetEnabled(profilerEnabled);
+	ImGui::SameLine();
+	if (!Profiler::IsCapturing())
+	{
+		if (ImGui::Button("Start Capture"))
+			Profiler::BeginCapture();
+	}
+	else if (ImGui::Button("Stop Capture & Export"))
+	{
+		Profiler::EndCapture();
+		Profiler::ExportChromeTrace("profile_trace.json");
+	}
+	if (uint64_t dropped = Profiler::GetDroppedEvents())
+		ImGui::Text("Dropped events: %llu", (unsigned long long)dropped);
+
+	ProfilerFlameGraph();
+	FrameTelemetryPanel();
+
+	const auto& arenaStats = FrameArena::GetStats();
+	ImGui::Separator();
+	ImGui::Text("Frame arena: %.1f / %.1f KB (peak %.1f KB)", arenaStats.BytesLastFrame / 1024.0f, arenaStats.Capacity / 1024.0f, arenaStats.PeakBytes / 1024.0f);
+	if (arenaStats.OverflowAllocations)
+		ImGui::Text("Frame arena overflows: %u", arenaStats.OverflowAllocations);
+
+	const auto& cacheStats = ShaderCache::GetStats();
+	ImGui::Text("Shaders: %u cached (%.1f ms), %u compiled (%.1f ms)", cacheStats.Hits, cacheStats.WarmMs, cacheStats.Compiled, cacheStats.ColdMs);
+
+	if (TextureStreamer::IsEnabled())
+	{
+		const auto streamStats = TextureStreamer::GetStats();
+		ImGui::Text("Texture streaming: %u textures, %.1f / %.1f MB resident (%.1f MB full), %u loading", streamStats.Textures, streamStats.ResidentBytes / (1024.0f * 1024.0f), TextureStreamer::GetBudget() / (1024.0f * 1024.0f), streamStats.FullBytes / (1024.0f * 1024.0f), streamStats.LoadsInFlight);
+	}
+
+	const auto& stateStats = RendererAPI::GetStateStats();
+	ImGui::Text("GL state: %u calls, %u redundant skipped", stateStats.GetTotalIssued(), stateStats.GetTotalSkipped());
+	GLCallsPanel();
+
+	ImGui::End();
+}
+
+void MainEditor::FrameTelemetryPanel()
+{
+	ImGui::Separator();
+
+	const auto& stats = FrameTelemetry::GetStats();
+	uint32_t sampleCount = FrameTelemetry::GetSampleCount();
+	uint32_t plotCount = sampleCount < 512 ? sampleCount : 512;
+	uint32_t plotOffset = sampleCount - plotCount;
+
+	auto getFrameMs = [](void* data, int index) { return FrameTelemetry::GetSample(*(uint32_t*)data + index).FrameMs; };
+	ImGui::PlotLines("##FrameTimes", getFrameMs, &plotOffset, (int)plotCount, 0, nullptr, 0.0f, stats.P99 * 1.5f, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+
+	ImGui::Text("Frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f  mean %.2f", stats.P50, stats.P95, stats.P99, stats.Max, stats.Mean);
+
+	float threshold = FrameTelemetry::GetHitchThresholdMs();
+	float medianFactor = FrameTelemetry::GetHitchMedianFactor();
+	bool changed = ImGui::DragFloat("Hitch ms", &threshold, 0.1f, 1.0f, 500.0f, "%.1f");
+	changed |= ImGui::DragFloat("Hitch x median", &medianFactor, 0.05f, 1.0f, 10.0f, "%.2f");
+	if (changed)
+		FrameTelemetry::SetHitchThreshold(threshold, medianFactor);
+
+	if (ImGui::Button("Export CSV"))
+		FrameTelemetry::Export("frame_telemetry.csv");
+	ImGui::SameLine();
+	if (ImGui::Button("Export JSON"))
+		FrameTelemetry::Export("frame_telemetry.json");
+
+	if (ImGui::TreeNode("Hitches", "Hitches: %llu", (unsigned long long)FrameTelemetry::GetTotalHitches()))
+	{
+		uint32_t hitchCount = FrameTelemetry::GetHitchCount();
+		for (uint32_t i = hitchCount; i-- > 0 && hitchCount - i <= 16;)
+		{
+			const auto& hitch = FrameTelemetry::GetHitch(i);
+			ImGui::Text("#%llu  %.2f ms (> %.2f)", (unsigned long long)hitch.FrameIndex, hitch.FrameMs, hitch.ThresholdMs);
+			for (uint32_t t = 0; t < hitch.TagCount; t++)
+				ImGui::BulletText("%s  %.2f ms", hitch.Tags[t], hitch.TagMs[t]);
+		}
+		ImGui::TreePop();
+	}
+}
+
+void MainEditor::GLCallsPanel()
+{
+	if (!GLIntercept::IsInstalled())
+		return;
+
+	const GLFrameStats& frame = GLIntercept::GetLastFrame();
+	if (!ImGui::TreeNode("GLCalls", "GL calls: %llu, %.1f KB uploaded", (unsigned long long)frame.Calls, frame.Bytes / 1024.0f))
+		return;
+
+	auto drawTable = [](const char* id, const char* header, size_t count, auto getRow)
+	{
+		if (!ImGui::BeginTable(id, 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+			return;
+
+		ImGui::TableSetupColumn(header);
+		ImGui::TableSetupColumn("Calls");
+		ImGui::TableSetupColumn("KB");
+		ImGui::TableHeadersRow();
+
+		for (size_t i = 0; i < count; i++)
+		{
+			auto [name, calls, bytes] = getRow(i);
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+			ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)calls);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", bytes / 1024.0f);
+		}
+
+		ImGui::EndTable();
+	};
 
-	for (auto& result : s_ProfileResults)
+	drawTable("##GLZones", "Zone", frame.Zones.size(),
+		[&](size_t i) { const auto& zone = frame.Zones[i]; return std::tuple(zone.Zone, zone.Calls, zone.Bytes); });
+	drawTable("##GLFunctions", "Function", frame.Functions.size(),
+		[&](size_t i) { const auto& function = frame.Functions[i]; return std::tuple(function.Name, function.Calls, function.Bytes); });
+
+	ImGui::TreePop();
+}
+
+void MainEditor::ProfilerFlameGraph()
+{
+	const auto& events = Profiler::GetLastFrameEvents();
+	uint64_t frameStart = Profiler::GetLastFrameStart();
+	uint64_t frameEnd = Profiler::GetLastFrameEnd();
+	if (events.empty() || frameEnd <= frameStart)
+	{
+		ImGui::TextUnformatted("No profile data");
+		return;
+	}
+
+	// Zones are recorded when they close, so some of them started before the frame boundary.
+	// Tracks like the GPU arrive a few frames late and are drawn from their own frame start
+	uint32_t threadIDs[16];
+	uint32_t threadDepths[16];
+	uint64_t threadOrigins[16];
+	bool threadIsTrack[16];
+	uint32_t threadCount = 0;
+	for (const auto& event : events)
+	{
+		uint32_t t = 0;
+		while (t < threadCount && threadIDs[t] != event.ThreadID)
+			t++;
+		if (t == threadCount)
+		{
+			if (threadCount == 16)
+				continue;
+			threadIDs[threadCount] = event.ThreadID;
+			threadDepths[threadCount] = 0;
+			threadOrigins[threadCount] = event.Start;
+			threadIsTrack[threadCount++] = Profiler::IsTrack(event.ThreadID);
+		}
+		threadDepths[t] = event.Depth > threadDepths[t] ? event.Depth : threadDepths[t];
+		threadOrigins[t] = event.Start < threadOrigins[t] ? event.Start : threadOrigins[t];
+
+		if (!threadIsTrack[t])
+			frameStart = event.Start < frameStart ? event.Start : frameStart;
+	}
+	for (uint32_t t = 0; t < threadCount; t++)
 	{
-		char label[50];
-		std::strcpy(label, result.Name);
-		std::strcat(label, " %.3fms");
-		ImGui::Text(label, result.Time);
+		if (!threadIsTrack[t])
+			threadOrigins[t] = frameStart;
 	}
-	s_ProfileResults.clear();
+
+	const double frameDuration = (double)(frameEnd - frameStart);
+	ImGui::Text("Frame %.3fms", frameDuration / 1e6);
+
+	const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+	const float width = ImGui::GetContentRegionAvail().x;
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+	for (uint32_t t = 0; t < threadCount; t++)
+	{
+		ImGui::TextUnformatted(Profiler::GetThreadName(threadIDs[t]));
+
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		float height = (threadDepths[t] + 1) * rowHeight;
+		ImGui::PushID((int)threadIDs[t]);
+		ImGui::InvisibleButton("##FlameGraph", { width, height });
+		ImGui::PopID();
+
+		for (const auto& event : events)
+		{
+			if (event.ThreadID != threadIDs[t])
+				continue;
+
+			float x0 = origin.x + (float)((event.Start - threadOrigins[t]) / frameDuration) * width;
+			float x1 = origin.x + (float)((event.End - threadOrigins[t]) / frameDuration) * width;
+			x1 = x1 < x0 + 1.0f ? x0 + 1.0f : x1;
+			float y0 = origin.y + event.Depth * rowHeight;
+			float y1 = y0 + rowHeight - 1.0f;
+
+			uint32_t hash = 2166136261u;
+			for (const char* c = event.Name; *c; c++)
+				hash = (hash ^ (uint8_t)*c) * 16777619u;
+
+			drawList->AddRectFilled({ x0, y0 }, { x1, y1 }, ImColor::HSV((hash % 360) / 360.0f, 0.5f, 0.7f));
+			if (x1 - x0 > 20.0f)
+			{
+				drawList->PushClipRect({ x0, y0 }, { x1, y1 }, true);
+				drawList->AddText({ x0 + 2.0f, y0 }, IM_COL32_WHITE, event.Name);
+				drawList->PopClipRect();
+			}
+
+			if (ImGui::IsMouseHoveringRect({ x0, y0 }, { x1, y1 }))
+				ImGui::SetTooltip("%s %.3fms", event.Name, (event.End - event.Start) / 1e6);
+		}
+	}
+}
+
+void MainEditor::MemoryPanel()
+{
+	ImGui::Begin("Memory", nullptr, ImGuiWindowFlags_NoCollapse);
+	CenteredText("Memory");
+
+	MemorySnapshot snapshot = MemoryTracker::TakeSnapshot();
+
+	if (ImGui::Button("Take Baseline"))
+	{
+		m_MemoryBaseline = snapshot;
+		m_HasMemoryBaseline = true;
+	}
+	ImGui::SameLine();
+	ImGui::BeginDisabled(!m_HasMemoryBaseline);
+	if (ImGui::Button("Export Diff"))
+		MemoryTracker::WriteSnapshotDiff("memory_diff.json", m_MemoryBaseline, snapshot);
+	ImGui::EndDisabled();
+
+	auto drawTable = [this](const char* id, const char* header, const MemoryStats* stats, const MemoryStats* baseline, size_t count, const char* (*getName)(size_t))
+	{
+		if (!ImGui::BeginTable(id, 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+			return;
+
+		ImGui::TableSetupColumn(header);
+		ImGui::TableSetupColumn("Current KB");
+		ImGui::TableSetupColumn("Peak KB");
+		ImGui::TableSetupColumn("Live Allocs");
+		ImGui::TableSetupColumn("Delta KB");
+		ImGui::TableHeadersRow();
+
+		for (size_t i = 0; i < count; i++)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(getName(i));
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", stats[i].CurrentBytes / 1024.0f);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", stats[i].PeakBytes / 1024.0f);
+			ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)stats[i].LiveAllocations);
+			ImGui::TableNextColumn();
+			if (m_HasMemoryBaseline)
+				ImGui::Text("%+.1f", (stats[i].CurrentBytes - baseline[i].CurrentBytes) / 1024.0f);
+			else
+				ImGui::TextUnformatted("-");
+		}
+
+		ImGui::EndTable();
+	};
+
+	ImGui::SeparatorText("CPU");
+	drawTable("##CPUMemory", "Tag", snapshot.CPU, m_MemoryBaseline.CPU, (size_t)MemoryTag::Count,
+		[](size_t i) { return MemoryTracker::TagToString((MemoryTag)i); });
+
+	ImGui::SeparatorText("GPU");
+	drawTable("##GPUMemory", "Kind", snapshot.GPU, m_MemoryBaseline.GPU, (size_t)GPUMemoryKind::Count,
+		[](size_t i) { return MemoryTracker::GPUKindToString((GPUMemoryKind)i); });
 
 	ImGui::End();
 }
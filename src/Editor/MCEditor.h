@@ -8,6 +8,7 @@
 #include "../Scene/Scene.h"
 #include "../Renderer/FrameBuffer.h"
 #include "../Scene/Entity.hpp"
+#include "../Backend/MemoryTracker.h"
 
 #include <filesystem>
 #include <glm/glm.hpp>
@@ -36,6 +37,10 @@ private:
 	void ComponentsPanel();
 	void ContentBrowserPanel();
 	void DebugProfilerPanel();
+	void ProfilerFlameGraph();
+	void FrameTelemetryPanel();
+	void GLCallsPanel();
+	void MemoryPanel();
 	void CenteredText(const char* text);
 	void DrawEntityNode(Entity entity);
 	void DrawComponents(Entity entity);
@@ -49,7 +54,7 @@ private:
 	};
 	SceneState m_SceneState = SceneState::Edit;
 
-	Ref<Framebuffer> m_Framebuffer;
+	Handle<Framebuffer> m_Framebuffer;
 	bool isPopupOpen = false;
 	int m_GizmoType;
 	Entity m_SelectionContext;
@@ -64,5 +69,8 @@ private:
 	glm::vec2 m_ViewportSize = { 0.0f, 0.0f };
 	glm::vec2 m_ViewportBounds[2];
 
-	Ref<Texture> m_FolderIcon, m_FileIcon;
+	Handle<Texture> m_FolderIcon, m_FileIcon;
+
+	MemorySnapshot m_MemoryBaseline;
+	bool m_HasMemoryBaseline = false;
 };
\ No newline at end of file
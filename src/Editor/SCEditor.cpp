@@ -7,18 +7,22 @@
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 #include "../Engine.h"
+#include "../Renderer/TextureLibrary.h"
 #include <json.hpp>
 
 static char projectName[256] = ""; 
 
 StartEditor::StartEditor() : Layer("StartEditor")
 {
-	m_ProjIcon = Texture::Create("../res/engineTextures/projfileicon.png");
+	m_ProjIcon = TextureLibrary::Load("../res/engineTextures/projfileicon.png", TextureLoad::Blocking);
 }
 
 void StartEditor::OnAttach(){}
 
-void StartEditor::OnDetach(){}
+void StartEditor::OnDetach()
+{
+	TextureLibrary::Release(m_ProjIcon);
+}
 
 void StartEditor::OnImGuiRender()
 {
@@ -111,11 +115,11 @@ void StartEditor::NewProject(const std::string& projectName)
 	namespace fs = std::filesystem;
 	try {
 		if (fs::exists(generalProjectsFolderPath)) {
-			GABGL_WARN("Project folder already exists: {}", generalProjectsFolderPath);
+			GABGL_WARN("Project folder already exists: {}", generalProjectsFolderPath.string());
 		}
 		else {
 			fs::create_directory(generalProjectsFolderPath);
-			GABGL_INFO("Created project folder: {}", generalProjectsFolderPath);
+			GABGL_INFO("Created project folder: {}", generalProjectsFolderPath.string());
 		}
 
 
@@ -127,12 +131,12 @@ void StartEditor::NewProject(const std::string& projectName)
 	fs::path projectPath = generalProjectsFolderPath / projectName;
 	try {
 		if (fs::exists(projectPath)) {
-			GABGL_WARN("Project folder already exists: {}",projectPath);
+			GABGL_WARN("Project folder already exists: {}",projectPath.string());
 			return;
 		}
 
 		fs::create_directory(projectPath);
-		GABGL_INFO("Created project folder: {}", projectPath);
+		GABGL_INFO("Created project folder: {}", projectPath.string());
 
 		fs::path projectFile = projectPath / (projectName + ".proj");
 
@@ -148,19 +152,19 @@ void StartEditor::NewProject(const std::string& projectName)
 		if (file) {
 			file << projectJson.dump(4); 
 			file.close();
-			GABGL_INFO("Created project file: {}", projectFile);
+			GABGL_INFO("Created project file: {}", projectFile.string());
 		}
 		else {
-			GABGL_ERROR("Failed to create project file: {}", projectFile);
+			GABGL_ERROR("Failed to create project file: {}", projectFile.string());
 		}
 
 		fs::path Path = projectPath / "Assets";
 		fs::create_directory(Path);
-		GABGL_INFO("Created Assets folder: {}", Path);
+		GABGL_INFO("Created Assets folder: {}", Path.string());
 
 		Path = projectPath / "Scenes";
 		fs::create_directory(Path);
-		GABGL_INFO("Created Scenes folder: {}", Path);
+		GABGL_INFO("Created Scenes folder: {}", Path.string());
 	}
 	catch (const fs::filesystem_error& e) {
 		GABGL_ERROR("Filesystem error: {}", e.what());
@@ -185,11 +189,11 @@ void StartEditor::DeleteProject(const std::filesystem::path& projectPath)
 			{
 				throw std::runtime_error("Failed to delete folder: " + projectPath.string());
 			}
-			GABGL_INFO("Deleted folder: {}",projectPath);
+			GABGL_INFO("Deleted folder: {}",projectPath.string());
 		}
 		else
 		{
-			GABGL_WARN("Folder not found: {}", projectPath);
+			GABGL_WARN("Folder not found: {}", projectPath.string());
 		}
 	}
 	catch (const std::exception& e)
@@ -24,6 +24,6 @@ private:
 	void DeleteProject(const std::filesystem::path& projectPath);
 	std::filesystem::path generalProjectsFolderPath = std::filesystem::current_path() / "Projects";
 private:
-	Ref<Texture> m_ProjIcon;
+	Handle<Texture> m_ProjIcon;
 	void ProjectsBrowserPanel();
 };
\ No newline at end of file
@@ -2,7 +2,17 @@
 #include "Backend/BackendLogger.h"
 #include "Backend/MainWindow.h"
 #include "Backend/StartWindow.h"
+#include "Backend/FrameArena.h"
+#include "Backend/ResourcePool.h"
+#include "Backend/Profiler.h"
+#include "Backend/FrameTelemetry.h"
+#include "Backend/FileWatcher.h"
+#include "Backend/JobSystem.h"
 #include "Renderer/Renderer.h"
+#include "Renderer/RendererAPI.h"
+#include "Renderer/Renderer2D.h"
+#include "Renderer/TextureLibrary.h"
+#include "Renderer/TextureStreamer.h"
 
 Engine* Engine::s_Instance = nullptr;
 
@@ -10,12 +20,26 @@ Engine::Engine()
 {
 	s_Instance = this;
 	Log::Init();
+	Profiler::SetThreadName("Main");
+	FrameArena::Init();
+	FileWatcher::Init();
+	JobSystem::Init();
 	Run();
 }
 
 Engine::~Engine()
 {
-	
+	JobSystem::Shutdown();
+	TextureLibrary::Shutdown();
+	// Renderer::Init() runs with the main window, its teardown needs that context still current
+	if (m_MainWindow)
+		Renderer::Shutdown();
+	ResourcePools::Shutdown();
+	Texture::ShutdownLoader();
+	TextureStreamer::Shutdown();
+	FrameArena::Shutdown();
+	FileWatcher::Shutdown();
+	Log::Shutdown();
 }
 
 void Engine::Run()
@@ -24,6 +48,19 @@ void Engine::Run()
 
     while (m_isRunning)
     {
+		Profiler::BeginFrame();
+		RendererAPI::BeginGPUFrame();
+		FrameTelemetry::EndFrame();
+		FrameArena::BeginFrame();
+		ResourcePools::CollectGarbage();
+		if (auto changedFiles = FileWatcher::PollChanges(); !changedFiles.empty())
+			Shader::OnFilesChanged(changedFiles);
+		Shader::PollPending();
+		Texture::PollPending();
+		TextureLibrary::PollPending();
+		TextureStreamer::Update();
+		Renderer::BeginFrame();
+
 		GABGL_PROFILE_SCOPE("Main Loop");
 
 		DeltaTime dt;
@@ -57,9 +94,22 @@ void Engine::Run()
 				RenderEditorLayers();
 			}
 
-            m_MainWindow->Update();
+			{
+				GABGL_PROFILE_SCOPE("Window Update");
+				m_MainWindow->Update();
+			}
 
         }
+
+		Renderer::EndFrame();
+
+		auto rendererStats = Renderer2D::GetStats();
+		FrameTelemetry::SetCounter(FrameCounter::DrawCalls, rendererStats.DrawCalls);
+		FrameTelemetry::SetCounter(FrameCounter::Quads, rendererStats.QuadCount);
+		FrameTelemetry::SetCounter(FrameCounter::ArenaBytes, FrameArena::GetStats().BytesThisFrame);
+		const auto& stateStats = RendererAPI::GetStateStats();
+		FrameTelemetry::SetCounter(FrameCounter::StateCalls, stateStats.GetTotalIssued());
+		FrameTelemetry::SetCounter(FrameCounter::RedundantStateCalls, stateStats.GetTotalSkipped());
     }
 }
 
@@ -134,12 +184,16 @@ void Engine::SetupMainWindow()
 
 void Engine::RenderLayers(DeltaTime& dt)
 {
+	GABGL_PROFILE_SCOPE("Layers Update");
+
 	for (Layer* layer : m_LayerStack)
 		layer->OnUpdate(dt);
 }
 
 void Engine::RenderEditorLayers()
 {
+	GABGL_PROFILE_SCOPE("ImGui");
+
 	m_ImGuiLayer->Begin();
 	{
 		for (Layer* layer : m_LayerStack)
@@ -0,0 +1,461 @@
+#include "BlockCompression.h"
+#include "../Backend/BackendLogger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Utils {
+
+	static constexpr uint32_t BlockPixels = 16;
+
+	// BC7 interpolation weights for 4-bit indices, out of 64
+	static constexpr uint32_t s_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Principal axis of the block by power iteration on the covariance matrix, the endpoints
+	// are the extremes of the projections onto it
+	template<uint32_t Channels>
+	static void FindEndpoints(const float (&pixels)[BlockPixels][Channels], float (&low)[Channels], float (&high)[Channels])
+	{
+		float mean[Channels] = {};
+		for (uint32_t i = 0; i < BlockPixels; i++)
+			for (uint32_t c = 0; c < Channels; c++)
+				mean[c] += pixels[i][c] / BlockPixels;
+
+		float covariance[Channels][Channels] = {};
+		for (uint32_t i = 0; i < BlockPixels; i++)
+			for (uint32_t a = 0; a < Channels; a++)
+				for (uint32_t b = 0; b < Channels; b++)
+					covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+
+		float axis[Channels];
+		for (uint32_t c = 0; c < Channels; c++)
+			axis[c] = 1.0f;
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float next[Channels] = {};
+			float length = 0.0f;
+			for (uint32_t a = 0; a < Channels; a++)
+			{
+				for (uint32_t b = 0; b < Channels; b++)
+					next[a] += covariance[a][b] * axis[b];
+				length = std::max(length, std::abs(next[a]));
+			}
+			// Flat block, any axis gives the same endpoints
+			if (length < 1e-6f)
+				break;
+			for (uint32_t c = 0; c < Channels; c++)
+				axis[c] = next[c] / length;
+		}
+
+		float axisLength = 0.0f;
+		for (uint32_t c = 0; c < Channels; c++)
+			axisLength += axis[c] * axis[c];
+		axisLength = std::sqrt(axisLength);
+
+		float minT = 0.0f, maxT = 0.0f;
+		for (uint32_t i = 0; i < BlockPixels; i++)
+		{
+			float t = 0.0f;
+			for (uint32_t c = 0; c < Channels; c++)
+				t += (pixels[i][c] - mean[c]) * axis[c] / axisLength;
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for (uint32_t c = 0; c < Channels; c++)
+		{
+			low[c] = std::clamp(mean[c] + axis[c] / axisLength * minT, 0.0f, 255.0f);
+			high[c] = std::clamp(mean[c] + axis[c] / axisLength * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	// Least squares endpoints for fixed indices, weights[i] is how much of `high` pixel i gets.
+	// Returns false when every pixel picked the same weight and the system is singular.
+	template<uint32_t Channels>
+	static bool RefineEndpoints(const float (&pixels)[BlockPixels][Channels], const float (&weights)[BlockPixels], float (&low)[Channels], float (&high)[Channels])
+	{
+		float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+		float alphaX[Channels] = {}, betaX[Channels] = {};
+		for (uint32_t i = 0; i < BlockPixels; i++)
+		{
+			float alpha = weights[i], beta = 1.0f - weights[i];
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			for (uint32_t c = 0; c < Channels; c++)
+			{
+				alphaX[c] += alpha * pixels[i][c];
+				betaX[c] += beta * pixels[i][c];
+			}
+		}
+
+		float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (std::abs(determinant) < 1e-6f)
+			return false;
+
+		for (uint32_t c = 0; c < Channels; c++)
+		{
+			high[c] = std::clamp((alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant, 0.0f, 255.0f);
+			low[c] = std::clamp((betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	static uint16_t PackRGB565(const float (&color)[3])
+	{
+		uint32_t r = (uint32_t)std::lround(color[0] * 31.0f / 255.0f);
+		uint32_t g = (uint32_t)std::lround(color[1] * 63.0f / 255.0f);
+		uint32_t b = (uint32_t)std::lround(color[2] * 31.0f / 255.0f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void UnpackRGB565(uint16_t packed, int32_t (&color)[3])
+	{
+		uint32_t r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+		color[0] = (int32_t)((r << 3) | (r >> 2));
+		color[1] = (int32_t)((g << 2) | (g >> 4));
+		color[2] = (int32_t)((b << 3) | (b >> 2));
+	}
+
+	// Indices and squared error of a BC1 block in four-color mode, color0 must be above color1
+	static uint32_t MatchBC1Indices(const float (&pixels)[BlockPixels][3], uint16_t color0, uint16_t color1, uint32_t& indices)
+	{
+		int32_t palette[4][3];
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		uint32_t totalError = 0;
+		indices = 0;
+		for (uint32_t i = 0; i < BlockPixels; i++)
+		{
+			uint32_t best = 0, bestError = ~0u;
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				uint32_t error = 0;
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					int32_t delta = (int32_t)pixels[i][c] - palette[p][c];
+					error += (uint32_t)(delta * delta);
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= best << (i * 2);
+			totalError += bestError;
+		}
+		return totalError;
+	}
+
+	static void WriteBC1(uint16_t color0, uint16_t color1, uint32_t indices, uint8_t* output)
+	{
+		std::memcpy(output, &color0, 2);
+		std::memcpy(output + 2, &color1, 2);
+		std::memcpy(output + 4, &indices, 4);
+	}
+
+	// 128-bit little endian bit stream, BC7 fields are packed from bit 0 up
+	struct BitWriter
+	{
+		uint8_t* Output;
+		uint32_t Position = 0;
+
+		void Write(uint32_t value, uint32_t bits)
+		{
+			for (uint32_t bit = 0; bit < bits; bit++, Position++)
+			{
+				if (value & (1u << bit))
+					Output[Position >> 3] |= (uint8_t)(1u << (Position & 7));
+			}
+		}
+	};
+
+	// 7-bit endpoint plus the shared p-bit, whichever p-bit lands closer
+	static void QuantizeBC7Endpoint(const float (&color)[4], uint32_t (&quantized)[4], uint32_t& pBit)
+	{
+		float bestError = 0.0f;
+		for (uint32_t p = 0; p < 2; p++)
+		{
+			uint32_t candidate[4];
+			float error = 0.0f;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				candidate[c] = (uint32_t)std::clamp((int32_t)std::lround((color[c] - (float)p) * 0.5f), 0, 127);
+				float delta = (float)(candidate[c] * 2 + p) - color[c];
+				error += delta * delta;
+			}
+			if (p == 0 || error < bestError)
+			{
+				bestError = error;
+				pBit = p;
+				std::memcpy(quantized, candidate, sizeof(candidate));
+			}
+		}
+	}
+
+	static uint32_t MatchBC7Indices(const float (&pixels)[BlockPixels][4], const uint32_t (&low)[4], const uint32_t (&high)[4], uint32_t (&indices)[BlockPixels])
+	{
+		int32_t palette[16][4];
+		for (uint32_t p = 0; p < 16; p++)
+			for (uint32_t c = 0; c < 4; c++)
+				palette[p][c] = (int32_t)(((64 - s_BC7Weights[p]) * low[c] + s_BC7Weights[p] * high[c] + 32) >> 6);
+
+		uint32_t totalError = 0;
+		for (uint32_t i = 0; i < BlockPixels; i++)
+		{
+			uint32_t best = 0, bestError = ~0u;
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				uint32_t error = 0;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					int32_t delta = (int32_t)pixels[i][c] - palette[p][c];
+					error += (uint32_t)(delta * delta);
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			indices[i] = best;
+			totalError += bestError;
+		}
+		return totalError;
+	}
+
+	// Gathers a 4x4 block as RGBA, missing channels read as 0 and alpha as opaque
+	static void LoadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, uint32_t blockX, uint32_t blockY, uint8_t* rgba)
+	{
+		for (uint32_t y = 0; y < BlockCompression::BlockSize; y++)
+		{
+			uint32_t sourceY = std::min(blockY * BlockCompression::BlockSize + y, height - 1);
+			for (uint32_t x = 0; x < BlockCompression::BlockSize; x++)
+			{
+				uint32_t sourceX = std::min(blockX * BlockCompression::BlockSize + x, width - 1);
+				const uint8_t* source = pixels + ((size_t)sourceY * width + sourceX) * channels;
+				uint8_t* destination = rgba + (y * BlockCompression::BlockSize + x) * 4;
+				destination[0] = source[0];
+				destination[1] = channels > 1 ? source[1] : 0;
+				destination[2] = channels > 2 ? source[2] : 0;
+				destination[3] = channels > 3 ? source[3] : 255;
+			}
+		}
+	}
+}
+
+uint32_t BlockCompression::GetBlockBytes(TextureCompression compression)
+{
+	switch (compression)
+	{
+		case TextureCompression::BC1:
+		case TextureCompression::BC4: return 8;
+		case TextureCompression::BC3:
+		case TextureCompression::BC5:
+		case TextureCompression::BC7: return 16;
+		case TextureCompression::None: return 0;
+	}
+
+	return 0;
+}
+
+uint64_t BlockCompression::GetCompressedSize(TextureCompression compression, uint32_t width, uint32_t height)
+{
+	uint64_t blocksX = (width + BlockSize - 1) / BlockSize;
+	uint64_t blocksY = (height + BlockSize - 1) / BlockSize;
+	return blocksX * blocksY * GetBlockBytes(compression);
+}
+
+void BlockCompression::Encode(TextureCompression compression, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, uint8_t* output)
+{
+	GABGL_ASSERT(compression != TextureCompression::None && channels >= 1 && channels <= 4, "Invalid block compression input!");
+
+	uint32_t blocksX = (width + BlockSize - 1) / BlockSize;
+	uint32_t blocksY = (height + BlockSize - 1) / BlockSize;
+	uint32_t blockBytes = GetBlockBytes(compression);
+
+	uint8_t rgba[Utils::BlockPixels * 4];
+	for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+		{
+			Utils::LoadBlock(pixels, width, height, channels, blockX, blockY, rgba);
+			uint8_t* block = output + ((size_t)blockY * blocksX + blockX) * blockBytes;
+			switch (compression)
+			{
+				case TextureCompression::BC1: EncodeBC1Block(rgba, block); break;
+				case TextureCompression::BC3: EncodeBC3Block(rgba, block); break;
+				case TextureCompression::BC4: EncodeBC4Block(rgba, 0, block); break;
+				case TextureCompression::BC5:
+					EncodeBC4Block(rgba, 0, block);
+					EncodeBC4Block(rgba, 1, block + 8);
+					break;
+				case TextureCompression::BC7: EncodeBC7Block(rgba, block); break;
+				case TextureCompression::None: break;
+			}
+		}
+	}
+}
+
+void BlockCompression::EncodeBC1Block(const uint8_t* rgba, uint8_t* output)
+{
+	float pixels[Utils::BlockPixels][3];
+	for (uint32_t i = 0; i < Utils::BlockPixels; i++)
+		for (uint32_t c = 0; c < 3; c++)
+			pixels[i][c] = rgba[i * 4 + c];
+
+	float low[3], high[3];
+	Utils::FindEndpoints(pixels, low, high);
+
+	uint16_t color0 = Utils::PackRGB565(high), color1 = Utils::PackRGB565(low);
+	if (color0 < color1)
+		std::swap(color0, color1);
+	// Equal endpoints would select the three-color mode, one color is all the block needs anyway
+	if (color0 == color1)
+	{
+		Utils::WriteBC1(color0, color1, 0, output);
+		return;
+	}
+
+	uint32_t indices;
+	uint32_t error = Utils::MatchBC1Indices(pixels, color0, color1, indices);
+
+	// One least squares pass on the chosen indices usually beats the axis extremes
+	static constexpr float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float pixelWeights[Utils::BlockPixels];
+	for (uint32_t i = 0; i < Utils::BlockPixels; i++)
+		pixelWeights[i] = weights[(indices >> (i * 2)) & 3];
+
+	if (Utils::RefineEndpoints(pixels, pixelWeights, low, high))
+	{
+		uint16_t refined0 = Utils::PackRGB565(high), refined1 = Utils::PackRGB565(low);
+		if (refined0 < refined1)
+			std::swap(refined0, refined1);
+
+		uint32_t refinedIndices;
+		if (refined0 != refined1 && Utils::MatchBC1Indices(pixels, refined0, refined1, refinedIndices) < error)
+		{
+			color0 = refined0;
+			color1 = refined1;
+			indices = refinedIndices;
+		}
+	}
+
+	Utils::WriteBC1(color0, color1, indices, output);
+}
+
+void BlockCompression::EncodeBC3Block(const uint8_t* rgba, uint8_t* output)
+{
+	EncodeBC4Block(rgba, 3, output);
+	EncodeBC1Block(rgba, output + 8);
+}
+
+void BlockCompression::EncodeBC4Block(const uint8_t* rgba, uint32_t channel, uint8_t* output)
+{
+	uint32_t minValue = 255, maxValue = 0;
+	for (uint32_t i = 0; i < Utils::BlockPixels; i++)
+	{
+		minValue = std::min<uint32_t>(minValue, rgba[i * 4 + channel]);
+		maxValue = std::max<uint32_t>(maxValue, rgba[i * 4 + channel]);
+	}
+
+	// Eight-value mode (endpoint 0 above endpoint 1); a flat block ends up all index 0
+	output[0] = (uint8_t)maxValue;
+	output[1] = (uint8_t)minValue;
+
+	uint64_t bits = 0;
+	if (maxValue > minValue)
+	{
+		float scale = 7.0f / (float)(maxValue - minValue);
+		for (uint32_t i = 0; i < Utils::BlockPixels; i++)
+		{
+			// Steps above endpoint 1, 7 is endpoint 0 and 1..6 map to palette entries 7..2
+			uint32_t step = (uint32_t)std::lround((float)(rgba[i * 4 + channel] - minValue) * scale);
+			uint64_t index = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+			bits |= index << (i * 3);
+		}
+	}
+
+	for (uint32_t b = 0; b < 6; b++)
+		output[2 + b] = (uint8_t)(bits >> (b * 8));
+}
+
+void BlockCompression::EncodeBC7Block(const uint8_t* rgba, uint8_t* output)
+{
+	float pixels[Utils::BlockPixels][4];
+	for (uint32_t i = 0; i < Utils::BlockPixels; i++)
+		for (uint32_t c = 0; c < 4; c++)
+			pixels[i][c] = rgba[i * 4 + c];
+
+	float low[4], high[4];
+	Utils::FindEndpoints(pixels, low, high);
+
+	uint32_t quantizedLow[4], quantizedHigh[4], pLow, pHigh;
+	Utils::QuantizeBC7Endpoint(low, quantizedLow, pLow);
+	Utils::QuantizeBC7Endpoint(high, quantizedHigh, pHigh);
+
+	auto expand = [](const uint32_t (&quantized)[4], uint32_t pBit, uint32_t (&endpoint)[4])
+	{
+		for (uint32_t c = 0; c < 4; c++)
+			endpoint[c] = quantized[c] * 2 + pBit;
+	};
+
+	uint32_t endpointLow[4], endpointHigh[4], indices[Utils::BlockPixels];
+	expand(quantizedLow, pLow, endpointLow);
+	expand(quantizedHigh, pHigh, endpointHigh);
+	uint32_t error = Utils::MatchBC7Indices(pixels, endpointLow, endpointHigh, indices);
+
+	float pixelWeights[Utils::BlockPixels];
+	for (uint32_t i = 0; i < Utils::BlockPixels; i++)
+		pixelWeights[i] = (float)Utils::s_BC7Weights[indices[i]] / 64.0f;
+
+	if (Utils::RefineEndpoints(pixels, pixelWeights, low, high))
+	{
+		uint32_t refinedLow[4], refinedHigh[4], refinedPLow, refinedPHigh;
+		Utils::QuantizeBC7Endpoint(low, refinedLow, refinedPLow);
+		Utils::QuantizeBC7Endpoint(high, refinedHigh, refinedPHigh);
+
+		uint32_t refinedEndpointLow[4], refinedEndpointHigh[4], refinedIndices[Utils::BlockPixels];
+		expand(refinedLow, refinedPLow, refinedEndpointLow);
+		expand(refinedHigh, refinedPHigh, refinedEndpointHigh);
+		if (Utils::MatchBC7Indices(pixels, refinedEndpointLow, refinedEndpointHigh, refinedIndices) < error)
+		{
+			std::memcpy(quantizedLow, refinedLow, sizeof(refinedLow));
+			std::memcpy(quantizedHigh, refinedHigh, sizeof(refinedHigh));
+			std::memcpy(indices, refinedIndices, sizeof(refinedIndices));
+			pLow = refinedPLow;
+			pHigh = refinedPHigh;
+		}
+	}
+
+	// The first index is stored with its top bit implied zero, swap the endpoints when it is set
+	if (indices[0] & 8)
+	{
+		std::swap(quantizedLow, quantizedHigh);
+		std::swap(pLow, pHigh);
+		for (uint32_t& index : indices)
+			index = 15 - index;
+	}
+
+	std::memset(output, 0, 16);
+	Utils::BitWriter writer{ output };
+	writer.Write(1u << 6, 7); // mode 6
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		writer.Write(quantizedLow[c], 7);
+		writer.Write(quantizedHigh[c], 7);
+	}
+	writer.Write(pLow, 1);
+	writer.Write(pHigh, 1);
+	writer.Write(indices[0], 3);
+	for (uint32_t i = 1; i < Utils::BlockPixels; i++)
+		writer.Write(indices[i], 4);
+}
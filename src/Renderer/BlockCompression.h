@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+enum class TextureCompression : uint32_t
+{
+	None = 0,
+	BC1, // RGB, 4 bpp
+	BC3, // RGBA, BC1 color plus a BC4 alpha block, 8 bpp
+	BC4, // R, 4 bpp
+	BC5, // RG, two BC4 blocks, 8 bpp
+	BC7  // RGBA, mode 6 only, 8 bpp
+};
+
+// CPU encoders for the desktop block formats. Blocks are 4x4 pixels; images whose size is not a
+// multiple of 4 repeat their last row and column into the padding.
+struct BlockCompression
+{
+	static constexpr uint32_t BlockSize = 4;
+
+	// 8 or 16, 0 for None
+	static uint32_t GetBlockBytes(TextureCompression compression);
+	static uint64_t GetCompressedSize(TextureCompression compression, uint32_t width, uint32_t height);
+
+	// pixels is tightly packed with 1 to 4 channels, output holds GetCompressedSize() bytes
+	static void Encode(TextureCompression compression, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, uint8_t* output);
+
+	// One block of 16 RGBA pixels, row by row
+	static void EncodeBC1Block(const uint8_t* rgba, uint8_t* output);
+	static void EncodeBC3Block(const uint8_t* rgba, uint8_t* output);
+	static void EncodeBC7Block(const uint8_t* rgba, uint8_t* output);
+	// 16 values of the channel at rgba + channel, stride 4
+	static void EncodeBC4Block(const uint8_t* rgba, uint32_t channel, uint8_t* output);
+};
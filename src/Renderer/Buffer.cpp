@@ -1,24 +1,34 @@
 #include "Buffer.h"
+#include "RendererAPI.h"
 
 #include <glad/glad.h>
+#include "../Backend/MemoryTracker.h"
+#include "../Backend/Profiler.h"
+
+#include <algorithm>
 
 VertexBuffer::VertexBuffer(uint32_t size)
+	: m_Size(size)
 {
 	glCreateBuffers(1, &m_RendererID);
 	glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 	glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, m_Size);
 }
 
 VertexBuffer::VertexBuffer(float* vertices, uint32_t size)
+	: m_Size(size)
 {
 	glCreateBuffers(1, &m_RendererID);
 	glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, m_Size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	glDeleteBuffers(1, &m_RendererID);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, m_Size);
 }
 
 void VertexBuffer::Bind() const
@@ -33,8 +43,7 @@ void VertexBuffer::Unbind() const
 
 void VertexBuffer::SetData(const void* data, uint32_t size)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+	glNamedBufferSubData(m_RendererID, 0, size, data);
 }
 
 IndexBuffer::IndexBuffer(uint32_t* indices, uint32_t count)
@@ -46,11 +55,13 @@ IndexBuffer::IndexBuffer(uint32_t* indices, uint32_t count)
 	// Binding with GL_ARRAY_BUFFER allows the data to be loaded regardless of VAO state. 
 	glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 	glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, (int64_t)m_Count * sizeof(uint32_t));
 }
 
 IndexBuffer::~IndexBuffer()
 {
 	glDeleteBuffers(1, &m_RendererID);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, (int64_t)m_Count * sizeof(uint32_t));
 }
 
 void IndexBuffer::Bind() const
@@ -92,23 +103,24 @@ VertexArray::VertexArray()
 VertexArray::~VertexArray()
 {
 	glDeleteVertexArrays(1, &m_RendererID);
+	RendererAPI::OnVertexArrayDeleted(m_RendererID);
 }
 
 void VertexArray::Bind() const
 {
-	glBindVertexArray(m_RendererID);
+	RendererAPI::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	glBindVertexArray(0);
+	RendererAPI::BindVertexArray(0);
 }
 
-void VertexArray::AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer)
+void VertexArray::AddVertexBuffer(Handle<VertexBuffer> vertexBuffer)
 {
 	GABGL_ASSERT(vertexBuffer->GetLayout().GetElements().size(), "Vertex Buffer has no layout!");
 
-	glBindVertexArray(m_RendererID);
+	RendererAPI::BindVertexArray(m_RendererID);
 	vertexBuffer->Bind();
 
 	const auto& layout = vertexBuffer->GetLayout();
@@ -172,28 +184,306 @@ void VertexArray::AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer)
 	m_VertexBuffers.push_back(vertexBuffer);
 }
 
-void VertexArray::SetIndexBuffer(const Ref<IndexBuffer>& indexBuffer)
+void VertexArray::SetIndexBuffer(Handle<IndexBuffer> indexBuffer)
 {
-	glBindVertexArray(m_RendererID);
+	RendererAPI::BindVertexArray(m_RendererID);
 	indexBuffer->Bind();
 
 	m_IndexBuffer = indexBuffer;
 }
 
 UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding)
+	: m_Size(size)
 {
 	glCreateBuffers(1, &m_RendererID);
 	glNamedBufferData(m_RendererID, size, nullptr, GL_DYNAMIC_DRAW); // TODO: investigate usage hint
 	glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, m_Size);
 }
 
 UniformBuffer::~UniformBuffer()
 {
 	glDeleteBuffers(1, &m_RendererID);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, m_Size);
 }
 
 
 void UniformBuffer::SetData(const void* data, uint32_t size, uint32_t offset)
 {
 	glNamedBufferSubData(m_RendererID, offset, size, data);
-}
\ No newline at end of file
+}
+UniformRingBuffer::UniformRingBuffer(uint32_t sizePerFrame)
+{
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	m_Alignment = (uint32_t)alignment;
+	m_SizePerFrame = (sizePerFrame + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &m_RendererID);
+	glNamedBufferStorage(m_RendererID, (GLsizeiptr)m_SizePerFrame * Segments, nullptr, flags);
+	m_Mapped = (uint8_t*)glMapNamedBufferRange(m_RendererID, 0, (GLsizeiptr)m_SizePerFrame * Segments, flags);
+	GABGL_ASSERT(m_Mapped, "Could not map the uniform ring buffer!");
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, m_SizePerFrame * Segments);
+}
+
+UniformRingBuffer::~UniformRingBuffer()
+{
+	for (void* fence : m_Fences)
+	{
+		if (fence)
+			glDeleteSync((GLsync)fence);
+	}
+	glUnmapNamedBuffer(m_RendererID);
+	glDeleteBuffers(1, &m_RendererID);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, m_SizePerFrame * Segments);
+}
+
+void UniformRingBuffer::BeginFrame()
+{
+	m_Segment = (m_Segment + 1) % Segments;
+	m_Head = 0;
+
+	GLsync fence = (GLsync)m_Fences[m_Segment];
+	if (!fence)
+		return;
+
+	// Normally signalled long ago, only a GPU running Segments frames behind stalls here
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+	{
+		GABGL_PROFILE_SCOPE("UniformRingBuffer::Wait");
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+	}
+	glDeleteSync(fence);
+	m_Fences[m_Segment] = nullptr;
+}
+
+void UniformRingBuffer::EndFrame()
+{
+	if (m_Fences[m_Segment])
+		glDeleteSync((GLsync)m_Fences[m_Segment]);
+	m_Fences[m_Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+UniformRingAllocation UniformRingBuffer::Allocate(uint32_t size)
+{
+	uint32_t alignedSize = (size + m_Alignment - 1) / m_Alignment * m_Alignment;
+	if (m_Head + alignedSize > m_SizePerFrame)
+	{
+		if (!m_OverflowReported)
+			GABGL_ERROR("Uniform ring buffer full ({0} bytes per frame), draws are being skipped", m_SizePerFrame);
+		m_OverflowReported = true;
+		return {};
+	}
+
+	UniformRingAllocation allocation;
+	allocation.Offset = m_Segment * m_SizePerFrame + m_Head;
+	allocation.Data = m_Mapped + allocation.Offset;
+	allocation.Size = size;
+	m_Head += alignedSize;
+	return allocation;
+}
+
+void UniformRingBuffer::Bind(UniformBinding binding, const UniformRingAllocation& allocation) const
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, (GLuint)binding, m_RendererID, allocation.Offset, allocation.Size);
+}
+
+GeometryBuffer::GeometryBuffer(const BufferLayout& layout, uint32_t vertexCapacity, uint32_t indexCapacity)
+	: m_Layout(layout)
+{
+	glCreateVertexArrays(1, &m_VertexArrayID);
+
+	// Every attribute reads from binding 0, Reallocate() points it at the current vertex buffer
+	uint32_t attribute = 0;
+	for (const auto& element : m_Layout)
+	{
+		GABGL_ASSERT(element.Type != ShaderDataType::Mat3 && element.Type != ShaderDataType::Mat4, "Per-instance attributes don't belong in a GeometryBuffer!");
+
+		GLenum type = ShaderDataTypeToOpenGLBaseType(element.Type);
+		glEnableVertexArrayAttrib(m_VertexArrayID, attribute);
+		if (type == GL_FLOAT)
+			glVertexArrayAttribFormat(m_VertexArrayID, attribute, element.GetComponentCount(), type, element.Normalized ? GL_TRUE : GL_FALSE, (GLuint)element.Offset);
+		else
+			glVertexArrayAttribIFormat(m_VertexArrayID, attribute, element.GetComponentCount(), type, (GLuint)element.Offset);
+		glVertexArrayAttribBinding(m_VertexArrayID, attribute, 0);
+		attribute++;
+	}
+
+	Reallocate(vertexCapacity, indexCapacity, false);
+}
+
+GeometryBuffer::~GeometryBuffer()
+{
+	glDeleteVertexArrays(1, &m_VertexArrayID);
+	RendererAPI::OnVertexArrayDeleted(m_VertexArrayID);
+	glDeleteBuffers(1, &m_VertexBufferID);
+	glDeleteBuffers(1, &m_IndexBufferID);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, (int64_t)m_VertexCapacity * m_Layout.GetStride() + (int64_t)m_IndexCapacity * sizeof(uint32_t));
+}
+
+uint32_t GeometryBuffer::Upload(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+{
+	if (vertexCount == 0 || indexCount == 0)
+	{
+		GABGL_ERROR("GeometryBuffer can't store an empty mesh");
+		return InvalidMesh;
+	}
+
+	OffsetAllocation vertexRange, indexRange;
+	if (!TryAllocate(vertexCount, indexCount, vertexRange, indexRange))
+	{
+		// Compacting only helps when there is enough room in total, just not in one piece
+		if (m_VertexAllocator.GetFreeStorage() >= vertexCount && m_IndexAllocator.GetFreeStorage() >= indexCount)
+			Defragment();
+
+		if (!TryAllocate(vertexCount, indexCount, vertexRange, indexRange))
+		{
+			Reallocate(std::max(m_VertexCapacity * 2, m_VertexCapacity + vertexCount), std::max(m_IndexCapacity * 2, m_IndexCapacity + indexCount), false);
+			m_Grows++;
+
+			bool allocated = TryAllocate(vertexCount, indexCount, vertexRange, indexRange);
+			GABGL_ASSERT(allocated, "GeometryBuffer could not fit a mesh after growing!");
+		}
+	}
+
+	uint32_t stride = m_Layout.GetStride();
+	glNamedBufferSubData(m_VertexBufferID, (GLintptr)vertexRange.Offset * stride, (GLsizeiptr)vertexCount * stride, vertices);
+	glNamedBufferSubData(m_IndexBufferID, (GLintptr)indexRange.Offset * sizeof(uint32_t), (GLsizeiptr)indexCount * sizeof(uint32_t), indices);
+
+	uint32_t meshID;
+	if (!m_FreeMeshIDs.empty())
+	{
+		meshID = m_FreeMeshIDs.back();
+		m_FreeMeshIDs.pop_back();
+	}
+	else
+	{
+		meshID = (uint32_t)m_Meshes.size();
+		m_Meshes.emplace_back();
+	}
+
+	MeshEntry& mesh = m_Meshes[meshID];
+	mesh.Range = { (int32_t)vertexRange.Offset, indexRange.Offset, vertexCount, indexCount };
+	mesh.Vertices = vertexRange;
+	mesh.Indices = indexRange;
+	mesh.Alive = true;
+	return meshID;
+}
+
+void GeometryBuffer::Free(uint32_t meshID)
+{
+	if (meshID >= m_Meshes.size() || !m_Meshes[meshID].Alive)
+		return;
+
+	MeshEntry& mesh = m_Meshes[meshID];
+	m_VertexAllocator.Free(mesh.Vertices);
+	m_IndexAllocator.Free(mesh.Indices);
+	mesh = MeshEntry{};
+	m_FreeMeshIDs.push_back(meshID);
+}
+
+void GeometryBuffer::Bind() const
+{
+	RendererAPI::BindVertexArray(m_VertexArrayID);
+}
+
+void GeometryBuffer::Draw(uint32_t meshID) const
+{
+	const GeometryRange& range = m_Meshes[meshID].Range;
+	glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)range.IndexCount, GL_UNSIGNED_INT, (const void*)((size_t)range.BaseIndex * sizeof(uint32_t)), range.BaseVertex);
+}
+
+void GeometryBuffer::Defragment()
+{
+	GABGL_PROFILE_SCOPE("GeometryBuffer::Defragment");
+	Reallocate(m_VertexCapacity, m_IndexCapacity, true);
+	m_Defragments++;
+}
+
+GeometryBuffer::Statistics GeometryBuffer::GetStats() const
+{
+	Statistics stats;
+	stats.Meshes = (uint32_t)(m_Meshes.size() - m_FreeMeshIDs.size());
+	stats.VerticesUsed = m_VertexCapacity - m_VertexAllocator.GetFreeStorage();
+	stats.VertexCapacity = m_VertexCapacity;
+	stats.IndicesUsed = m_IndexCapacity - m_IndexAllocator.GetFreeStorage();
+	stats.IndexCapacity = m_IndexCapacity;
+	stats.LargestFreeVertices = m_VertexAllocator.GetLargestFree();
+	stats.Grows = m_Grows;
+	stats.Defragments = m_Defragments;
+	return stats;
+}
+
+bool GeometryBuffer::TryAllocate(uint32_t vertexCount, uint32_t indexCount, OffsetAllocation& vertices, OffsetAllocation& indices)
+{
+	vertices = m_VertexAllocator.Allocate(vertexCount);
+	indices = m_IndexAllocator.Allocate(indexCount);
+	if (vertices && indices)
+		return true;
+
+	m_VertexAllocator.Free(vertices);
+	m_IndexAllocator.Free(indices);
+	return false;
+}
+
+void GeometryBuffer::Reallocate(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact)
+{
+	uint32_t stride = m_Layout.GetStride();
+	GLuint vertexBuffer = 0, indexBuffer = 0;
+	glCreateBuffers(1, &vertexBuffer);
+	glCreateBuffers(1, &indexBuffer);
+	glNamedBufferStorage(vertexBuffer, (GLsizeiptr)vertexCapacity * stride, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(indexBuffer, (GLsizeiptr)indexCapacity * sizeof(uint32_t), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, (int64_t)vertexCapacity * stride + (int64_t)indexCapacity * sizeof(uint32_t));
+
+	if (compact)
+	{
+		// An empty allocator hands out back-to-back ranges, so this packs the meshes in ID order.
+		// The copies stay on the GPU and index data needs no patching, it is relative to BaseVertex.
+		m_VertexAllocator.Reset(vertexCapacity);
+		m_IndexAllocator.Reset(indexCapacity);
+		for (auto& mesh : m_Meshes)
+		{
+			if (!mesh.Alive)
+				continue;
+
+			OffsetAllocation vertices = m_VertexAllocator.Allocate(mesh.Range.VertexCount);
+			OffsetAllocation indices = m_IndexAllocator.Allocate(mesh.Range.IndexCount);
+			glCopyNamedBufferSubData(m_VertexBufferID, vertexBuffer, (GLintptr)mesh.Vertices.Offset * stride, (GLintptr)vertices.Offset * stride, (GLsizeiptr)mesh.Range.VertexCount * stride);
+			glCopyNamedBufferSubData(m_IndexBufferID, indexBuffer, (GLintptr)mesh.Indices.Offset * sizeof(uint32_t), (GLintptr)indices.Offset * sizeof(uint32_t), (GLsizeiptr)mesh.Range.IndexCount * sizeof(uint32_t));
+
+			mesh.Vertices = vertices;
+			mesh.Indices = indices;
+			mesh.Range.BaseVertex = (int32_t)vertices.Offset;
+			mesh.Range.BaseIndex = indices.Offset;
+		}
+	}
+	else if (m_VertexBufferID)
+	{
+		glCopyNamedBufferSubData(m_VertexBufferID, vertexBuffer, 0, 0, (GLsizeiptr)m_VertexCapacity * stride);
+		glCopyNamedBufferSubData(m_IndexBufferID, indexBuffer, 0, 0, (GLsizeiptr)m_IndexCapacity * sizeof(uint32_t));
+		m_VertexAllocator.Grow(vertexCapacity);
+		m_IndexAllocator.Grow(indexCapacity);
+	}
+	else
+	{
+		m_VertexAllocator.Reset(vertexCapacity);
+		m_IndexAllocator.Reset(indexCapacity);
+	}
+
+	if (m_VertexBufferID)
+	{
+		// GL keeps the old storage alive until draws already submitted from it are done
+		glDeleteBuffers(1, &m_VertexBufferID);
+		glDeleteBuffers(1, &m_IndexBufferID);
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, (int64_t)m_VertexCapacity * stride + (int64_t)m_IndexCapacity * sizeof(uint32_t));
+	}
+
+	m_VertexBufferID = vertexBuffer;
+	m_IndexBufferID = indexBuffer;
+	m_VertexCapacity = vertexCapacity;
+	m_IndexCapacity = indexCapacity;
+	glVertexArrayVertexBuffer(m_VertexArrayID, 0, m_VertexBufferID, 0, (GLsizei)stride);
+	glVertexArrayElementBuffer(m_VertexArrayID, m_IndexBufferID);
+}
@@ -1,9 +1,12 @@
 #pragma once
 #include <cstdint>
 #include "../Backend/BackendLogger.h"
-#include "../Backend/BackendScopeRef.h"
+#include "../Backend/ResourcePool.h"
+#include "../Backend/OffsetAllocator.h"
 #include <string>
 #include <vector>
+#include <cstring>
+#include <glm/glm.hpp>
 
 enum class ShaderDataType
 {
@@ -115,10 +118,11 @@ struct VertexBuffer
 
 	const BufferLayout& GetLayout() const { return m_Layout; }
 	void SetLayout(const BufferLayout& layout) { m_Layout = layout; }
-	inline static Ref<VertexBuffer> Create(uint32_t size) { return CreateRef<VertexBuffer>(size); }
-	inline static Ref<VertexBuffer> Create(float* vertices, uint32_t size) { return CreateRef<VertexBuffer>(vertices, size); }
+	inline static Handle<VertexBuffer> Create(uint32_t size) { return CreateHandle<VertexBuffer>(size); }
+	inline static Handle<VertexBuffer> Create(float* vertices, uint32_t size) { return CreateHandle<VertexBuffer>(vertices, size); }
 private:
 	uint32_t m_RendererID;
+	uint32_t m_Size;
 	BufferLayout m_Layout;
 };
 
@@ -131,7 +135,7 @@ struct IndexBuffer
 	void Unbind() const;
 
 	uint32_t GetCount() const { return m_Count; }
-	inline static Ref<IndexBuffer> Create(uint32_t* indices, uint32_t count) { return CreateRef<IndexBuffer>(indices,count); }
+	inline static Handle<IndexBuffer> Create(uint32_t* indices, uint32_t count) { return CreateHandle<IndexBuffer>(indices,count); }
 private:
 	uint32_t m_RendererID;
 	uint32_t m_Count;
@@ -145,17 +149,42 @@ struct VertexArray
 	void Bind() const;
 	void Unbind() const;
 
-	void AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer);
-	void SetIndexBuffer(const Ref<IndexBuffer>& indexBuffer);
+	void AddVertexBuffer(Handle<VertexBuffer> vertexBuffer);
+	void SetIndexBuffer(Handle<IndexBuffer> indexBuffer);
 
-	inline const std::vector<Ref<VertexBuffer>>& GetVertexBuffers() const { return m_VertexBuffers; }
-	inline const Ref<IndexBuffer>& GetIndexBuffer() const { return m_IndexBuffer; }
-	inline static Ref<VertexArray> Create() { return CreateRef<VertexArray>(); }
+	inline const std::vector<Handle<VertexBuffer>>& GetVertexBuffers() const { return m_VertexBuffers; }
+	inline Handle<IndexBuffer> GetIndexBuffer() const { return m_IndexBuffer; }
+	inline static Handle<VertexArray> Create() { return CreateHandle<VertexArray>(); }
 private:
 	uint32_t m_RendererID;
 	uint32_t m_VertexBufferIndex = 0;
-	std::vector<Ref<VertexBuffer>> m_VertexBuffers;
-	Ref<IndexBuffer> m_IndexBuffer;
+	std::vector<Handle<VertexBuffer>> m_VertexBuffers;
+	Handle<IndexBuffer> m_IndexBuffer;
+};
+
+// Uniform block bindings every shader agrees on, see res/shaders/include/Uniforms.glsl
+enum class UniformBinding : uint32_t
+{
+	Camera = 0, // Renderer2D
+	Frame = 1,
+	Object = 2
+};
+
+// std140 layouts of the Frame and Object blocks
+struct FrameUniforms
+{
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::mat4 ViewProjection;
+	glm::vec4 CameraPosition;
+	glm::vec4 Time; // x seconds, y delta time
+};
+
+struct ObjectUniforms
+{
+	glm::mat4 Transform;
+	glm::mat4 NormalMatrix;
+	glm::ivec4 EntityID;
 };
 
 struct UniformBuffer 
@@ -164,7 +193,133 @@ struct UniformBuffer
 	virtual ~UniformBuffer();
 
 	void SetData(const void* data, uint32_t size, uint32_t offset = 0);
-	inline static Ref<UniformBuffer> Create(uint32_t size, uint32_t binding) { return CreateRef<UniformBuffer>(size, binding); }
+	inline static Handle<UniformBuffer> Create(uint32_t size, uint32_t binding) { return CreateHandle<UniformBuffer>(size, binding); }
+	inline static Handle<UniformBuffer> Create(uint32_t size, UniformBinding binding) { return CreateHandle<UniformBuffer>(size, (uint32_t)binding); }
 private:
 	uint32_t m_RendererID = 0;
+	uint32_t m_Size = 0;
+};
+
+struct UniformRingAllocation
+{
+	void* Data = nullptr;
+	uint32_t Offset = 0;
+	uint32_t Size = 0;
+
+	explicit operator bool() const { return Data != nullptr; }
+};
+
+// Persistently mapped uniform buffer cut into one segment per frame in flight. Per-draw data
+// is written straight into the current segment and bound by offset; a fence per segment
+// keeps the CPU from overwriting data the GPU has not consumed yet.
+struct UniformRingBuffer
+{
+	static constexpr uint32_t Segments = ResourcePools::FramesInFlight + 1;
+
+	UniformRingBuffer(uint32_t sizePerFrame);
+	virtual ~UniformRingBuffer();
+
+	void BeginFrame();
+	void EndFrame();
+
+	// Offsets honour GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, an empty allocation means the segment is full
+	UniformRingAllocation Allocate(uint32_t size);
+	template<typename T>
+	UniformRingAllocation Push(const T& data)
+	{
+		UniformRingAllocation allocation = Allocate(sizeof(T));
+		if (allocation)
+			std::memcpy(allocation.Data, &data, sizeof(T));
+		return allocation;
+	}
+	void Bind(UniformBinding binding, const UniformRingAllocation& allocation) const;
+
+	uint32_t GetBytesThisFrame() const { return m_Head; }
+	uint32_t GetSizePerFrame() const { return m_SizePerFrame; }
+	inline static Handle<UniformRingBuffer> Create(uint32_t sizePerFrame) { return CreateHandle<UniformRingBuffer>(sizePerFrame); }
+private:
+	uint32_t m_RendererID = 0;
+	uint32_t m_SizePerFrame = 0;
+	uint32_t m_Alignment = 256;
+	uint32_t m_Segment = 0;
+	uint32_t m_Head = 0;
+	uint8_t* m_Mapped = nullptr;
+	void* m_Fences[Segments] = {};
+	bool m_OverflowReported = false;
+};
+
+// Where a mesh lives inside a GeometryBuffer, indices are local to the mesh
+struct GeometryRange
+{
+	int32_t BaseVertex = 0;
+	uint32_t BaseIndex = 0;
+	uint32_t VertexCount = 0;
+	uint32_t IndexCount = 0;
+};
+
+// Static meshes sharing one vertex format packed into a single vertex and index buffer behind
+// one VAO, drawn with a base vertex/index instead of a VAO each. Ranges come from an
+// OffsetAllocator; when it can't fit a mesh the buffer is compacted if that frees enough
+// room, otherwise it grows. Both move meshes, so they are referred to by ID and the range
+// is looked up at draw time.
+struct GeometryBuffer
+{
+	static constexpr uint32_t InvalidMesh = 0xFFFFFFFF;
+
+	GeometryBuffer(const BufferLayout& layout, uint32_t vertexCapacity, uint32_t indexCapacity);
+	virtual ~GeometryBuffer();
+
+	uint32_t Upload(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+	void Free(uint32_t meshID);
+	const GeometryRange& GetRange(uint32_t meshID) const { return m_Meshes[meshID].Range; }
+	// Changes whenever Defragment() moves meshes, so cached ranges can be refreshed
+	uint32_t GetRangeVersion() const { return m_Defragments; }
+
+	void Bind() const;
+	// Binds nothing, call Bind() once before a run of draws
+	void Draw(uint32_t meshID) const;
+	// Packs every mesh to the front of fresh buffers of the same size
+	void Defragment();
+
+	struct Statistics
+	{
+		uint32_t Meshes = 0;
+		uint32_t VerticesUsed = 0;
+		uint32_t VertexCapacity = 0;
+		uint32_t IndicesUsed = 0;
+		uint32_t IndexCapacity = 0;
+		uint32_t LargestFreeVertices = 0;
+		uint32_t Grows = 0;
+		uint32_t Defragments = 0;
+	};
+
+	Statistics GetStats() const;
+	const BufferLayout& GetLayout() const { return m_Layout; }
+	uint32_t GetVertexArrayID() const { return m_VertexArrayID; }
+	uint32_t GetIndexBufferID() const { return m_IndexBufferID; }
+	inline static Handle<GeometryBuffer> Create(const BufferLayout& layout, uint32_t vertexCapacity, uint32_t indexCapacity) { return CreateHandle<GeometryBuffer>(layout, vertexCapacity, indexCapacity); }
+private:
+	bool TryAllocate(uint32_t vertexCount, uint32_t indexCount, OffsetAllocation& vertices, OffsetAllocation& indices);
+	void Reallocate(uint32_t vertexCapacity, uint32_t indexCapacity, bool compact);
+
+	struct MeshEntry
+	{
+		GeometryRange Range;
+		OffsetAllocation Vertices;
+		OffsetAllocation Indices;
+		bool Alive = false;
+	};
+
+	BufferLayout m_Layout;
+	uint32_t m_VertexArrayID = 0;
+	uint32_t m_VertexBufferID = 0;
+	uint32_t m_IndexBufferID = 0;
+	uint32_t m_VertexCapacity = 0;
+	uint32_t m_IndexCapacity = 0;
+	OffsetAllocator m_VertexAllocator;
+	OffsetAllocator m_IndexAllocator;
+	std::vector<MeshEntry> m_Meshes;
+	std::vector<uint32_t> m_FreeMeshIDs;
+	uint32_t m_Grows = 0;
+	uint32_t m_Defragments = 0;
 };
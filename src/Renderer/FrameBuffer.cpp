@@ -1,6 +1,8 @@
 #include "FrameBuffer.h"
+#include "RendererAPI.h"
 
 #include <glad/glad.h>
+#include "../Backend/MemoryTracker.h"
 
 static const uint32_t s_MaxFramebufferSize = 8192;
 
@@ -16,9 +18,18 @@ namespace Utils {
 		glCreateTextures(TextureTarget(multisampled), count, outID);
 	}
 
-	static void BindTexture(bool multisampled, uint32_t id)
+	// Unit 0 is the active unit, the non-DSA calls below act on its binding
+	static void BindTexture(uint32_t id)
 	{
-		glBindTexture(TextureTarget(multisampled), id);
+		RendererAPI::BindTextureUnit(0, id);
+	}
+
+	static void ForgetDeleted(uint32_t framebuffer, const std::vector<uint32_t>& colorAttachments, uint32_t depthAttachment)
+	{
+		RendererAPI::OnFramebufferDeleted(framebuffer);
+		for (uint32_t id : colorAttachments)
+			RendererAPI::OnTextureDeleted(id);
+		RendererAPI::OnTextureDeleted(depthAttachment);
 	}
 
 	static void AttachColorTexture(uint32_t id, int samples, GLenum internalFormat, GLenum format, uint32_t width, uint32_t height, int index)
@@ -73,6 +84,19 @@ namespace Utils {
 		return false;
 	}
 
+	static uint32_t FBTextureFormatBytesPerPixel(FramebufferTextureFormat format)
+	{
+		switch (format)
+		{
+			case FramebufferTextureFormat::RGBA8:           return 4;
+			case FramebufferTextureFormat::RED_INTEGER:     return 4;
+			case FramebufferTextureFormat::DEPTH24STENCIL8: return 4;
+			case FramebufferTextureFormat::None:            break;
+		}
+
+		return 0;
+	}
+
 	static GLenum HazelFBTextureFormatToGL(FramebufferTextureFormat format)
 	{
 		switch (format)
@@ -106,6 +130,8 @@ Framebuffer::~Framebuffer()
 	glDeleteFramebuffers(1, &m_RendererID);
 	glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
 	glDeleteTextures(1, &m_DepthAttachment);
+	Utils::ForgetDeleted(m_RendererID, m_ColorAttachments, m_DepthAttachment);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Framebuffer, m_GPUMemory);
 }
 
 void Framebuffer::Invalidate()
@@ -115,13 +141,17 @@ void Framebuffer::Invalidate()
 		glDeleteFramebuffers(1, &m_RendererID);
 		glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
 		glDeleteTextures(1, &m_DepthAttachment);
+		Utils::ForgetDeleted(m_RendererID, m_ColorAttachments, m_DepthAttachment);
 
 		m_ColorAttachments.clear();
 		m_DepthAttachment = 0;
+
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Framebuffer, m_GPUMemory);
+		m_GPUMemory = 0;
 	}
 
 	glCreateFramebuffers(1, &m_RendererID);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+	RendererAPI::BindFramebuffer(m_RendererID);
 
 	bool multisample = m_Specification.Samples > 1;
 
@@ -133,7 +163,7 @@ void Framebuffer::Invalidate()
 
 		for (size_t i = 0; i < m_ColorAttachments.size(); i++)
 		{
-			Utils::BindTexture(multisample, m_ColorAttachments[i]);
+			Utils::BindTexture(m_ColorAttachments[i]);
 			switch (m_ColorAttachmentSpecifications[i].TextureFormat)
 			{
 			case FramebufferTextureFormat::RGBA8:
@@ -149,7 +179,7 @@ void Framebuffer::Invalidate()
 	if (m_DepthAttachmentSpecification.TextureFormat != FramebufferTextureFormat::None)
 	{
 		Utils::CreateTextures(multisample, &m_DepthAttachment, 1);
-		Utils::BindTexture(multisample, m_DepthAttachment);
+		Utils::BindTexture(m_DepthAttachment);
 		switch (m_DepthAttachmentSpecification.TextureFormat)
 		{
 		case FramebufferTextureFormat::DEPTH24STENCIL8:
@@ -172,18 +202,22 @@ void Framebuffer::Invalidate()
 
 	GABGL_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Framebuffer is incomplete!");
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	for (auto& attachment : m_Specification.Attachments.Attachments)
+		m_GPUMemory += MemoryTracker::GetTextureBytes(m_Specification.Width, m_Specification.Height, Utils::FBTextureFormatBytesPerPixel(attachment.TextureFormat), 1, m_Specification.Samples);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Framebuffer, m_GPUMemory);
+
+	RendererAPI::BindFramebuffer(0);
 }
 
 void Framebuffer::Bind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
-	glViewport(0, 0, m_Specification.Width, m_Specification.Height);
+	RendererAPI::BindFramebuffer(m_RendererID);
+	RendererAPI::SetViewport(0, 0, m_Specification.Width, m_Specification.Height);
 }
 
 void Framebuffer::Unbind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RendererAPI::BindFramebuffer(0);
 }
 
 void Framebuffer::Resize(uint32_t width, uint32_t height)
@@ -219,7 +253,12 @@ void Framebuffer::ClearAttachment(uint32_t attachmentIndex, int value)
 		Utils::HazelFBTextureFormatToGL(spec.TextureFormat), GL_INT, &value);
 }
 
-Ref<Framebuffer> Framebuffer::Create(const FramebufferSpecification& spec)
+Handle<Framebuffer> Framebuffer::Create(const FramebufferSpecification& spec)
+{
+	return CreateHandle<Framebuffer>(spec);
+}
+
+void Framebuffer::Destroy(Handle<Framebuffer> framebuffer)
 {
-	return CreateRef<Framebuffer>(spec);
+	DestroyHandle(framebuffer);
 }
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "../Backend/BackendLogger.h"
-#include "../Backend/BackendScopeRef.h"
+#include "../Backend/ResourcePool.h"
 #include <initializer_list>
 #include <vector>
 #include <cstdint>
@@ -68,7 +68,8 @@ struct Framebuffer
 
 	inline const FramebufferSpecification& GetSpecification() const { return m_Specification; };
 
-	static Ref<Framebuffer> Create(const FramebufferSpecification& spec);
+	static Handle<Framebuffer> Create(const FramebufferSpecification& spec);
+	static void Destroy(Handle<Framebuffer> framebuffer);
 
 private:
 	uint32_t m_RendererID = 0;
@@ -79,4 +80,6 @@ private:
 
 	std::vector<uint32_t> m_ColorAttachments;
 	uint32_t m_DepthAttachment = 0;
+
+	int64_t m_GPUMemory = 0;
 };
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "GLIntercept.h"
+
+#include <glad/glad.h>
+#include "../Backend/BackendLogger.h"
+#include "../Backend/Profiler.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+// Entry points that only count calls
+#define GABGL_GL_COUNTED_FUNCTIONS(X) \
+	X(glDrawArrays) X(glDrawElements) X(glDrawElementsBaseVertex) X(glMultiDrawElementsIndirect) \
+	X(glMultiDrawElementsIndirectCount) X(glMultiDrawElementsIndirectCountARB) X(glDispatchCompute) \
+	X(glClear) X(glClearColor) X(glClearTexImage) X(glClearNamedBufferData) X(glViewport) X(glLineWidth) \
+	X(glUseProgram) X(glBindVertexArray) X(glBindBuffer) X(glBindBufferBase) X(glBindBufferRange) \
+	X(glBindTextureUnit) X(glBindSampler) X(glBindFramebuffer) X(glEnable) X(glDisable) X(glBlendFunc) \
+	X(glDepthFunc) X(glDepthMask) X(glCullFace) X(glDrawBuffer) X(glDrawBuffers) X(glReadBuffer) \
+	X(glUniform1i) X(glUniform1f) X(glUniform2f) X(glUniform2fv) X(glUniform3f) X(glUniform3fv) \
+	X(glUniform4f) X(glUniform4fv) X(glUniformMatrix2fv) X(glUniformMatrix3fv) X(glUniformMatrix4fv) \
+	X(glTexParameteri) X(glTextureParameteri) X(glCopyNamedBufferSubData) X(glMapNamedBufferRange) \
+	X(glUnmapNamedBuffer) X(glMemoryBarrier) X(glFenceSync) X(glClientWaitSync) X(glDeleteSync) \
+	X(glQueryCounter) X(glGetQueryObjectiv) X(glGetQueryObjectui64v) X(glGetIntegerv) X(glGetInteger64v) \
+	X(glReadPixels) X(glCreateBuffers) X(glDeleteBuffers) X(glCreateTextures) X(glDeleteTextures) \
+	X(glCreateVertexArrays) X(glDeleteVertexArrays) X(glCreateFramebuffers) X(glDeleteFramebuffers) \
+	X(glTextureStorage2D) X(glTexStorage2D) X(glTexImage2DMultisample) X(glShaderSource) X(glCompileShader) \
+	X(glLinkProgram) X(glProgramBinary) X(glShaderBinary) X(glSpecializeShaderARB)
+
+// Entry points that move data to the driver, counted with their size in bytes
+#define GABGL_GL_UPLOAD_FUNCTIONS(X) \
+	X(glBufferData) X(glBufferSubData) X(glNamedBufferData) X(glNamedBufferSubData) X(glNamedBufferStorage) \
+	X(glTexImage2D) X(glTexSubImage2D) X(glTexSubImage3D) X(glTextureSubImage2D) X(glTextureSubImage3D) \
+	X(glCompressedTexSubImage2D) X(glCompressedTextureSubImage2D)
+
+namespace Utils {
+
+	enum class GLFunction : uint32_t
+	{
+#define GABGL_GL_ENUM(name) name,
+		GABGL_GL_COUNTED_FUNCTIONS(GABGL_GL_ENUM)
+		GABGL_GL_UPLOAD_FUNCTIONS(GABGL_GL_ENUM)
+#undef GABGL_GL_ENUM
+		Count
+	};
+
+	static const char* s_GLFunctionNames[] = {
+#define GABGL_GL_NAME(name) #name,
+		GABGL_GL_COUNTED_FUNCTIONS(GABGL_GL_NAME)
+		GABGL_GL_UPLOAD_FUNCTIONS(GABGL_GL_NAME)
+#undef GABGL_GL_NAME
+	};
+	static_assert(std::size(s_GLFunctionNames) == (size_t)GLFunction::Count);
+
+	struct GLCounter
+	{
+		uint64_t Calls = 0;
+		uint64_t Bytes = 0;
+	};
+
+	static uint64_t PixelBytes(GLenum format, GLenum type)
+	{
+		switch (type)
+		{
+			// Packed types describe the whole pixel
+			case GL_UNSIGNED_INT_24_8:
+			case GL_UNSIGNED_INT_8_8_8_8:
+			case GL_UNSIGNED_INT_8_8_8_8_REV:
+			case GL_UNSIGNED_INT_2_10_10_10_REV:
+			case GL_UNSIGNED_INT_10F_11F_11F_REV:
+			case GL_UNSIGNED_INT_5_9_9_9_REV:
+				return 4;
+			case GL_UNSIGNED_SHORT_5_6_5:
+			case GL_UNSIGNED_SHORT_4_4_4_4:
+			case GL_UNSIGNED_SHORT_5_5_5_1:
+				return 2;
+		}
+
+		uint64_t componentBytes = 1;
+		switch (type)
+		{
+			case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: componentBytes = 2; break;
+			case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT:         componentBytes = 4; break;
+		}
+
+		switch (format)
+		{
+			case GL_RG: case GL_RG_INTEGER:                               return componentBytes * 2;
+			case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:                return componentBytes * 3;
+			case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER:             return componentBytes * 4;
+			default:                                                      return componentBytes;
+		}
+	}
+
+	static uint64_t ImageBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type)
+	{
+		return (uint64_t)width * height * depth * PixelBytes(format, type);
+	}
+
+	// Byte counts, one per upload entry point, with the exact signature of the function
+	static uint64_t glBufferDataBytes(GLenum, GLsizeiptr size, const void* data, GLenum) { return data ? (uint64_t)size : 0; }
+	static uint64_t glBufferSubDataBytes(GLenum, GLintptr, GLsizeiptr size, const void*) { return (uint64_t)size; }
+	static uint64_t glNamedBufferDataBytes(GLuint, GLsizeiptr size, const void* data, GLenum) { return data ? (uint64_t)size : 0; }
+	static uint64_t glNamedBufferSubDataBytes(GLuint, GLintptr, GLsizeiptr size, const void*) { return (uint64_t)size; }
+	static uint64_t glNamedBufferStorageBytes(GLuint, GLsizeiptr size, const void* data, GLbitfield) { return data ? (uint64_t)size : 0; }
+	static uint64_t glTexImage2DBytes(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* pixels)
+	{
+		return pixels ? ImageBytes(width, height, 1, format, type) : 0;
+	}
+	static uint64_t glTexSubImage2DBytes(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void*)
+	{
+		return ImageBytes(width, height, 1, format, type);
+	}
+	static uint64_t glTexSubImage3DBytes(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void*)
+	{
+		return ImageBytes(width, height, depth, format, type);
+	}
+	static uint64_t glTextureSubImage2DBytes(GLuint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void*)
+	{
+		return ImageBytes(width, height, 1, format, type);
+	}
+	static uint64_t glTextureSubImage3DBytes(GLuint, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void*)
+	{
+		return ImageBytes(width, height, depth, format, type);
+	}
+	static uint64_t glCompressedTexSubImage2DBytes(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei imageSize, const void*) { return (uint64_t)imageSize; }
+	static uint64_t glCompressedTextureSubImage2DBytes(GLuint, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei imageSize, const void*) { return (uint64_t)imageSize; }
+
+	static void Record(GLFunction function, uint64_t bytes);
+
+	// One instantiation per entry point: the wrapper has the entry point's own signature and
+	// forwards to the pointer glad loaded
+	template<GLFunction Function, typename Pointer, auto Bytes>
+	struct GLHook;
+
+	template<GLFunction Function, auto Bytes, typename R, typename... Args>
+	struct GLHook<Function, R (APIENTRYP)(Args...), Bytes>
+	{
+		inline static R (APIENTRYP Original)(Args...) = nullptr;
+
+		static R APIENTRY Call(Args... args)
+		{
+			if constexpr (std::is_same_v<decltype(Bytes), std::nullptr_t>)
+				Record(Function, 0);
+			else
+				Record(Function, Bytes(args...));
+			return Original(args...);
+		}
+	};
+
+	template<GLFunction Function, auto Bytes = nullptr, typename Pointer>
+	static void Hook(Pointer& pointer)
+	{
+		using HookType = GLHook<Function, Pointer, Bytes>;
+		// Missing on this driver, or still hooked from an Install() without a reload in between
+		if (!pointer || pointer == &HookType::Call)
+			return;
+		HookType::Original = pointer;
+		pointer = &HookType::Call;
+	}
+
+	template<GLFunction Function, auto Bytes = nullptr, typename Pointer>
+	static void Unhook(Pointer& pointer)
+	{
+		using HookType = GLHook<Function, Pointer, Bytes>;
+		if (pointer == &HookType::Call)
+			pointer = HookType::Original;
+	}
+}
+
+static const char* s_NoZone = "(no zone)";
+
+static struct GLInterceptData
+{
+	bool Enabled = false;
+	bool Installed = false;
+
+	Utils::GLCounter Functions[(size_t)Utils::GLFunction::Count];
+	std::unordered_map<const char*, Utils::GLCounter> Zones;
+	// Consecutive calls almost always come from the same zone
+	const char* LastZone = nullptr;
+	Utils::GLCounter* LastZoneCounter = nullptr;
+
+	GLFrameStats LastFrame;
+} s_Data;
+
+void Utils::Record(GLFunction function, uint64_t bytes)
+{
+	GLCounter& counter = s_Data.Functions[(size_t)function];
+	counter.Calls++;
+	counter.Bytes += bytes;
+
+	const char* zone = Profiler::GetCurrentZone();
+	if (!zone)
+		zone = s_NoZone;
+	if (zone != s_Data.LastZone || !s_Data.LastZoneCounter)
+	{
+		s_Data.LastZone = zone;
+		s_Data.LastZoneCounter = &s_Data.Zones[zone];
+	}
+	s_Data.LastZoneCounter->Calls++;
+	s_Data.LastZoneCounter->Bytes += bytes;
+}
+
+void GLIntercept::SetEnabled(bool enabled)
+{
+	s_Data.Enabled = enabled;
+	if (!enabled)
+		Uninstall();
+}
+
+bool GLIntercept::IsEnabled()
+{
+	return s_Data.Enabled;
+}
+
+void GLIntercept::Install()
+{
+	if (!s_Data.Enabled)
+		return;
+
+#define GABGL_GL_HOOK(name) Utils::Hook<Utils::GLFunction::name>(glad_##name);
+#define GABGL_GL_HOOK_UPLOAD(name) Utils::Hook<Utils::GLFunction::name, &Utils::name##Bytes>(glad_##name);
+	GABGL_GL_COUNTED_FUNCTIONS(GABGL_GL_HOOK)
+	GABGL_GL_UPLOAD_FUNCTIONS(GABGL_GL_HOOK_UPLOAD)
+#undef GABGL_GL_HOOK
+#undef GABGL_GL_HOOK_UPLOAD
+
+	if (!s_Data.Installed)
+	{
+		GABGL_INFO("GL call interception enabled");
+	}
+	s_Data.Installed = true;
+}
+
+void GLIntercept::Uninstall()
+{
+	if (!s_Data.Installed)
+		return;
+
+#define GABGL_GL_UNHOOK(name) Utils::Unhook<Utils::GLFunction::name>(glad_##name);
+#define GABGL_GL_UNHOOK_UPLOAD(name) Utils::Unhook<Utils::GLFunction::name, &Utils::name##Bytes>(glad_##name);
+	GABGL_GL_COUNTED_FUNCTIONS(GABGL_GL_UNHOOK)
+	GABGL_GL_UPLOAD_FUNCTIONS(GABGL_GL_UNHOOK_UPLOAD)
+#undef GABGL_GL_UNHOOK
+#undef GABGL_GL_UNHOOK_UPLOAD
+
+	s_Data.Installed = false;
+}
+
+bool GLIntercept::IsInstalled()
+{
+	return s_Data.Installed;
+}
+
+void GLIntercept::EndFrame()
+{
+	if (!s_Data.Installed)
+		return;
+
+	GLFrameStats& frame = s_Data.LastFrame;
+	frame.Calls = 0;
+	frame.Bytes = 0;
+	frame.Functions.clear();
+	frame.Zones.clear();
+
+	for (size_t i = 0; i < (size_t)Utils::GLFunction::Count; i++)
+	{
+		Utils::GLCounter& counter = s_Data.Functions[i];
+		if (counter.Calls == 0)
+			continue;
+
+		frame.Functions.push_back({ Utils::s_GLFunctionNames[i], counter.Calls, counter.Bytes });
+		frame.Calls += counter.Calls;
+		frame.Bytes += counter.Bytes;
+		counter = {};
+	}
+
+	for (auto& [zone, counter] : s_Data.Zones)
+	{
+		if (counter.Calls == 0)
+			continue;
+		frame.Zones.push_back({ zone, counter.Calls, counter.Bytes });
+		counter = {};
+	}
+
+	std::sort(frame.Functions.begin(), frame.Functions.end(), [](const GLFunctionStats& a, const GLFunctionStats& b) { return a.Calls > b.Calls; });
+	std::sort(frame.Zones.begin(), frame.Zones.end(), [](const GLZoneStats& a, const GLZoneStats& b) { return a.Calls > b.Calls; });
+}
+
+const GLFrameStats& GLIntercept::GetLastFrame()
+{
+	return s_Data.LastFrame;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct GLFunctionStats
+{
+	const char* Name;
+	uint64_t Calls;
+	uint64_t Bytes;
+};
+
+struct GLZoneStats
+{
+	const char* Zone; // profiler zone name, "(no zone)" for calls outside any zone
+	uint64_t Calls;
+	uint64_t Bytes;
+};
+
+struct GLFrameStats
+{
+	uint64_t Calls = 0;
+	uint64_t Bytes = 0;
+	// Only entry points and zones that were hit, most calls first
+	std::vector<GLFunctionStats> Functions;
+	std::vector<GLZoneStats> Zones;
+};
+
+// Optional layer between the engine and the driver: Install() swaps the glad function pointers
+// of the entry points the engine uses for wrappers that count calls and uploaded bytes
+// (glBufferSubData, glTexSubImage* and friends) before forwarding them. Every call is charged
+// to the innermost profiler zone. Main thread only, ImGui's backend loads its own pointers and
+// is not counted.
+struct GLIntercept
+{
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled();
+
+	// Call after every gladLoadGL, a reload replaces the wrappers with the driver's pointers
+	static void Install();
+	static void Uninstall();
+	static bool IsInstalled();
+
+	// Closes the frame, GetLastFrame() reports it until the next EndFrame()
+	static void EndFrame();
+	static const GLFrameStats& GetLastFrame();
+};
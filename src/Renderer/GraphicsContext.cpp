@@ -1,4 +1,5 @@
 #include "GraphicsContext.h"
+#include "GLIntercept.h"
 #include "../Backend/BackendLogger.h"
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
@@ -14,6 +15,7 @@ void GraphicsContext::Init()
 	glfwMakeContextCurrent(m_WindowHandle);
 	int status = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 	GABGL_ASSERT(status, "Failed to initialize Glad!");
+	GLIntercept::Install();
 
 	GABGL_INFO("OpenGL Info:");
 	GABGL_INFO("  Vendor: {}", reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
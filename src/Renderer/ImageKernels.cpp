@@ -0,0 +1,661 @@
+#include "ImageKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define GABGL_IMAGE_KERNELS_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define GABGL_IMAGE_KERNELS_X86 0
+#endif
+
+// MSVC emits any instruction set from intrinsics, GCC and Clang need the target on every function using them
+#if GABGL_IMAGE_KERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+	#define GABGL_TARGET_SSE41 __attribute__((target("sse4.1")))
+	#define GABGL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define GABGL_TARGET_SSE41
+	#define GABGL_TARGET_AVX2
+#endif
+
+namespace Utils {
+
+	static SimdLevel DetectSimdLevel()
+	{
+#if GABGL_IMAGE_KERNELS_X86 && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool sse41 = (info[2] & (1 << 19)) != 0;
+		// AVX state has to be enabled by the OS as well
+		bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		bool avx2 = false;
+		if (avx && maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+		return avx2 && sse41 ? SimdLevel::AVX2 : sse41 ? SimdLevel::SSE41 : SimdLevel::Scalar;
+#elif GABGL_IMAGE_KERNELS_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.1"))
+			return SimdLevel::AVX2;
+		return __builtin_cpu_supports("sse4.1") ? SimdLevel::SSE41 : SimdLevel::Scalar;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	static constexpr uint32_t SRGBEncodeSteps = 4096;
+
+	// Decoding is exact per code. Encoding looks up by the square root of the linear value,
+	// which spaces the steps closely enough near black to stay within 0.55 of a code
+	struct SRGBTables
+	{
+		float Decode[256];
+		// 32-bit so AVX2 can gather it
+		uint32_t Encode[SRGBEncodeSteps];
+
+		SRGBTables()
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				double value = i / 255.0;
+				Decode[i] = (float)(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+			}
+			for (uint32_t i = 0; i < SRGBEncodeSteps; i++)
+			{
+				double root = (double)i / (SRGBEncodeSteps - 1);
+				double value = root * root;
+				double encoded = value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+				Encode[i] = (uint32_t)std::lround(encoded * 255.0);
+			}
+		}
+	};
+
+	static const SRGBTables& GetSRGBTables()
+	{
+		static const SRGBTables tables;
+		return tables;
+	}
+
+	// Scalar kernels, also the tails of the SIMD ones. first is where the SIMD loop stopped
+
+	static void DownsampleRow(const uint8_t* row0, const uint8_t* row1, uint32_t width, uint32_t channels, uint32_t firstX, uint8_t* destination)
+	{
+		uint32_t halfWidth = std::max(width / 2, 1u);
+		for (uint32_t x = firstX; x < halfWidth; x++)
+		{
+			uint32_t x0 = std::min(x * 2, width - 1) * channels;
+			uint32_t x1 = std::min(x * 2 + 1, width - 1) * channels;
+			uint8_t* output = destination + x * channels;
+			for (uint32_t c = 0; c < channels; c++)
+				output[c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+		}
+	}
+
+	static void SRGBToLinear(const uint8_t* source, float* destination, size_t first, size_t count)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+		for (size_t i = first; i < count; i++)
+			destination[i] = tables.Decode[source[i]];
+	}
+
+	static void LinearToSRGB(const float* source, uint8_t* destination, size_t first, size_t count)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+		for (size_t i = first; i < count; i++)
+		{
+			// Written so NaN lands on 0, like the SIMD max
+			float value = source[i] > 0.0f ? std::min(source[i], 1.0f) : 0.0f;
+			destination[i] = (uint8_t)tables.Encode[(uint32_t)(std::sqrt(value) * (float)(SRGBEncodeSteps - 1) + 0.5f)];
+		}
+	}
+
+	static void PremultiplyAlpha(uint8_t* rgba, size_t first, size_t pixelCount)
+	{
+		for (size_t i = first; i < pixelCount; i++)
+		{
+			uint8_t* pixel = rgba + i * 4;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				// Exact rounding of c * a / 255 without a division
+				uint32_t product = pixel[c] * pixel[3] + 128;
+				pixel[c] = (uint8_t)((product + (product >> 8)) >> 8);
+			}
+		}
+	}
+
+	static void UnpremultiplyAlpha(uint8_t* rgba, size_t first, size_t pixelCount)
+	{
+		for (size_t i = first; i < pixelCount; i++)
+		{
+			uint8_t* pixel = rgba + i * 4;
+			float alpha = pixel[3];
+			for (uint32_t c = 0; c < 3; c++)
+				pixel[c] = alpha > 0.0f ? (uint8_t)std::min(pixel[c] * 255.0f / alpha + 0.5f, 255.0f) : 0;
+		}
+	}
+
+	static void ExpandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t first, size_t pixelCount)
+	{
+		for (size_t i = first; i < pixelCount; i++)
+		{
+			rgba[i * 4 + 0] = rgb[i * 3 + 0];
+			rgba[i * 4 + 1] = rgb[i * 3 + 1];
+			rgba[i * 4 + 2] = rgb[i * 3 + 2];
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+	static constexpr float NormalEpsilon = 1e-8f;
+
+	static void RenormalizeNormals(uint8_t* pixels, size_t first, size_t pixelCount, uint32_t channels)
+	{
+		for (size_t i = first; i < pixelCount; i++)
+		{
+			uint8_t* pixel = pixels + i * channels;
+			float normal[3];
+			for (uint32_t c = 0; c < 3; c++)
+				normal[c] = pixel[c] * (2.0f / 255.0f) - 1.0f;
+
+			float lengthSquared = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+			if (lengthSquared < NormalEpsilon)
+				continue;
+
+			float length = std::sqrt(lengthSquared);
+			for (uint32_t c = 0; c < 3; c++)
+				pixel[c] = (uint8_t)std::clamp((normal[c] / length + 1.0f) * 127.5f + 0.5f, 0.0f, 255.0f);
+		}
+	}
+
+#if GABGL_IMAGE_KERNELS_X86
+
+	// pshufb masks putting, for every output byte, one channel of the first and of the second
+	// pixel of a pair into a 16-bit lane. 16 source bytes hold two pairs of 3 channels, and 8, 4
+	// or 2 pairs of the other sizes
+	struct PairMasks
+	{
+		alignas(16) uint8_t First[16];
+		alignas(16) uint8_t Second[16];
+		uint32_t OutputBytes;
+	};
+
+	static PairMasks GetPairMasks(uint32_t channels)
+	{
+		PairMasks masks;
+		masks.OutputBytes = channels == 3 ? 6 : 8;
+		for (uint32_t lane = 0; lane < 8; lane++)
+		{
+			uint32_t pixel = lane / channels, channel = lane % channels;
+			bool used = lane < masks.OutputBytes;
+			masks.First[lane * 2] = used ? (uint8_t)(pixel * 2 * channels + channel) : 0x80;
+			masks.Second[lane * 2] = used ? (uint8_t)((pixel * 2 + 1) * channels + channel) : 0x80;
+			masks.First[lane * 2 + 1] = masks.Second[lane * 2 + 1] = 0x80;
+		}
+		return masks;
+	}
+
+	// ---- SSE4.1
+
+	GABGL_TARGET_SSE41 static inline __m128i AveragePairsSSE41(__m128i top, __m128i bottom, __m128i first, __m128i second)
+	{
+		__m128i sum = _mm_add_epi16(_mm_shuffle_epi8(top, first), _mm_shuffle_epi8(top, second));
+		sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_shuffle_epi8(bottom, first), _mm_shuffle_epi8(bottom, second)));
+		return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+	}
+
+	// Whole pairs only, returns the first output pixel left to the scalar row
+	GABGL_TARGET_SSE41 static uint32_t DownsampleRowSSE41(const uint8_t* row0, const uint8_t* row1, uint32_t width, uint32_t channels, uint8_t* destination)
+	{
+		PairMasks masks = GetPairMasks(channels);
+		const __m128i first = _mm_load_si128((const __m128i*)masks.First);
+		const __m128i second = _mm_load_si128((const __m128i*)masks.Second);
+		const __m128i compact = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -128, -128, -128, -128);
+
+		uint32_t half = masks.OutputBytes;
+		uint32_t step = half * 2;
+		uint32_t rowBytes = width * channels;
+		uint32_t pairBytes = (width / 2) * channels;
+		uint32_t output = 0;
+		for (; output + step <= pairBytes && output * 2 + step + 16 <= rowBytes; output += step)
+		{
+			const uint8_t* top = row0 + output * 2;
+			const uint8_t* bottom = row1 + output * 2;
+			__m128i low = AveragePairsSSE41(_mm_loadu_si128((const __m128i*)top), _mm_loadu_si128((const __m128i*)bottom), first, second);
+			__m128i high = AveragePairsSSE41(_mm_loadu_si128((const __m128i*)(top + step)), _mm_loadu_si128((const __m128i*)(bottom + step)), first, second);
+			__m128i packed = _mm_packus_epi16(low, high);
+			if (channels == 3)
+			{
+				alignas(16) uint8_t bytes[16];
+				_mm_store_si128((__m128i*)bytes, _mm_shuffle_epi8(packed, compact));
+				std::memcpy(destination + output, bytes, 12);
+			}
+			else
+				_mm_storeu_si128((__m128i*)(destination + output), packed);
+		}
+		return output / channels;
+	}
+
+	GABGL_TARGET_SSE41 static size_t ExpandRGBToRGBASSE41(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+	{
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+		// Each load reads 16 bytes for the 12 it uses
+		size_t i = 0;
+		for (; i + 6 <= pixelCount; i += 4)
+		{
+			__m128i pixels = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(rgb + i * 3)), shuffle);
+			_mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_or_si128(pixels, alpha));
+		}
+		return i;
+	}
+
+	// Two pixels widened to 16 bits
+	GABGL_TARGET_SSE41 static inline __m128i PremultiplyPairSSE41(__m128i pixels)
+	{
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_blend_epi16(alpha, _mm_set1_epi16(255), 0x88);
+		__m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+	}
+
+	GABGL_TARGET_SSE41 static size_t PremultiplyAlphaSSE41(uint8_t* rgba, size_t pixelCount)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+			__m128i low = PremultiplyPairSSE41(_mm_unpacklo_epi8(pixels, zero));
+			__m128i high = PremultiplyPairSSE41(_mm_unpackhi_epi8(pixels, zero));
+			_mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_packus_epi16(low, high));
+		}
+		return i;
+	}
+
+	// One pixel widened to 32 bits
+	GABGL_TARGET_SSE41 static inline __m128i UnpremultiplyPixelSSE41(__m128i pixel)
+	{
+		__m128 values = _mm_cvtepi32_ps(pixel);
+		__m128 alpha = _mm_shuffle_ps(values, values, _MM_SHUFFLE(3, 3, 3, 3));
+		__m128 color = _mm_div_ps(_mm_mul_ps(values, _mm_set1_ps(255.0f)), alpha);
+		color = _mm_min_ps(_mm_add_ps(color, _mm_set1_ps(0.5f)), _mm_set1_ps(255.0f));
+		__m128i result = _mm_and_si128(_mm_cvttps_epi32(color), _mm_castps_si128(_mm_cmpneq_ps(alpha, _mm_setzero_ps())));
+		return _mm_blend_epi16(result, pixel, 0xC0);
+	}
+
+	GABGL_TARGET_SSE41 static size_t UnpremultiplyAlphaSSE41(uint8_t* rgba, size_t pixelCount)
+	{
+		size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+			__m128i p0 = UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(pixels));
+			__m128i p1 = UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(pixels, 4)));
+			__m128i p2 = UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(pixels, 8)));
+			__m128i p3 = UnpremultiplyPixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(pixels, 12)));
+			_mm_storeu_si128((__m128i*)(rgba + i * 4), _mm_packus_epi16(_mm_packus_epi32(p0, p1), _mm_packus_epi32(p2, p3)));
+		}
+		return i;
+	}
+
+	// One pixel widened to 32 bits, w is kept
+	GABGL_TARGET_SSE41 static inline __m128i RenormalizePixelSSE41(__m128i pixel)
+	{
+		__m128 normal = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(pixel), _mm_set1_ps(2.0f / 255.0f)), _mm_set1_ps(1.0f));
+		__m128 lengthSquared = _mm_dp_ps(normal, normal, 0x7F);
+		__m128 encoded = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_div_ps(normal, _mm_sqrt_ps(lengthSquared)), _mm_set1_ps(1.0f)), _mm_set1_ps(127.5f)), _mm_set1_ps(0.5f));
+		encoded = _mm_min_ps(_mm_max_ps(encoded, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+		__m128i keep = _mm_castps_si128(_mm_cmplt_ps(lengthSquared, _mm_set1_ps(NormalEpsilon)));
+		__m128i result = _mm_blendv_epi8(_mm_cvttps_epi32(encoded), pixel, keep);
+		return _mm_blend_epi16(result, pixel, 0xC0);
+	}
+
+	GABGL_TARGET_SSE41 static size_t RenormalizeNormalsSSE41(uint8_t* pixels, size_t pixelCount, uint32_t channels)
+	{
+		// Three channels are spread to four for the math and packed back
+		const __m128i expand = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+		const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+
+		size_t i = 0;
+		for (; i + (channels == 3 ? 6 : 4) <= pixelCount; i += 4)
+		{
+			uint8_t* block = pixels + i * channels;
+			__m128i rgba = _mm_loadu_si128((const __m128i*)block);
+			if (channels == 3)
+				rgba = _mm_shuffle_epi8(rgba, expand);
+
+			__m128i p0 = RenormalizePixelSSE41(_mm_cvtepu8_epi32(rgba));
+			__m128i p1 = RenormalizePixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(rgba, 4)));
+			__m128i p2 = RenormalizePixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(rgba, 8)));
+			__m128i p3 = RenormalizePixelSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(rgba, 12)));
+			__m128i packed = _mm_packus_epi16(_mm_packus_epi32(p0, p1), _mm_packus_epi32(p2, p3));
+			if (channels == 3)
+			{
+				alignas(16) uint8_t bytes[16];
+				_mm_store_si128((__m128i*)bytes, _mm_shuffle_epi8(packed, compact));
+				std::memcpy(block, bytes, 12);
+			}
+			else
+				_mm_storeu_si128((__m128i*)block, packed);
+		}
+		return i;
+	}
+
+	// ---- AVX2, 128-bit lanes hold what one SSE4.1 iteration does
+
+	GABGL_TARGET_AVX2 static inline __m256i LoadLanesAVX2(const uint8_t* low, const uint8_t* high)
+	{
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)low)), _mm_loadu_si128((const __m128i*)high), 1);
+	}
+
+	GABGL_TARGET_AVX2 static inline __m256i AveragePairsAVX2(__m256i top, __m256i bottom, __m256i first, __m256i second)
+	{
+		__m256i sum = _mm256_add_epi16(_mm256_shuffle_epi8(top, first), _mm256_shuffle_epi8(top, second));
+		sum = _mm256_add_epi16(sum, _mm256_add_epi16(_mm256_shuffle_epi8(bottom, first), _mm256_shuffle_epi8(bottom, second)));
+		return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+	}
+
+	GABGL_TARGET_AVX2 static uint32_t DownsampleRowAVX2(const uint8_t* row0, const uint8_t* row1, uint32_t width, uint32_t channels, uint8_t* destination)
+	{
+		PairMasks masks = GetPairMasks(channels);
+		const __m256i first = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)masks.First));
+		const __m256i second = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)masks.Second));
+		const __m256i compact = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -128, -128, -128, -128,
+			0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -128, -128, -128, -128);
+		const __m256i joinLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+		uint32_t half = masks.OutputBytes;
+		uint32_t step = half * 2;
+		uint32_t rowBytes = width * channels;
+		uint32_t pairBytes = (width / 2) * channels;
+		uint32_t output = 0;
+		// Lane 0 takes the first and second load, lane 1 the third and fourth
+		for (; output + step * 2 <= pairBytes && output * 2 + step * 3 + 16 <= rowBytes; output += step * 2)
+		{
+			const uint8_t* top = row0 + output * 2;
+			const uint8_t* bottom = row1 + output * 2;
+			__m256i low = AveragePairsAVX2(LoadLanesAVX2(top, top + step * 2), LoadLanesAVX2(bottom, bottom + step * 2), first, second);
+			__m256i high = AveragePairsAVX2(LoadLanesAVX2(top + step, top + step * 3), LoadLanesAVX2(bottom + step, bottom + step * 3), first, second);
+			__m256i packed = _mm256_packus_epi16(low, high);
+			if (channels == 3)
+			{
+				alignas(32) uint8_t bytes[32];
+				_mm256_store_si256((__m256i*)bytes, _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, compact), joinLanes));
+				std::memcpy(destination + output, bytes, 24);
+			}
+			else
+				_mm256_storeu_si256((__m256i*)(destination + output), packed);
+		}
+		return output / channels;
+	}
+
+	GABGL_TARGET_AVX2 static size_t ExpandRGBToRGBAAVX2(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+	{
+		const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128,
+			0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+		const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+		size_t i = 0;
+		for (; i + 10 <= pixelCount; i += 8)
+		{
+			const uint8_t* source = rgb + i * 3;
+			__m256i pixels = _mm256_shuffle_epi8(LoadLanesAVX2(source, source + 12), shuffle);
+			_mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_or_si256(pixels, alpha));
+		}
+		return i;
+	}
+
+	GABGL_TARGET_AVX2 static inline __m256i PremultiplyPairsAVX2(__m256i pixels)
+	{
+		__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm256_blend_epi16(alpha, _mm256_set1_epi16(255), 0x88);
+		__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+	}
+
+	GABGL_TARGET_AVX2 static size_t PremultiplyAlphaAVX2(uint8_t* rgba, size_t pixelCount)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m256i pixels = _mm256_loadu_si256((const __m256i*)(rgba + i * 4));
+			__m256i low = PremultiplyPairsAVX2(_mm256_unpacklo_epi8(pixels, zero));
+			__m256i high = PremultiplyPairsAVX2(_mm256_unpackhi_epi8(pixels, zero));
+			_mm256_storeu_si256((__m256i*)(rgba + i * 4), _mm256_packus_epi16(low, high));
+		}
+		return i;
+	}
+
+	// Two pixels widened to 32 bits, one per lane
+	GABGL_TARGET_AVX2 static inline __m256i UnpremultiplyPixelsAVX2(__m256i pixels)
+	{
+		__m256 values = _mm256_cvtepi32_ps(pixels);
+		__m256 alpha = _mm256_shuffle_ps(values, values, _MM_SHUFFLE(3, 3, 3, 3));
+		__m256 color = _mm256_div_ps(_mm256_mul_ps(values, _mm256_set1_ps(255.0f)), alpha);
+		color = _mm256_min_ps(_mm256_add_ps(color, _mm256_set1_ps(0.5f)), _mm256_set1_ps(255.0f));
+		__m256i result = _mm256_and_si256(_mm256_cvttps_epi32(color), _mm256_castps_si256(_mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_NEQ_UQ)));
+		return _mm256_blend_epi16(result, pixels, 0xC0);
+	}
+
+	GABGL_TARGET_AVX2 static size_t UnpremultiplyAlphaAVX2(uint8_t* rgba, size_t pixelCount)
+	{
+		// packus works per lane, so lane 0 ends up with the even pixels and lane 1 the odd ones
+		const __m256i interleave = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			uint8_t* block = rgba + i * 4;
+			__m256i p01 = UnpremultiplyPixelsAVX2(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)block)));
+			__m256i p23 = UnpremultiplyPixelsAVX2(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(block + 8))));
+			__m256i p45 = UnpremultiplyPixelsAVX2(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(block + 16))));
+			__m256i p67 = UnpremultiplyPixelsAVX2(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(block + 24))));
+			__m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(p01, p23), _mm256_packus_epi32(p45, p67));
+			_mm256_storeu_si256((__m256i*)block, _mm256_permutevar8x32_epi32(packed, interleave));
+		}
+		return i;
+	}
+
+	GABGL_TARGET_AVX2 static size_t SRGBToLinearAVX2(const uint8_t* source, float* destination, size_t count)
+	{
+		const float* decode = GetSRGBTables().Decode;
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i codes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(source + i)));
+			_mm256_storeu_ps(destination + i, _mm256_i32gather_ps(decode, codes, 4));
+		}
+		return i;
+	}
+
+	GABGL_TARGET_AVX2 static size_t LinearToSRGBAVX2(const float* source, uint8_t* destination, size_t count)
+	{
+		const int* encode = (const int*)GetSRGBTables().Encode;
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			// max first, so NaN becomes 0
+			__m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+			__m256 step = _mm256_add_ps(_mm256_mul_ps(_mm256_sqrt_ps(value), _mm256_set1_ps((float)(SRGBEncodeSteps - 1))), _mm256_set1_ps(0.5f));
+			__m256i codes = _mm256_i32gather_epi32(encode, _mm256_cvttps_epi32(step), 4);
+			__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(codes), _mm256_extracti128_si256(codes, 1));
+			_mm_storel_epi64((__m128i*)(destination + i), _mm_packus_epi16(words, words));
+		}
+		return i;
+	}
+
+#endif
+}
+
+struct ImageKernelsData
+{
+	SimdLevel Supported = Utils::DetectSimdLevel();
+	std::atomic<SimdLevel> Level{ Supported };
+};
+
+static ImageKernelsData s_Kernels;
+
+SimdLevel ImageKernels::GetSupportedLevel()
+{
+	return s_Kernels.Supported;
+}
+
+SimdLevel ImageKernels::GetLevel()
+{
+	return s_Kernels.Level.load(std::memory_order_relaxed);
+}
+
+void ImageKernels::SetLevel(SimdLevel level)
+{
+	s_Kernels.Level.store(std::min(level, s_Kernels.Supported), std::memory_order_relaxed);
+}
+
+const char* ImageKernels::GetLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+		case SimdLevel::SSE41: return "SSE4.1";
+		case SimdLevel::AVX2:  return "AVX2";
+		default:               return "Scalar";
+	}
+}
+
+void ImageKernels::Downsample(const uint8_t* source, uint32_t width, uint32_t height, uint32_t channels, uint8_t* destination)
+{
+	uint32_t halfWidth = std::max(width / 2, 1u);
+	uint32_t halfHeight = std::max(height / 2, 1u);
+	SimdLevel level = GetLevel();
+	for (uint32_t y = 0; y < halfHeight; y++)
+	{
+		const uint8_t* row0 = source + (size_t)std::min(y * 2, height - 1) * width * channels;
+		const uint8_t* row1 = source + (size_t)std::min(y * 2 + 1, height - 1) * width * channels;
+		uint8_t* output = destination + (size_t)y * halfWidth * channels;
+
+		uint32_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+		if (level == SimdLevel::AVX2)
+			done = Utils::DownsampleRowAVX2(row0, row1, width, channels, output);
+		else if (level == SimdLevel::SSE41)
+			done = Utils::DownsampleRowSSE41(row0, row1, width, channels, output);
+#endif
+		Utils::DownsampleRow(row0, row1, width, channels, done, output);
+	}
+}
+
+void ImageKernels::DownsampleSRGB(const uint8_t* source, uint32_t width, uint32_t height, uint32_t channels, uint8_t* destination)
+{
+	uint32_t halfWidth = std::max(width / 2, 1u);
+	uint32_t halfHeight = std::max(height / 2, 1u);
+	size_t rowValues = (size_t)width * channels;
+	std::vector<float> top(rowValues), bottom(rowValues), averaged((size_t)halfWidth * channels);
+	for (uint32_t y = 0; y < halfHeight; y++)
+	{
+		const uint8_t* row0 = source + (size_t)std::min(y * 2, height - 1) * rowValues;
+		const uint8_t* row1 = source + (size_t)std::min(y * 2 + 1, height - 1) * rowValues;
+		SRGBToLinear(row0, top.data(), rowValues);
+		SRGBToLinear(row1, bottom.data(), rowValues);
+
+		for (uint32_t x = 0; x < halfWidth; x++)
+		{
+			uint32_t x0 = std::min(x * 2, width - 1) * channels;
+			uint32_t x1 = std::min(x * 2 + 1, width - 1) * channels;
+			for (uint32_t c = 0; c < channels; c++)
+				averaged[x * channels + c] = (top[x0 + c] + top[x1 + c] + bottom[x0 + c] + bottom[x1 + c]) * 0.25f;
+		}
+
+		uint8_t* output = destination + (size_t)y * halfWidth * channels;
+		LinearToSRGB(averaged.data(), output, averaged.size());
+		if (channels == 4)
+		{
+			for (uint32_t x = 0; x < halfWidth; x++)
+			{
+				uint32_t x0 = std::min(x * 2, width - 1) * 4 + 3;
+				uint32_t x1 = std::min(x * 2 + 1, width - 1) * 4 + 3;
+				output[x * 4 + 3] = (uint8_t)((row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) / 4);
+			}
+		}
+	}
+}
+
+void ImageKernels::SRGBToLinear(const uint8_t* source, float* destination, size_t count)
+{
+	size_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+	// Table lookups, only gathers make them worth vectorizing
+	if (GetLevel() == SimdLevel::AVX2)
+		done = Utils::SRGBToLinearAVX2(source, destination, count);
+#endif
+	Utils::SRGBToLinear(source, destination, done, count);
+}
+
+void ImageKernels::LinearToSRGB(const float* source, uint8_t* destination, size_t count)
+{
+	size_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+	if (GetLevel() == SimdLevel::AVX2)
+		done = Utils::LinearToSRGBAVX2(source, destination, count);
+#endif
+	Utils::LinearToSRGB(source, destination, done, count);
+}
+
+void ImageKernels::PremultiplyAlpha(uint8_t* rgba, size_t pixelCount)
+{
+	size_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+	SimdLevel level = GetLevel();
+	if (level == SimdLevel::AVX2)
+		done = Utils::PremultiplyAlphaAVX2(rgba, pixelCount);
+	else if (level == SimdLevel::SSE41)
+		done = Utils::PremultiplyAlphaSSE41(rgba, pixelCount);
+#endif
+	Utils::PremultiplyAlpha(rgba, done, pixelCount);
+}
+
+void ImageKernels::UnpremultiplyAlpha(uint8_t* rgba, size_t pixelCount)
+{
+	size_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+	SimdLevel level = GetLevel();
+	if (level == SimdLevel::AVX2)
+		done = Utils::UnpremultiplyAlphaAVX2(rgba, pixelCount);
+	else if (level == SimdLevel::SSE41)
+		done = Utils::UnpremultiplyAlphaSSE41(rgba, pixelCount);
+#endif
+	Utils::UnpremultiplyAlpha(rgba, done, pixelCount);
+}
+
+void ImageKernels::ExpandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+{
+	size_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+	SimdLevel level = GetLevel();
+	if (level == SimdLevel::AVX2)
+		done = Utils::ExpandRGBToRGBAAVX2(rgb, rgba, pixelCount);
+	else if (level == SimdLevel::SSE41)
+		done = Utils::ExpandRGBToRGBASSE41(rgb, rgba, pixelCount);
+#endif
+	Utils::ExpandRGBToRGBA(rgb, rgba, done, pixelCount);
+}
+
+void ImageKernels::RenormalizeNormals(uint8_t* pixels, size_t pixelCount, uint32_t channels)
+{
+	size_t done = 0;
+#if GABGL_IMAGE_KERNELS_X86
+	// Bound by the per-pixel dot product and square root, AVX2 runs the SSE4.1 loop
+	if (GetLevel() != SimdLevel::Scalar)
+		done = Utils::RenormalizeNormalsSSE41(pixels, pixelCount, channels);
+#endif
+	Utils::RenormalizeNormals(pixels, done, pixelCount, channels);
+}
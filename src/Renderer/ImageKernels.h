@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class SimdLevel : uint32_t
+{
+	Scalar = 0,
+	SSE41,
+	AVX2
+};
+
+// CPU image operations for the texture loaders and the cooker, on tightly packed 8-bit pixels.
+// Every kernel has a scalar version, and SSE4.1/AVX2 ones where the instruction set pays off;
+// the level is picked once from what the CPU reports. The integer kernels give the same bytes
+// at every level, so cooked data doesn't depend on the machine that cooked it.
+struct ImageKernels
+{
+	static SimdLevel GetSupportedLevel();
+	static SimdLevel GetLevel();
+	// Clamped to GetSupportedLevel(), for benchmarks and checking the fallbacks
+	static void SetLevel(SimdLevel level);
+	static const char* GetLevelName(SimdLevel level);
+
+	// 2x2 box filter to max(width / 2, 1) x max(height / 2, 1), rounded. Odd sizes repeat the
+	// last row and column. 1 to 4 channels
+	static void Downsample(const uint8_t* source, uint32_t width, uint32_t height, uint32_t channels, uint8_t* destination);
+	// Same filter averaged in linear light: the first three channels are sRGB encoded, a fourth
+	// is alpha and averaged as is. 3 or 4 channels
+	static void DownsampleSRGB(const uint8_t* source, uint32_t width, uint32_t height, uint32_t channels, uint8_t* destination);
+
+	// Every value is treated as a color channel
+	static void SRGBToLinear(const uint8_t* source, float* destination, size_t count);
+	// Clamped to [0, 1]; within 0.55 of a code of the exact encoding
+	static void LinearToSRGB(const float* source, uint8_t* destination, size_t count);
+
+	// RGBA in place, color * alpha / 255 rounded
+	static void PremultiplyAlpha(uint8_t* rgba, size_t pixelCount);
+	// RGBA in place, the inverse up to rounding. Fully transparent pixels become 0
+	static void UnpremultiplyAlpha(uint8_t* rgba, size_t pixelCount);
+	// Alpha 255, rgb and rgba must not overlap
+	static void ExpandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount);
+	// xyz read as a [-1, 1] vector and scaled back to unit length, a fourth channel is kept.
+	// 3 or 4 channels
+	static void RenormalizeNormals(uint8_t* pixels, size_t pixelCount, uint32_t channels);
+};
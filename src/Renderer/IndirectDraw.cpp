@@ -0,0 +1,289 @@
+#include "IndirectDraw.h"
+
+#include <glad/glad.h>
+#include "Shader.h"
+#include "../Backend/BackendLogger.h"
+#include "../Backend/MemoryTracker.h"
+#include "../Backend/Profiler.h"
+
+#include <algorithm>
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must match the GL layout");
+static_assert(sizeof(IndirectObject) == 128, "IndirectObject must match the std430 layout in cull_indirect.glsl");
+
+namespace Utils {
+
+	static constexpr uint32_t CullGroupSize = 64;
+	static constexpr uint32_t MinObjectCapacity = 256;
+	static constexpr uint32_t MinBatchCapacity = 16;
+
+	// Left, right, bottom, top, near, far, unnormalized: the shader only compares signs
+	static void ExtractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+	{
+		glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		planes[0] = row3 + row0;
+		planes[1] = row3 - row0;
+		planes[2] = row3 + row1;
+		planes[3] = row3 - row1;
+		planes[4] = row3 + row2;
+		planes[5] = row3 - row2;
+	}
+
+	static bool HasIndirectCount()
+	{
+		return GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_indirect_parameters;
+	}
+}
+
+static struct IndirectDrawData
+{
+	Handle<Shader> CullShader;
+} s_Data;
+
+bool IndirectDrawList::IsSupported()
+{
+	// model.glsl reads the object index back through gl_BaseInstanceARB
+	return GLAD_GL_VERSION_4_3 && (GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_shader_draw_parameters);
+}
+
+bool IndirectDrawList::IsReady() const
+{
+	return s_Data.CullShader && s_Data.CullShader->IsReady();
+}
+
+IndirectDrawList::IndirectDrawList(Handle<GeometryBuffer> geometry)
+	: m_Geometry(geometry)
+{
+	GABGL_ASSERT(IsSupported(), "IndirectDrawList needs OpenGL 4.3 and shader draw parameters!");
+
+	// Every list shares the one cull program, it is watched for hot reload like any other shader
+	if (!s_Data.CullShader)
+		s_Data.CullShader = Shader::Create("../res/shaders/cull_indirect.glsl");
+
+	m_RangeVersion = m_Geometry->GetRangeVersion();
+}
+
+IndirectDrawList::~IndirectDrawList()
+{
+	glDeleteBuffers(1, &m_ObjectBuffer);
+	glDeleteBuffers(1, &m_CommandBuffer);
+	glDeleteBuffers(1, &m_CountBuffer);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, (int64_t)m_ObjectCapacity * (sizeof(IndirectObject) + sizeof(DrawElementsIndirectCommand)) + (int64_t)m_BatchCapacity * sizeof(uint32_t));
+}
+
+uint32_t IndirectDrawList::AddBatch()
+{
+	m_Batches.emplace_back();
+	m_BatchesDirty = true;
+	return (uint32_t)m_Batches.size() - 1;
+}
+
+uint32_t IndirectDrawList::AddObject(uint32_t batch, uint32_t meshID, const glm::mat4& transform, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	GABGL_ASSERT(batch < m_Batches.size(), "Unknown indirect batch!");
+
+	uint32_t object;
+	if (!m_FreeObjects.empty())
+	{
+		object = m_FreeObjects.back();
+		m_FreeObjects.pop_back();
+	}
+	else
+	{
+		object = (uint32_t)m_Objects.size();
+		m_Objects.emplace_back();
+		m_MeshIDs.push_back(GeometryBuffer::InvalidMesh);
+	}
+
+	const GeometryRange& range = m_Geometry->GetRange(meshID);
+	IndirectObject& entry = m_Objects[object];
+	entry.Transform = transform;
+	entry.BoundsCenter = glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f);
+	entry.BoundsExtents = glm::vec4((boundsMax - boundsMin) * 0.5f, 0.0f);
+	entry.Draw = glm::uvec4(range.IndexCount, range.BaseIndex, (uint32_t)range.BaseVertex, batch);
+	entry.Command = glm::uvec4(0);
+	m_MeshIDs[object] = meshID;
+
+	m_Batches[batch].ObjectCount++;
+	m_BatchesDirty = true;
+	MarkDirty(object);
+	return object;
+}
+
+void IndirectDrawList::SetTransform(uint32_t object, const glm::mat4& transform)
+{
+	if (object >= m_Objects.size() || m_Objects[object].Draw.x == 0)
+		return;
+
+	m_Objects[object].Transform = transform;
+	MarkDirty(object);
+}
+
+void IndirectDrawList::RemoveObject(uint32_t object)
+{
+	if (object >= m_Objects.size() || m_Objects[object].Draw.x == 0)
+		return;
+
+	// An index count of zero is what the cull pass skips, the slot stays in place until reused
+	IndirectObject& entry = m_Objects[object];
+	m_Batches[entry.Draw.w].ObjectCount--;
+	entry.Draw = glm::uvec4(0);
+	m_MeshIDs[object] = GeometryBuffer::InvalidMesh;
+	m_FreeObjects.push_back(object);
+	m_BatchesDirty = true;
+	MarkDirty(object);
+}
+
+void IndirectDrawList::Cull(const glm::mat4& viewProjection)
+{
+	GABGL_PROFILE_SCOPE("IndirectDrawList::Cull");
+
+	if (m_Objects.empty() || !IsReady())
+		return;
+
+	if (m_RangeVersion != m_Geometry->GetRangeVersion())
+		RefreshRanges();
+	if (m_BatchesDirty)
+		RebuildBatches();
+
+	ReserveBuffers();
+	if (m_DirtyBegin < m_DirtyEnd)
+	{
+		glNamedBufferSubData(m_ObjectBuffer, (GLintptr)m_DirtyBegin * sizeof(IndirectObject), (GLsizeiptr)(m_DirtyEnd - m_DirtyBegin) * sizeof(IndirectObject), &m_Objects[m_DirtyBegin]);
+		m_DirtyBegin = m_DirtyEnd = 0;
+	}
+
+	// Without a count buffer every slot up to the batch size is drawn, zeroed ones draw nothing
+	uint32_t zero = 0;
+	glClearNamedBufferData(m_CountBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	if (!Utils::HasIndirectCount())
+		glClearNamedBufferData(m_CommandBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+	glm::vec4 planes[6];
+	Utils::ExtractFrustumPlanes(viewProjection, planes);
+
+	s_Data.CullShader->Use();
+	glUniform4fv(s_Data.CullShader->getUniformLocation("u_Planes"), 6, &planes[0].x);
+	s_Data.CullShader->setInt("u_ObjectCount", (int)m_Objects.size());
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, (GLuint)IndirectBinding::Objects, m_ObjectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, (GLuint)IndirectBinding::Commands, m_CommandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, (GLuint)IndirectBinding::Counts, m_CountBuffer);
+	glDispatchCompute(((uint32_t)m_Objects.size() + Utils::CullGroupSize - 1) / Utils::CullGroupSize, 1, 1);
+
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void IndirectDrawList::Draw(uint32_t batch) const
+{
+	const BatchInfo& info = m_Batches[batch];
+	if (info.ObjectCount == 0 || m_CommandBuffer == 0)
+		return;
+
+	m_Geometry->Bind();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, (GLuint)IndirectBinding::Objects, m_ObjectBuffer);
+
+	const void* commands = (const void*)((size_t)info.CommandBase * sizeof(DrawElementsIndirectCommand));
+	GLintptr countOffset = (GLintptr)batch * sizeof(uint32_t);
+	if (GLAD_GL_VERSION_4_6)
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER, m_CountBuffer);
+		glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, commands, countOffset, (GLsizei)info.ObjectCount, 0);
+	}
+	else if (GLAD_GL_ARB_indirect_parameters)
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, m_CountBuffer);
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, commands, countOffset, (GLsizei)info.ObjectCount, 0);
+	}
+	else
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands, (GLsizei)info.ObjectCount, 0);
+}
+
+void IndirectDrawList::MarkDirty(uint32_t object)
+{
+	if (m_DirtyBegin >= m_DirtyEnd)
+	{
+		m_DirtyBegin = object;
+		m_DirtyEnd = object + 1;
+		return;
+	}
+	m_DirtyBegin = std::min(m_DirtyBegin, object);
+	m_DirtyEnd = std::max(m_DirtyEnd, object + 1);
+}
+
+void IndirectDrawList::RebuildBatches()
+{
+	// Each batch gets as many command slots as it has objects, laid out back to back
+	uint32_t commandBase = 0;
+	for (auto& batch : m_Batches)
+	{
+		batch.CommandBase = commandBase;
+		commandBase += batch.ObjectCount;
+	}
+
+	for (uint32_t object = 0; object < m_Objects.size(); object++)
+	{
+		IndirectObject& entry = m_Objects[object];
+		if (entry.Draw.x != 0)
+			entry.Command.x = m_Batches[entry.Draw.w].CommandBase;
+	}
+
+	m_DirtyBegin = 0;
+	m_DirtyEnd = (uint32_t)m_Objects.size();
+	m_BatchesDirty = false;
+}
+
+void IndirectDrawList::RefreshRanges()
+{
+	// Defragmenting moved the meshes, every cached offset is stale
+	for (uint32_t object = 0; object < m_Objects.size(); object++)
+	{
+		if (m_MeshIDs[object] == GeometryBuffer::InvalidMesh)
+			continue;
+
+		const GeometryRange& range = m_Geometry->GetRange(m_MeshIDs[object]);
+		m_Objects[object].Draw.y = range.BaseIndex;
+		m_Objects[object].Draw.z = (uint32_t)range.BaseVertex;
+	}
+
+	m_DirtyBegin = 0;
+	m_DirtyEnd = (uint32_t)m_Objects.size();
+	m_RangeVersion = m_Geometry->GetRangeVersion();
+}
+
+void IndirectDrawList::ReserveBuffers()
+{
+	uint32_t objectCapacity = m_ObjectCapacity, batchCapacity = m_BatchCapacity;
+	while (objectCapacity < m_Objects.size())
+		objectCapacity = std::max(objectCapacity * 2, Utils::MinObjectCapacity);
+	while (batchCapacity < m_Batches.size())
+		batchCapacity = std::max(batchCapacity * 2, Utils::MinBatchCapacity);
+
+	if (objectCapacity == m_ObjectCapacity && batchCapacity == m_BatchCapacity)
+		return;
+
+	// Contents are rebuilt every frame, so growing just starts over with bigger buffers
+	glDeleteBuffers(1, &m_ObjectBuffer);
+	glDeleteBuffers(1, &m_CommandBuffer);
+	glDeleteBuffers(1, &m_CountBuffer);
+	MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, (int64_t)m_ObjectCapacity * (sizeof(IndirectObject) + sizeof(DrawElementsIndirectCommand)) + (int64_t)m_BatchCapacity * sizeof(uint32_t));
+
+	m_ObjectCapacity = objectCapacity;
+	m_BatchCapacity = batchCapacity;
+
+	glCreateBuffers(1, &m_ObjectBuffer);
+	glCreateBuffers(1, &m_CommandBuffer);
+	glCreateBuffers(1, &m_CountBuffer);
+	glNamedBufferStorage(m_ObjectBuffer, (GLsizeiptr)m_ObjectCapacity * sizeof(IndirectObject), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(m_CommandBuffer, (GLsizeiptr)m_ObjectCapacity * sizeof(DrawElementsIndirectCommand), nullptr, 0);
+	glNamedBufferStorage(m_CountBuffer, (GLsizeiptr)m_BatchCapacity * sizeof(uint32_t), nullptr, 0);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, (int64_t)m_ObjectCapacity * (sizeof(IndirectObject) + sizeof(DrawElementsIndirectCommand)) + (int64_t)m_BatchCapacity * sizeof(uint32_t));
+
+	m_DirtyBegin = 0;
+	m_DirtyEnd = (uint32_t)m_Objects.size();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Buffer.h"
+#include "../Backend/ResourcePool.h"
+
+// Shader storage bindings of the GPU-driven path, see res/shaders/cull_indirect.glsl
+enum class IndirectBinding : uint32_t
+{
+	Objects = 7,
+	Commands = 8,
+	Counts = 9
+};
+
+struct DrawElementsIndirectCommand
+{
+	uint32_t Count;
+	uint32_t InstanceCount;
+	uint32_t FirstIndex;
+	int32_t BaseVertex;
+	uint32_t BaseInstance;
+};
+
+// std430 layout of one entry in the Objects buffer. Vertex shaders read the transform back
+// through gl_BaseInstance, which the culling pass sets to the object index.
+struct IndirectObject
+{
+	glm::mat4 Transform;
+	glm::vec4 BoundsCenter;  // local space, w unused
+	glm::vec4 BoundsExtents; // half size, w unused
+	glm::uvec4 Draw;         // index count (0 = empty slot), first index, base vertex, batch
+	glm::uvec4 Command;      // first command slot of the batch, rest unused
+};
+
+// Objects drawn from one GeometryBuffer, culled against the frustum by a compute pass that
+// writes the draw commands. Objects are grouped in batches (one per material); every batch is
+// one glMultiDrawElementsIndirectCount call, so the CPU cost doesn't depend on object count.
+struct IndirectDrawList
+{
+	static constexpr uint32_t InvalidObject = 0xFFFFFFFF;
+
+	IndirectDrawList(Handle<GeometryBuffer> geometry);
+	virtual ~IndirectDrawList();
+
+	uint32_t AddBatch();
+	uint32_t AddObject(uint32_t batch, uint32_t meshID, const glm::mat4& transform, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	void SetTransform(uint32_t object, const glm::mat4& transform);
+	void RemoveObject(uint32_t object);
+
+	// False while the cull program is still compiling or failed to build: Cull() and Draw() do
+	// nothing then, so callers draw per mesh until it is
+	bool IsReady() const;
+	// Uploads changed objects and rebuilds every batch's commands, once per frame before Draw()
+	void Cull(const glm::mat4& viewProjection);
+	// Binds the geometry VAO and the object buffer, the caller binds the shader and material
+	void Draw(uint32_t batch) const;
+
+	uint32_t GetObjectCount() const { return (uint32_t)(m_Objects.size() - m_FreeObjects.size()); }
+	uint32_t GetBatchCount() const { return (uint32_t)m_Batches.size(); }
+	// False when the driver lacks compute, indirect drawing or shader draw parameters, callers keep
+	// their per-mesh path
+	static bool IsSupported();
+	inline static Handle<IndirectDrawList> Create(Handle<GeometryBuffer> geometry) { return CreateHandle<IndirectDrawList>(geometry); }
+private:
+	void MarkDirty(uint32_t object);
+	void RebuildBatches();
+	void RefreshRanges();
+	void ReserveBuffers();
+
+	struct BatchInfo
+	{
+		uint32_t CommandBase = 0;
+		uint32_t ObjectCount = 0;
+	};
+
+	Handle<GeometryBuffer> m_Geometry;
+	std::vector<IndirectObject> m_Objects;
+	std::vector<uint32_t> m_MeshIDs;
+	std::vector<uint32_t> m_FreeObjects;
+	std::vector<BatchInfo> m_Batches;
+
+	uint32_t m_ObjectBuffer = 0;
+	uint32_t m_CommandBuffer = 0;
+	uint32_t m_CountBuffer = 0;
+	uint32_t m_ObjectCapacity = 0;
+	uint32_t m_BatchCapacity = 0;
+
+	uint32_t m_RangeVersion = 0;
+	uint32_t m_DirtyBegin = 0;
+	uint32_t m_DirtyEnd = 0;
+	bool m_BatchesDirty = true;
+};
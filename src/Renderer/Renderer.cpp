@@ -1,18 +1,41 @@
 #include "Renderer.h"
 #include "RendererAPI.h"
+#include "GLIntercept.h"
 #include "Renderer2D.h"
+#include "ShaderCache.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
+#include "../Backend/MemoryTracker.h"
 
 Scope<Renderer::SceneData> Renderer::s_SceneData = CreateScope<Renderer::SceneData>();
 
 void Renderer::Init()
 {
+	GABGL_MEMORY_TAG(Renderer);
+
 	RendererAPI::Init();
+	ShaderCache::Init();
+	TextureCooker::Init();
+	TextureStreamer::Init();
+	Shader::InitCompiler();
 	Renderer2D::Init();
+
+	s_SceneData->FrameUniformBuffer = UniformBuffer::Create(sizeof(FrameUniforms), UniformBinding::Frame);
+	s_SceneData->ObjectRing = UniformRingBuffer::Create(ObjectRingSize);
+	s_SceneData->Clock.Reset();
+	s_SceneData->LastFrameTime = 0.0f;
 }
 
 void Renderer::Shutdown()
 {
+	DestroyHandle(s_SceneData->ObjectRing);
+	DestroyHandle(s_SceneData->FrameUniformBuffer);
+	s_SceneData->ObjectRing = {};
+	s_SceneData->FrameUniformBuffer = {};
+
 	Renderer2D::Shutdown();
+	Shader::ShutdownCompiler();
+	RendererAPI::Shutdown();
 }
 
 void Renderer::OnWindowResize(uint32_t width, uint32_t height)
@@ -20,21 +43,82 @@ void Renderer::OnWindowResize(uint32_t width, uint32_t height)
 	RendererAPI::SetViewport(0, 0, width, height);
 }
 
-void Renderer::BeginScene(EditorCamera& camera)
+void Renderer::BeginFrame()
+{
+	UniformRingBuffer* ring = s_SceneData->ObjectRing.Get();
+	if (!ring)
+		return;
+
+	float time = s_SceneData->Clock.Elapsed();
+	s_SceneData->Frame.Time = glm::vec4(time, time - s_SceneData->LastFrameTime, 0.0f, 0.0f);
+	s_SceneData->LastFrameTime = time;
+
+	ring->BeginFrame();
+}
+
+void Renderer::EndFrame()
 {
-	s_SceneData->ViewProjectionMatrix = camera.GetViewProjection();
+	if (UniformRingBuffer* ring = s_SceneData->ObjectRing.Get())
+		ring->EndFrame();
+	RendererAPI::EndStateFrame();
+	GLIntercept::EndFrame();
+}
+
+void Renderer::BeginScene(const EditorCamera& camera)
+{
+	BeginScene(camera.GetViewMatrix(), camera.GetProjection(), camera.GetPosition());
+}
+
+void Renderer::BeginScene(const Camera& camera, const glm::mat4& transform)
+{
+	BeginScene(glm::inverse(transform), camera.GetProjection(), glm::vec3(transform[3]));
+}
+
+void Renderer::BeginScene(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+{
+	FrameUniforms& frame = s_SceneData->Frame;
+	frame.View = view;
+	frame.Projection = projection;
+	frame.ViewProjection = projection * view;
+	frame.CameraPosition = glm::vec4(position, 1.0f);
+
+	if (UniformBuffer* buffer = s_SceneData->FrameUniformBuffer.Get())
+		buffer->SetData(&frame, sizeof(FrameUniforms));
 }
 
 void Renderer::EndScene()
 {
 }
 
-//void Renderer::Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertexArray, const glm::mat4& transform)
-//{
-//	shader->Bind();
-//	shader->SetMat4("u_ViewProjection", s_SceneData->ViewProjectionMatrix);
-//	shader->SetMat4("u_Transform", transform);
-//
-//	vertexArray->Bind();
-//	RenderCommand::DrawIndexed(vertexArray);
-//}
\ No newline at end of file
+bool Renderer::BindObject(const glm::mat4& transform, int entityID)
+{
+	UniformRingBuffer* ring = s_SceneData->ObjectRing.Get();
+	if (!ring)
+		return false;
+
+	UniformRingAllocation allocation = ring->Allocate(sizeof(ObjectUniforms));
+	if (!allocation)
+		return false;
+
+	ObjectUniforms* object = (ObjectUniforms*)allocation.Data;
+	object->Transform = transform;
+	object->NormalMatrix = glm::transpose(glm::inverse(transform));
+	object->EntityID = glm::ivec4(entityID, 0, 0, 0);
+	ring->Bind(UniformBinding::Object, allocation);
+	return true;
+}
+
+void Renderer::Submit(Handle<Shader> shader, Handle<VertexArray> vertexArray, const glm::mat4& transform, int entityID)
+{
+	if (!BindObject(transform, entityID))
+		return;
+
+	shader->Use();
+	RendererAPI::DrawIndexed(vertexArray);
+}
+
+uint32_t Renderer::GetObjectBytesThisFrame()
+{
+	UniformRingBuffer* ring = s_SceneData->ObjectRing.Get();
+	return ring ? ring->GetBytesThisFrame() : 0;
+}
@@ -1,26 +1,45 @@
 #pragma once
 
 #include "../Renderer/Shader.h"
+#include "../Renderer/Buffer.h"
 #include "../Backend/BackendScopeRef.h"
 #include "../Editor/CameraEditor.h"
 
 struct Renderer
 {
+	// Per-object data handed out of the ring each frame, 8 MB covers ~60k draws
+	static constexpr uint32_t ObjectRingSize = 8 * 1024 * 1024;
+
 	static void Init();
 	static void Shutdown();
 
 	static void OnWindowResize(uint32_t width, uint32_t height);
 
-	static void BeginScene(EditorCamera& camera);
+	// Brackets the frame for the per-object ring and the GL call counters, no-ops until Init()
+	static void BeginFrame();
+	static void EndFrame();
+
+	// Uploads the Frame block once, every shader reads view/projection from there
+	static void BeginScene(const EditorCamera& camera);
+	static void BeginScene(const Camera& camera, const glm::mat4& transform);
+	static void BeginScene(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
 	static void EndScene();
 
-	//static void Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertexArray, const glm::mat4& transform = glm::mat4(1.0f));
+	// Writes the Object block for the next draw, returns false when the ring is full
+	static bool BindObject(const glm::mat4& transform, int entityID = -1);
+	static void Submit(Handle<Shader> shader, Handle<VertexArray> vertexArray, const glm::mat4& transform = glm::mat4(1.0f), int entityID = -1);
+
+	static uint32_t GetObjectBytesThisFrame();
 
 private:
 	struct SceneData
 	{
-		glm::mat4 ViewProjectionMatrix;
+		FrameUniforms Frame;
+		Handle<UniformBuffer> FrameUniformBuffer;
+		Handle<UniformRingBuffer> ObjectRing;
+		Timer Clock;
+		float LastFrameTime = 0.0f;
 	};
 
 	static Scope<SceneData> s_SceneData;
-};
\ No newline at end of file
+};
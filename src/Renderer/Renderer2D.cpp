@@ -3,18 +3,8 @@
 #include "Buffer.h"
 #include <array>
 #include "RendererAPI.h"
-
-struct QuadVertex
-{
-	glm::vec3 Position;
-	glm::vec4 Color;
-	glm::vec2 TexCoord;
-	float TexIndex;
-	float TilingFactor;
-
-	// Editor-only
-	int EntityID;
-};
+#include "TextureStreamer.h"
+#include "../Backend/Profiler.h"
 
 struct CircleVertex
 {
@@ -56,22 +46,22 @@ struct Renderer2DData
 	static const uint32_t MaxIndices = MaxQuads * 6;
 	static const uint32_t MaxTextureSlots = 32; // TODO: RenderCaps
 
-	Ref<VertexArray> QuadVertexArray;
-	Ref<VertexBuffer> QuadVertexBuffer;
-	Ref<Shader> QuadShader;
-	Ref<Texture> WhiteTexture;
+	Handle<VertexArray> QuadVertexArray;
+	Handle<VertexBuffer> QuadVertexBuffer;
+	Handle<Shader> QuadShader;
+	Handle<Texture> WhiteTexture;
 
-	Ref<VertexArray> CircleVertexArray;
-	Ref<VertexBuffer> CircleVertexBuffer;
-	Ref<Shader> CircleShader;
+	Handle<VertexArray> CircleVertexArray;
+	Handle<VertexBuffer> CircleVertexBuffer;
+	Handle<Shader> CircleShader;
 
-	Ref<VertexArray> LineVertexArray;
-	Ref<VertexBuffer> LineVertexBuffer;
-	Ref<Shader> LineShader;
+	Handle<VertexArray> LineVertexArray;
+	Handle<VertexBuffer> LineVertexBuffer;
+	Handle<Shader> LineShader;
 
-	Ref<VertexArray> TextVertexArray;
-	Ref<VertexBuffer> TextVertexBuffer;
-	Ref<Shader> TextShader;
+	Handle<VertexArray> TextVertexArray;
+	Handle<VertexBuffer> TextVertexBuffer;
+	Handle<Shader> TextShader;
 
 	uint32_t QuadIndexCount = 0;
 	QuadVertex* QuadVertexBufferBase = nullptr;
@@ -91,10 +81,13 @@ struct Renderer2DData
 
 	float LineWidth = 20.0f;
 
-	std::array<Ref<Texture>, MaxTextureSlots> TextureSlots;
+	std::array<Handle<Texture>, MaxTextureSlots> TextureSlots;
 	uint32_t TextureSlotIndex = 1; // 0 = white texture
+	// Largest on-screen size of one repeat of each slot's texture this batch, for TextureStreamer
+	std::array<glm::vec2, MaxTextureSlots> TextureSlotScreenSizes;
+	glm::vec2 HalfViewportSize = { 0.0f, 0.0f };
 
-	Ref<Texture> FontAtlasTexture;
+	Handle<Texture> FontAtlasTexture;
 
 	glm::vec4 QuadVertexPositions[4];
 
@@ -105,9 +98,25 @@ struct Renderer2DData
 		glm::mat4 ViewProjection;
 	};
 	CameraData CameraBuffer;
-	Ref<UniformBuffer> CameraUniformBuffer;
+	Handle<UniformBuffer> CameraUniformBuffer;
 } s_Data;
 
+namespace Utils {
+
+	// Pixels covered by the quad's edges, scaled at the depth of its center
+	static glm::vec2 GetScreenSize(const glm::mat4& transform)
+	{
+		const glm::mat4& viewProjection = s_Data.CameraBuffer.ViewProjection;
+		glm::vec4 center = viewProjection * transform[3];
+		if (center.w <= 0.0f)
+			return { 0.0f, 0.0f };
+
+		glm::vec2 edgeX = glm::vec2(viewProjection * transform[0]) * s_Data.HalfViewportSize;
+		glm::vec2 edgeY = glm::vec2(viewProjection * transform[1]) * s_Data.HalfViewportSize;
+		return glm::vec2(glm::length(edgeX), glm::length(edgeY)) / center.w;
+	}
+}
+
 void Renderer2D::Init()
 {
 	s_Data.QuadVertexArray = VertexArray::Create();
@@ -141,7 +150,7 @@ void Renderer2D::Init()
 		offset += 4;
 	}
 
-	Ref<IndexBuffer> quadIB = IndexBuffer::Create(quadIndices, s_Data.MaxIndices);
+	Handle<IndexBuffer> quadIB = IndexBuffer::Create(quadIndices, s_Data.MaxIndices);
 	s_Data.QuadVertexArray->SetIndexBuffer(quadIB);
 	delete[] quadIndices;
 
@@ -195,9 +204,9 @@ void Renderer2D::Init()
 	for (uint32_t i = 0; i < s_Data.MaxTextureSlots; i++)
 		samplers[i] = i;
 
-	s_Data.QuadShader = Shader::Create("../res/shaders/Renderer2D_Quad.glsl");
+	s_Data.QuadShader = Shader::CreateAsync("../res/shaders/Renderer2D_Quad.glsl");
 	//s_Data.CircleShader = Shader::Create("assets/shaders/Renderer2D_Circle.glsl");
-	s_Data.LineShader = Shader::Create("../res/shaders/Renderer2D_Line.glsl");
+	s_Data.LineShader = Shader::CreateAsync("../res/shaders/Renderer2D_Line.glsl");
 	//s_Data.TextShader = Shader::Create("assets/shaders/Renderer2D_Text.glsl");
 
 	// Set first texture slot to 0
@@ -231,6 +240,9 @@ void Renderer2D::StartBatch()
 	s_Data.TextVertexBufferPtr = s_Data.TextVertexBufferBase;
 
 	s_Data.TextureSlotIndex = 1;
+
+	glm::uvec4 viewport = RendererAPI::GetViewport();
+	s_Data.HalfViewportSize = { viewport.z * 0.5f, viewport.w * 0.5f };
 }
 
 void Renderer2D::BeginScene(const Camera& camera, const glm::mat4& transform)
@@ -250,6 +262,9 @@ void Renderer2D::BeginScene(const EditorCamera& camera)
 }
 void Renderer2D::Flush()
 {
+	GABGL_PROFILE_SCOPE("Renderer2D::Flush");
+	GABGL_PROFILE_GPU_SCOPE("Renderer2D::Flush");
+
 	if (s_Data.QuadIndexCount)
 	{
 		uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.QuadVertexBufferPtr - (uint8_t*)s_Data.QuadVertexBufferBase);
@@ -258,6 +273,8 @@ void Renderer2D::Flush()
 		// Bind textures
 		for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
 			s_Data.TextureSlots[i]->Bind(i);
+		for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
+			TextureStreamer::ReportUsage(s_Data.TextureSlots[i], s_Data.TextureSlotScreenSizes[i]);
 
 		s_Data.QuadShader->Use();
 		RendererAPI::DrawIndexed(s_Data.QuadVertexArray, s_Data.QuadIndexCount);
@@ -323,12 +340,12 @@ void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, cons
 	DrawQuad(transform, color);
 }
 
-void Renderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Ref<Texture>& texture, float tilingFactor, const glm::vec4& tintColor)
+void Renderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, Handle<Texture> texture, float tilingFactor, const glm::vec4& tintColor)
 {
 	DrawQuad({ position.x, position.y, 0.0f }, size, texture, tilingFactor, tintColor);
 }
 
-void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const Ref<Texture>& texture, float tilingFactor, const glm::vec4& tintColor)
+void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, Handle<Texture> texture, float tilingFactor, const glm::vec4& tintColor)
 {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
 		* glm::scale(glm::mat4(1.0f), { size.x, size.y, 1.0f });
@@ -336,44 +353,47 @@ void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, cons
 	DrawQuad(transform, texture, tilingFactor, tintColor);
 }
 
+void Renderer2D::WriteQuadVertices(QuadVertex* vertices, const glm::mat4& transform, const glm::vec4& color, float textureIndex, float tilingFactor, int entityID)
+{
+	constexpr glm::vec4 quadVertexPositions[] = { { -0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, 0.5f, 0.0f, 1.0f }, { -0.5f, 0.5f, 0.0f, 1.0f } };
+	constexpr glm::vec2 textureCoords[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		vertices[i].Position = transform * quadVertexPositions[i];
+		vertices[i].Color = color;
+		vertices[i].TexCoord = textureCoords[i];
+		vertices[i].TexIndex = textureIndex;
+		vertices[i].TilingFactor = tilingFactor;
+		vertices[i].EntityID = entityID;
+	}
+}
+
 void Renderer2D::DrawQuad(const glm::mat4& transform, const glm::vec4& color, int entityID)
 {
-	constexpr size_t quadVertexCount = 4;
 	const float textureIndex = 0.0f; // White Texture
-	constexpr glm::vec2 textureCoords[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
 	const float tilingFactor = 1.0f;
 
 	if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices)
 		NextBatch();
 
-	for (size_t i = 0; i < quadVertexCount; i++)
-	{
-		s_Data.QuadVertexBufferPtr->Position = transform * s_Data.QuadVertexPositions[i];
-		s_Data.QuadVertexBufferPtr->Color = color;
-		s_Data.QuadVertexBufferPtr->TexCoord = textureCoords[i];
-		s_Data.QuadVertexBufferPtr->TexIndex = textureIndex;
-		s_Data.QuadVertexBufferPtr->TilingFactor = tilingFactor;
-		s_Data.QuadVertexBufferPtr->EntityID = entityID;
-		s_Data.QuadVertexBufferPtr++;
-	}
+	WriteQuadVertices(s_Data.QuadVertexBufferPtr, transform, color, textureIndex, tilingFactor, entityID);
+	s_Data.QuadVertexBufferPtr += 4;
 
 	s_Data.QuadIndexCount += 6;
 
 	s_Data.Stats.QuadCount++;
 }
 
-void Renderer2D::DrawQuad(const glm::mat4& transform, const Ref<Texture>& texture, float tilingFactor, const glm::vec4& tintColor, int entityID)
+void Renderer2D::DrawQuad(const glm::mat4& transform, Handle<Texture> texture, float tilingFactor, const glm::vec4& tintColor, int entityID)
 {
-	constexpr size_t quadVertexCount = 4;
-	constexpr glm::vec2 textureCoords[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
-
 	if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices)
 		NextBatch();
 
 	float textureIndex = 0.0f;
 	for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
 	{
-		if (*s_Data.TextureSlots[i] == *texture)
+		if (s_Data.TextureSlots[i] == texture)
 		{
 			textureIndex = (float)i;
 			break;
@@ -387,19 +407,15 @@ void Renderer2D::DrawQuad(const glm::mat4& transform, const Ref<Texture>& textur
 
 		textureIndex = (float)s_Data.TextureSlotIndex;
 		s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
+		s_Data.TextureSlotScreenSizes[s_Data.TextureSlotIndex] = { 0.0f, 0.0f };
 		s_Data.TextureSlotIndex++;
 	}
 
-	for (size_t i = 0; i < quadVertexCount; i++)
-	{
-		s_Data.QuadVertexBufferPtr->Position = transform * s_Data.QuadVertexPositions[i];
-		s_Data.QuadVertexBufferPtr->Color = tintColor;
-		s_Data.QuadVertexBufferPtr->TexCoord = textureCoords[i];
-		s_Data.QuadVertexBufferPtr->TexIndex = textureIndex;
-		s_Data.QuadVertexBufferPtr->TilingFactor = tilingFactor;
-		s_Data.QuadVertexBufferPtr->EntityID = entityID;
-		s_Data.QuadVertexBufferPtr++;
-	}
+	glm::vec2& screenSize = s_Data.TextureSlotScreenSizes[(uint32_t)textureIndex];
+	screenSize = glm::max(screenSize, Utils::GetScreenSize(transform) / tilingFactor);
+
+	WriteQuadVertices(s_Data.QuadVertexBufferPtr, transform, tintColor, textureIndex, tilingFactor, entityID);
+	s_Data.QuadVertexBufferPtr += 4;
 
 	s_Data.QuadIndexCount += 6;
 
@@ -420,12 +436,12 @@ void Renderer2D::DrawRotatedQuad(const glm::vec3& position, const glm::vec2& siz
 	DrawQuad(transform, color);
 }
 
-void Renderer2D::DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, float rotation, const Ref<Texture>& texture, float tilingFactor, const glm::vec4& tintColor)
+void Renderer2D::DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, float rotation, Handle<Texture> texture, float tilingFactor, const glm::vec4& tintColor)
 {
 	DrawRotatedQuad({ position.x, position.y, 0.0f }, size, rotation, texture, tilingFactor, tintColor);
 }
 
-void Renderer2D::DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<Texture>& texture, float tilingFactor, const glm::vec4& tintColor)
+void Renderer2D::DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, float rotation, Handle<Texture> texture, float tilingFactor, const glm::vec4& tintColor)
 {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
 		* glm::rotate(glm::mat4(1.0f), glm::radians(rotation), { 0.0f, 0.0f, 1.0f })
@@ -10,6 +10,18 @@
 #include "../Scene/Components.hpp"
 #include "../Editor/CameraEditor.h"
 
+struct QuadVertex
+{
+	glm::vec3 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+	float TexIndex;
+	float TilingFactor;
+
+	// Editor-only
+	int EntityID;
+};
+
 struct Renderer2D
 {
 	static void Init();
@@ -24,16 +36,16 @@ struct Renderer2D
 	// Primitives
 	static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
 	static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
-	static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Ref<Texture>& texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
-	static void DrawQuad(const glm::vec3& position, const glm::vec2& size, const Ref<Texture>& texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+	static void DrawQuad(const glm::vec2& position, const glm::vec2& size, Handle<Texture> texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+	static void DrawQuad(const glm::vec3& position, const glm::vec2& size, Handle<Texture> texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
 
 	static void DrawQuad(const glm::mat4& transform, const glm::vec4& color, int entityID = -1);
-	static void DrawQuad(const glm::mat4& transform, const Ref<Texture>& texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f), int entityID = -1);
+	static void DrawQuad(const glm::mat4& transform, Handle<Texture> texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f), int entityID = -1);
 
 	static void DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, float rotation, const glm::vec4& color);
 	static void DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const glm::vec4& color);
-	static void DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, float rotation, const Ref<Texture>& texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
-	static void DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, float rotation, const Ref<Texture>& texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+	static void DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, float rotation, Handle<Texture> texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
+	static void DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, float rotation, Handle<Texture> texture, float tilingFactor = 1.0f, const glm::vec4& tintColor = glm::vec4(1.0f));
 
 	static void DrawCircle(const glm::mat4& transform, const glm::vec4& color, float thickness = 1.0f, float fade = 0.005f, int entityID = -1);
 
@@ -44,6 +56,9 @@ struct Renderer2D
 
 	static void DrawSprite(const glm::mat4& transform, SpriteComponent& src, int entityID);
 
+	// Fills the 4 vertices of one quad, doesn't touch GL
+	static void WriteQuadVertices(QuadVertex* vertices, const glm::mat4& transform, const glm::vec4& color, float textureIndex, float tilingFactor, int entityID);
+
 	struct TextParams
 	{
 		glm::vec4 Color{ 1.0f };
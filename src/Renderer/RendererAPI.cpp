@@ -3,6 +3,139 @@
 #include "../Backend/BackendLogger.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <vector>
+
+namespace Utils {
+
+	struct GPUScopeRecord
+	{
+		const char* Name;
+		GLuint BeginQuery;
+		GLuint EndQuery;
+		uint32_t Depth;
+	};
+
+	struct GPUTimerFrame
+	{
+		std::vector<GPUScopeRecord> Scopes;
+		int64_t ClockOffset = 0; // CPU ns - GPU ns, sampled when the frame started
+		bool Pending = false;
+	};
+}
+
+struct GPUTimerData
+{
+	bool Initialized = false;
+	bool Recording = false;
+	uint32_t TrackID = 0;
+
+	Utils::GPUTimerFrame Frames[RendererAPI::GPUTimerFrames];
+	uint32_t FrameIndex = 0;
+
+	std::vector<GLuint> FreeQueries;
+	std::vector<GLuint> AllQueries;
+	std::vector<uint32_t> OpenScopes;
+};
+
+static GPUTimerData s_GPUTimer;
+
+// Unknown until the first call sets it, so nothing is skipped on the strength of a guess
+static constexpr uint32_t s_UnknownState = 0xFFFFFFFF;
+
+struct GLStateCache
+{
+	uint32_t Program = s_UnknownState;
+	uint32_t VertexArray = s_UnknownState;
+	uint32_t Framebuffer = s_UnknownState;
+	uint32_t Textures[RendererAPI::MaxCachedTextureUnits];
+	uint32_t Samplers[RendererAPI::MaxCachedTextureUnits];
+
+	uint32_t Blend = s_UnknownState;
+	uint32_t DepthTest = s_UnknownState;
+	uint32_t CullFace = s_UnknownState;
+	uint32_t DepthWrite = s_UnknownState;
+	uint32_t BlendSource = s_UnknownState;
+	uint32_t BlendDestination = s_UnknownState;
+	uint32_t DepthFunc = s_UnknownState;
+	uint32_t CullMode = s_UnknownState;
+
+	// Not filtered, kept so renderers can measure screen-space sizes
+	glm::uvec4 Viewport{ 0 };
+
+	StateStatistics Stats;
+	StateStatistics LastFrameStats;
+
+	GLStateCache() { Invalidate(); }
+
+	void Invalidate()
+	{
+		Program = VertexArray = Framebuffer = s_UnknownState;
+		std::fill(std::begin(Textures), std::end(Textures), s_UnknownState);
+		std::fill(std::begin(Samplers), std::end(Samplers), s_UnknownState);
+		Blend = DepthTest = CullFace = DepthWrite = s_UnknownState;
+		BlendSource = BlendDestination = DepthFunc = CullMode = s_UnknownState;
+	}
+
+	// Counts the call and returns true when it has to reach the driver
+	bool Update(StateCall call, uint32_t& cached, uint32_t value)
+	{
+		if (cached == value)
+		{
+			Stats.Skipped[(size_t)call]++;
+			return false;
+		}
+		cached = value;
+		Stats.Issued[(size_t)call]++;
+		return true;
+	}
+};
+
+static GLStateCache s_State;
+
+static GLuint AcquireQuery()
+{
+	if (s_GPUTimer.FreeQueries.empty())
+	{
+		GLuint queries[64];
+		glGenQueries(64, queries);
+		s_GPUTimer.FreeQueries.insert(s_GPUTimer.FreeQueries.end(), queries, queries + 64);
+		s_GPUTimer.AllQueries.insert(s_GPUTimer.AllQueries.end(), queries, queries + 64);
+	}
+
+	GLuint query = s_GPUTimer.FreeQueries.back();
+	s_GPUTimer.FreeQueries.pop_back();
+	return query;
+}
+
+// Returns false if the GPU hasn't reached the end of the frame yet
+static bool ResolveGPUFrame(Utils::GPUTimerFrame& frame)
+{
+	if (!frame.Pending)
+		return true;
+
+	// The "GPU Frame" scope encloses everything else, once it lands the whole frame has
+	GLint available = 0;
+	glGetQueryObjectiv(frame.Scopes.front().EndQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	for (const auto& scope : frame.Scopes)
+	{
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(scope.BeginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(scope.EndQuery, GL_QUERY_RESULT, &end);
+
+		Profiler::SubmitEvent({ scope.Name, (uint64_t)((int64_t)begin + frame.ClockOffset), (uint64_t)((int64_t)end + frame.ClockOffset), scope.Depth, s_GPUTimer.TrackID });
+
+		s_GPUTimer.FreeQueries.push_back(scope.BeginQuery);
+		s_GPUTimer.FreeQueries.push_back(scope.EndQuery);
+	}
+
+	frame.Scopes.clear();
+	frame.Pending = false;
+	return true;
+}
 
 void MessageCallback(
 	unsigned source,
@@ -35,16 +168,47 @@ void RendererAPI::Init()
 	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
 #endif
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	s_State.Invalidate();
+	SetBlend(true);
+	SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable(GL_DEPTH_TEST);
+	SetDepthTest(true);
 	glEnable(GL_LINE_SMOOTH);
+
+	if (!s_GPUTimer.Initialized)
+		s_GPUTimer.TrackID = Profiler::CreateTrack("GPU");
+	s_GPUTimer.Initialized = true;
+}
+
+void RendererAPI::Shutdown()
+{
+	if (!s_GPUTimer.Initialized)
+		return;
+
+	if (!s_GPUTimer.AllQueries.empty())
+		glDeleteQueries((GLsizei)s_GPUTimer.AllQueries.size(), s_GPUTimer.AllQueries.data());
+
+	s_GPUTimer.AllQueries.clear();
+	s_GPUTimer.FreeQueries.clear();
+	s_GPUTimer.OpenScopes.clear();
+	for (auto& frame : s_GPUTimer.Frames)
+	{
+		frame.Scopes.clear();
+		frame.Pending = false;
+	}
+	s_GPUTimer.Recording = false;
+	s_GPUTimer.Initialized = false;
 }
 
 void RendererAPI::SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
 {
 	glViewport(x, y, width, height);
+	s_State.Viewport = { x, y, width, height };
+}
+
+glm::uvec4 RendererAPI::GetViewport()
+{
+	return s_State.Viewport;
 }
 
 void RendererAPI::SetClearColor(const glm::vec4& color)
@@ -57,14 +221,179 @@ void RendererAPI::Clear()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void RendererAPI::DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount)
+uint32_t StateStatistics::GetTotalIssued() const
+{
+	uint32_t total = 0;
+	for (uint32_t count : Issued)
+		total += count;
+	return total;
+}
+
+uint32_t StateStatistics::GetTotalSkipped() const
+{
+	uint32_t total = 0;
+	for (uint32_t count : Skipped)
+		total += count;
+	return total;
+}
+
+void RendererAPI::UseProgram(uint32_t program)
+{
+	if (s_State.Update(StateCall::Program, s_State.Program, program))
+		glUseProgram(program);
+}
+
+void RendererAPI::BindVertexArray(uint32_t vertexArray)
+{
+	if (s_State.Update(StateCall::VertexArray, s_State.VertexArray, vertexArray))
+		glBindVertexArray(vertexArray);
+}
+
+void RendererAPI::BindTextureUnit(uint32_t unit, uint32_t texture)
+{
+	if (unit >= MaxCachedTextureUnits)
+	{
+		s_State.Stats.Issued[(size_t)StateCall::Texture]++;
+		glBindTextureUnit(unit, texture);
+		return;
+	}
+
+	if (s_State.Update(StateCall::Texture, s_State.Textures[unit], texture))
+		glBindTextureUnit(unit, texture);
+}
+
+void RendererAPI::BindSampler(uint32_t unit, uint32_t sampler)
+{
+	if (unit >= MaxCachedTextureUnits)
+	{
+		s_State.Stats.Issued[(size_t)StateCall::Sampler]++;
+		glBindSampler(unit, sampler);
+		return;
+	}
+
+	if (s_State.Update(StateCall::Sampler, s_State.Samplers[unit], sampler))
+		glBindSampler(unit, sampler);
+}
+
+void RendererAPI::BindFramebuffer(uint32_t framebuffer)
+{
+	if (s_State.Update(StateCall::Framebuffer, s_State.Framebuffer, framebuffer))
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+static void SetCapability(uint32_t& cached, GLenum capability, bool enabled)
+{
+	if (!s_State.Update(StateCall::Capability, cached, enabled ? 1 : 0))
+		return;
+
+	if (enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void RendererAPI::SetBlend(bool enabled)
+{
+	SetCapability(s_State.Blend, GL_BLEND, enabled);
+}
+
+void RendererAPI::SetBlendFunc(uint32_t source, uint32_t destination)
+{
+	// Both halves are one call, count it once
+	if (s_State.BlendSource == source && s_State.BlendDestination == destination)
+	{
+		s_State.Stats.Skipped[(size_t)StateCall::BlendFunc]++;
+		return;
+	}
+
+	s_State.BlendSource = source;
+	s_State.BlendDestination = destination;
+	s_State.Stats.Issued[(size_t)StateCall::BlendFunc]++;
+	glBlendFunc(source, destination);
+}
+
+void RendererAPI::SetDepthTest(bool enabled)
+{
+	SetCapability(s_State.DepthTest, GL_DEPTH_TEST, enabled);
+}
+
+void RendererAPI::SetDepthWrite(bool enabled)
+{
+	if (s_State.Update(StateCall::DepthState, s_State.DepthWrite, enabled ? 1 : 0))
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void RendererAPI::SetDepthFunc(uint32_t function)
+{
+	if (s_State.Update(StateCall::DepthState, s_State.DepthFunc, function))
+		glDepthFunc(function);
+}
+
+void RendererAPI::SetCullFace(bool enabled)
+{
+	SetCapability(s_State.CullFace, GL_CULL_FACE, enabled);
+}
+
+void RendererAPI::SetCullMode(uint32_t face)
+{
+	if (s_State.Update(StateCall::CullMode, s_State.CullMode, face))
+		glCullFace(face);
+}
+
+void RendererAPI::OnVertexArrayDeleted(uint32_t vertexArray)
+{
+	if (s_State.VertexArray == vertexArray)
+		s_State.VertexArray = s_UnknownState;
+}
+
+void RendererAPI::OnTextureDeleted(uint32_t texture)
+{
+	for (uint32_t& bound : s_State.Textures)
+	{
+		if (bound == texture)
+			bound = s_UnknownState;
+	}
+}
+
+void RendererAPI::OnSamplerDeleted(uint32_t sampler)
+{
+	for (uint32_t& bound : s_State.Samplers)
+	{
+		if (bound == sampler)
+			bound = s_UnknownState;
+	}
+}
+
+void RendererAPI::OnFramebufferDeleted(uint32_t framebuffer)
+{
+	if (s_State.Framebuffer == framebuffer)
+		s_State.Framebuffer = s_UnknownState;
+}
+
+void RendererAPI::InvalidateStateCache()
+{
+	s_State.Invalidate();
+}
+
+const StateStatistics& RendererAPI::GetStateStats()
+{
+	return s_State.LastFrameStats;
+}
+
+void RendererAPI::EndStateFrame()
+{
+	s_State.LastFrameStats = s_State.Stats;
+	s_State.Stats = StateStatistics{};
+}
+
+void RendererAPI::DrawIndexed(Handle<VertexArray> vertexArray, uint32_t indexCount)
 {
 	vertexArray->Bind();
 	uint32_t count = indexCount ? indexCount : vertexArray->GetIndexBuffer()->GetCount();
 	glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
 }
 
-void RendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount)
+void RendererAPI::DrawLines(Handle<VertexArray> vertexArray, uint32_t vertexCount)
 {
 	vertexArray->Bind();
 	glDrawArrays(GL_LINES, 0, vertexCount);
@@ -75,3 +404,62 @@ void RendererAPI::SetLineWidth(float width)
 	glLineWidth(width);
 }
 
+
+void RendererAPI::BeginGPUFrame()
+{
+	if (!s_GPUTimer.Initialized)
+		return;
+
+	// Close the previous frame, scopes left open by an early return are closed with it
+	if (s_GPUTimer.Recording)
+	{
+		while (!s_GPUTimer.OpenScopes.empty())
+			EndGPUScope();
+
+		s_GPUTimer.Frames[s_GPUTimer.FrameIndex].Pending = true;
+		s_GPUTimer.FrameIndex = (s_GPUTimer.FrameIndex + 1) % GPUTimerFrames;
+	}
+	s_GPUTimer.Recording = false;
+
+	for (uint32_t i = 1; i <= GPUTimerFrames; i++)
+	{
+		if (!ResolveGPUFrame(s_GPUTimer.Frames[(s_GPUTimer.FrameIndex + i) % GPUTimerFrames]))
+			break;
+	}
+
+	// Every slot is still in flight, skip timing this frame rather than stalling
+	Utils::GPUTimerFrame& frame = s_GPUTimer.Frames[s_GPUTimer.FrameIndex];
+	if (frame.Pending || !Profiler::IsEnabled())
+		return;
+
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	frame.ClockOffset = (int64_t)Profiler::Now() - gpuNow;
+
+	s_GPUTimer.Recording = true;
+	BeginGPUScope("GPU Frame");
+}
+
+void RendererAPI::BeginGPUScope(const char* name)
+{
+	if (!s_GPUTimer.Recording)
+		return;
+
+	Utils::GPUTimerFrame& frame = s_GPUTimer.Frames[s_GPUTimer.FrameIndex];
+	s_GPUTimer.OpenScopes.push_back((uint32_t)frame.Scopes.size());
+	frame.Scopes.push_back({ name, AcquireQuery(), 0, (uint32_t)s_GPUTimer.OpenScopes.size() - 1 });
+
+	glQueryCounter(frame.Scopes.back().BeginQuery, GL_TIMESTAMP);
+}
+
+void RendererAPI::EndGPUScope()
+{
+	if (!s_GPUTimer.Recording || s_GPUTimer.OpenScopes.empty())
+		return;
+
+	Utils::GPUScopeRecord& scope = s_GPUTimer.Frames[s_GPUTimer.FrameIndex].Scopes[s_GPUTimer.OpenScopes.back()];
+	s_GPUTimer.OpenScopes.pop_back();
+
+	scope.EndQuery = AcquireQuery();
+	glQueryCounter(scope.EndQuery, GL_TIMESTAMP);
+}
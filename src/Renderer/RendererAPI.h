@@ -1,17 +1,95 @@
 #pragma once
 #include "Buffer.h"
+#include "../Backend/Profiler.h"
 #include <glm/glm.hpp>
 
+enum class StateCall : uint8_t
+{
+	Program = 0,
+	VertexArray,
+	Texture,
+	Sampler,
+	Framebuffer,
+	Capability,
+	BlendFunc,
+	DepthState,
+	CullMode,
+
+	Count
+};
+
+struct StateStatistics
+{
+	uint32_t Issued[(size_t)StateCall::Count] = {};
+	uint32_t Skipped[(size_t)StateCall::Count] = {};
+
+	uint32_t GetTotalIssued() const;
+	uint32_t GetTotalSkipped() const;
+};
+
 struct RendererAPI
 {
+	static constexpr uint32_t GPUTimerFrames = 4;
+	static constexpr uint32_t MaxCachedTextureUnits = 32;
+
 	static void Init();
+	static void Shutdown();
 	static void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+	// x, y, width, height as last set through SetViewport()
+	static glm::uvec4 GetViewport();
 
 	static void SetClearColor(const glm::vec4& color);
 	static void Clear();
 
-	static void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0);
-	static void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount);
+	static void DrawIndexed(Handle<VertexArray> vertexArray, uint32_t indexCount = 0);
+	static void DrawLines(Handle<VertexArray> vertexArray, uint32_t vertexCount);
 
 	static void SetLineWidth(float width);
-};
\ No newline at end of file
+
+	// Binds and toggles go to the driver only when they change something. Anything that binds
+	// these objects directly has to call InvalidateStateCache() afterwards.
+	static void UseProgram(uint32_t program);
+	static void BindVertexArray(uint32_t vertexArray);
+	static void BindTextureUnit(uint32_t unit, uint32_t texture);
+	static void BindSampler(uint32_t unit, uint32_t sampler);
+	static void BindFramebuffer(uint32_t framebuffer);
+	static void SetBlend(bool enabled);
+	static void SetBlendFunc(uint32_t source, uint32_t destination);
+	static void SetDepthTest(bool enabled);
+	static void SetDepthWrite(bool enabled);
+	static void SetDepthFunc(uint32_t function);
+	static void SetCullFace(bool enabled);
+	static void SetCullMode(uint32_t face);
+
+	// Deleting a bound object unbinds it and frees the name for reuse, the cache must not match it
+	static void OnVertexArrayDeleted(uint32_t vertexArray);
+	static void OnTextureDeleted(uint32_t texture);
+	static void OnSamplerDeleted(uint32_t sampler);
+	static void OnFramebufferDeleted(uint32_t framebuffer);
+	static void InvalidateStateCache();
+
+	// Counters of the last finished frame, EndStateFrame() closes the current one
+	static const StateStatistics& GetStateStats();
+	static void EndStateFrame();
+
+	// GPU scopes are timestamp query pairs; results are read back GPUTimerFrames later at the
+	// earliest, never waited on, and submitted to the Profiler on the "GPU" track
+	static void BeginGPUFrame();
+	static void BeginGPUScope(const char* name);
+	static void EndGPUScope();
+};
+
+struct GPUProfileScope
+{
+	GPUProfileScope(const char* name) { RendererAPI::BeginGPUScope(name); }
+	~GPUProfileScope() { RendererAPI::EndGPUScope(); }
+
+	GPUProfileScope(const GPUProfileScope&) = delete;
+	GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+};
+
+#ifndef GABGL_DISABLE_PROFILING
+	#define GABGL_PROFILE_GPU_SCOPE(name) GPUProfileScope GABGL_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+	#define GABGL_PROFILE_GPU_SCOPE(name)
+#endif
@@ -1,218 +1,731 @@
 #include "Shader.h"
+#include "RendererAPI.h"
+#include "ShaderCache.h"
+#include "ShaderSpirv.h"
 #include "../Backend/BackendLogger.h"
+#include "../Backend/FileWatcher.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <filesystem>
+#include <map>
+
+namespace Utils {
+
+    struct ShaderStageInfo
+    {
+        const char* Type;
+        GLenum Stage;
+    };
+
+    static constexpr ShaderStageInfo s_ShaderStages[] = {
+        { "VERTEX",          GL_VERTEX_SHADER },
+        { "FRAGMENT",        GL_FRAGMENT_SHADER },
+        { "GEOMETRY",        GL_GEOMETRY_SHADER },
+        { "TESS_CONTROL",    GL_TESS_CONTROL_SHADER },
+        { "TESS_EVALUATION", GL_TESS_EVALUATION_SHADER },
+        { "COMPUTE",         GL_COMPUTE_SHADER },
+    };
+
+    // Drawn in place of shaders that are still compiling or failed to build.
+    // Matches the Renderer2D layouts: position at location 0, camera block at binding 0.
+    static const char* s_PlaceholderSource = R"(
+#type VERTEX
+#version 450 core
+
+layout(location = 0) in vec3 a_Position;
+
+layout(std140, binding = 0) uniform Camera
+{
+    mat4 u_ViewProjection;
+};
+
+void main()
+{
+    gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
+}
+
+#type FRAGMENT
+#version 450 core
+
+layout(location = 0) out vec4 o_Color;
+layout(location = 1) out int o_EntityID;
+
+void main()
+{
+    o_Color = vec4(1.0, 0.0, 1.0, 1.0);
+    o_EntityID = -1;
+}
+)";
+
+    static bool ReadShaderFile(const char* path, std::string& content)
+    {
+        std::ifstream shaderFile;
+        shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try {
+            shaderFile.open(path);
+            std::stringstream shaderStream;
+            shaderStream << shaderFile.rdbuf();
+            content = shaderStream.str();
+        }
+        catch (std::ifstream::failure& e) {
+            GABGL_WARN("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: {0} {1}", path, e.what());
+            return false;
+        }
+        return true;
+    }
+
+    static const char* GetStageType(GLenum stage)
+    {
+        for (const auto& stageInfo : s_ShaderStages)
+        {
+            if (stageInfo.Stage == stage)
+                return stageInfo.Type;
+        }
+        return nullptr;
+    }
+
+    static uint32_t KeywordBits(const std::vector<std::string>& keywords)
+    {
+        return keywords.size() >= ShaderVariant::MaxKeywords ? ShaderVariant::AllVariants : (1u << keywords.size()) - 1;
+    }
+
+    static std::string SpecializationKey(const std::map<uint32_t, uint32_t>& constants)
+    {
+        std::string key;
+        for (const auto& [id, value] : constants)
+            key += '\0' + std::to_string(id) + '=' + std::to_string(value);
+        return key;
+    }
+
+    static void LogShaderCacheSummary()
+    {
+        [[maybe_unused]] const auto& cacheStats = ShaderCache::GetStats();
+        GABGL_INFO("Shaders ready: {0} from cache ({1} ms), {2} compiled ({3} ms), {4} cache entries rejected", cacheStats.Hits, cacheStats.WarmMs, cacheStats.Compiled, cacheStats.ColdMs, cacheStats.Rejected);
+    }
+
+    static void ExpandIncludes(const std::string& path, const std::string& source, std::vector<std::string>& dependencies, std::vector<std::string>& includeStack, std::string& output)
+    {
+        includeStack.push_back(path);
+
+        size_t lineStart = 0;
+        while (lineStart < source.size())
+        {
+            size_t lineEnd = source.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+                lineEnd = source.size();
+
+            size_t directive = source.find_first_not_of(" \t", lineStart);
+            bool isInclude = directive < lineEnd && source.compare(directive, 8, "#include") == 0;
+            size_t open = isInclude ? source.find('"', directive + 8) : std::string::npos;
+            size_t close = open < lineEnd ? source.find('"', open + 1) : std::string::npos;
+            if (!isInclude || close >= lineEnd)
+            {
+                if (isInclude)
+                    GABGL_ERROR("Malformed #include in {0}: {1}", path, source.substr(lineStart, lineEnd - lineStart));
+                else
+                    output.append(source, lineStart, lineEnd - lineStart);
+                output += '\n';
+                lineStart = lineEnd + 1;
+                continue;
+            }
+
+            std::string includePath = FileWatcher::NormalizePath((std::filesystem::path(path).parent_path() / source.substr(open + 1, close - open - 1)).string());
+            if (std::find(includeStack.begin(), includeStack.end(), includePath) != includeStack.end())
+                GABGL_ERROR("Circular #include of {0} from {1}", includePath, path);
+            else
+            {
+                if (std::find(dependencies.begin(), dependencies.end(), includePath) == dependencies.end())
+                    dependencies.push_back(includePath);
+
+                std::string includeSource;
+                if (ReadShaderFile(includePath.c_str(), includeSource))
+                    ExpandIncludes(includePath, includeSource, dependencies, includeStack, output);
+            }
+
+            output += '\n';
+            lineStart = lineEnd + 1;
+        }
+
+        includeStack.pop_back();
+    }
+}
+
+struct ShaderCompilerData
+{
+    std::vector<Handle<Shader>> Pending;
+    std::vector<Handle<Shader>> Tracked;
+    std::vector<Handle<Shader>> Reloading;
+    Scope<Shader> Placeholder;
+    bool ParallelCompile = false;
+    bool HotReload = true;
+    bool Spirv = false;
+    // Ordered so the program cache key built from it is stable
+    std::map<uint32_t, uint32_t> SpecializationConstants;
+};
+
+static ShaderCompilerData s_Data;
 
 Shader::Shader(const char* fullshader)
 {
-    Timer timer;
     Load(fullshader);
-    GABGL_WARN("Shader creation took {0} ms", timer.ElapsedMillis());
 }
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
 {
-    Timer timer;
     Load(vertexPath, fragmentPath, geometryPath);
-    GABGL_WARN("Shader creation took {0} ms", timer.ElapsedMillis());
+}
+
+Shader::~Shader()
+{
+    for (const auto& [mask, variant] : m_Variants)
+        DestroyHandle(variant);
+    for (const auto& stage : m_PendingStages)
+        glDeleteShader(stage.ID);
+    if (m_ID)
+        glDeleteProgram(m_ID);
 }
 
 void Shader::Load(const char* fullshader)
 {
-    std::ifstream shaderFile(fullshader);
-    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    Submit(fullshader);
+    Finish();
+}
+
+void Shader::Load(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+    Submit(vertexPath, fragmentPath, geometryPath);
+    Finish();
+}
+
+void Shader::Submit(const char* fullshader)
+{
+    m_Name = fullshader;
+    m_LoadTimer.Reset();
+    m_SourcePaths = { fullshader };
+    m_Dependencies = { FileWatcher::NormalizePath(fullshader) };
+
     std::string fileContent;
-    try {
-        std::stringstream shaderStream;
-        shaderStream << shaderFile.rdbuf();
-        fileContent = shaderStream.str();
-    }
-    catch (std::ifstream::failure& e) {
-        GABGL_WARN("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: ",e.what());
+    if (!Utils::ReadShaderFile(fullshader, fileContent))
+    {
+        m_State = ShaderState::Failed;
         return;
     }
 
-    // Parse the shader file into sections based on #type
+    std::string source = Preprocess(fullshader, fileContent, m_Dependencies);
+    m_VariantKeywords = ShaderVariant::ParseKeywords(source);
+    if (!m_VariantKeywords.empty())
+        source = ShaderVariant::InjectDefines(source, m_VariantKeywords, m_VariantMask);
+
+    SubmitSource(source);
+}
+
+void Shader::Submit(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+    m_Name = vertexPath;
+    m_LoadTimer.Reset();
+    m_SourcePaths = { vertexPath, fragmentPath };
+    if (geometryPath != nullptr)
+        m_SourcePaths.push_back(geometryPath);
+    // Watched even when a read fails, so fixing the file brings the shader back
+    m_Dependencies.clear();
+    for (const auto& path : m_SourcePaths)
+        m_Dependencies.push_back(FileWatcher::NormalizePath(path));
+
     std::unordered_map<std::string, std::string> shaderSources;
-    const std::string typeToken = "#type";
-    size_t pos = 0;
-    while ((pos = fileContent.find(typeToken, pos)) != std::string::npos) {
-        size_t endOfLine = fileContent.find('\n', pos);
-        std::string type = fileContent.substr(pos + typeToken.length(), endOfLine - pos - typeToken.length());
-        type = type.substr(type.find_first_not_of(" \t\r\n")); // Trim leading whitespace
-        type = type.substr(0, type.find_last_not_of(" \t\r\n") + 1); // Trim trailing whitespace
+    bool read = Utils::ReadShaderFile(vertexPath, shaderSources["VERTEX"]);
+    read &= Utils::ReadShaderFile(fragmentPath, shaderSources["FRAGMENT"]);
+    if (geometryPath != nullptr)
+        read &= Utils::ReadShaderFile(geometryPath, shaderSources["GEOMETRY"]);
 
-        size_t nextTypePos = fileContent.find(typeToken, endOfLine + 1);
-        if (nextTypePos == std::string::npos)
-            nextTypePos = fileContent.size();
+    if (!read)
+    {
+        m_State = ShaderState::Failed;
+        return;
+    }
 
-        std::string source = fileContent.substr(endOfLine + 1, nextTypePos - endOfLine - 1);
-        shaderSources[type] = source;
+    shaderSources["VERTEX"] = Preprocess(vertexPath, shaderSources["VERTEX"], m_Dependencies);
+    shaderSources["FRAGMENT"] = Preprocess(fragmentPath, shaderSources["FRAGMENT"], m_Dependencies);
+    if (geometryPath != nullptr)
+        shaderSources["GEOMETRY"] = Preprocess(geometryPath, shaderSources["GEOMETRY"], m_Dependencies);
 
-        pos = nextTypePos;
+    // Stage order is fixed so keyword bits mean the same thing on every load
+    m_VariantKeywords.clear();
+    for (const char* type : { "VERTEX", "FRAGMENT", "GEOMETRY" })
+    {
+        auto source = shaderSources.find(type);
+        if (source == shaderSources.end())
+            continue;
+        for (auto& keyword : ShaderVariant::ParseKeywords(source->second))
+        {
+            if (std::find(m_VariantKeywords.begin(), m_VariantKeywords.end(), keyword) == m_VariantKeywords.end())
+                m_VariantKeywords.push_back(std::move(keyword));
+        }
+    }
+    if (!m_VariantKeywords.empty())
+    {
+        for (auto& [type, source] : shaderSources)
+            source = ShaderVariant::InjectDefines(source, m_VariantKeywords, m_VariantMask);
     }
 
-    // Compile each shader
-    GLuint vertex = 0, fragment = 0, geometry = 0, tessControl = 0, tessEvaluation = 0, compute = 0;
+    std::string geometryCode = geometryPath != nullptr ? shaderSources["GEOMETRY"] : std::string();
+    if (LoadFromCache(ShaderCache::ComputeKey(shaderSources["VERTEX"] + '\0' + shaderSources["FRAGMENT"] + '\0' + geometryCode)))
+        return;
+
+    SubmitStages(shaderSources);
+}
+
+void Shader::SubmitPaths(const std::vector<std::string>& paths)
+{
+    if (paths.size() == 1)
+        Submit(paths[0].c_str());
+    else
+        Submit(paths[0].c_str(), paths[1].c_str(), paths.size() > 2 ? paths[2].c_str() : nullptr);
+}
+
+void Shader::SubmitSource(const std::string& fileContent)
+{
+    // A program linked from SPIR-V depends on the specialization values as well as the source
+    if (LoadFromCache(ShaderCache::ComputeKey(fileContent + Utils::SpecializationKey(s_Data.SpecializationConstants))))
+        return;
+
+    if (SubmitSpirv(fileContent))
+        return;
 
-    if (shaderSources.find("VERTEX") != shaderSources.end()) {
-        const char* vertexCode = shaderSources["VERTEX"].c_str();
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vertexCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+    SubmitStages(ParseSources(fileContent));
+}
+
+bool Shader::SubmitSpirv(const std::string& fileContent)
+{
+    if (!s_Data.Spirv || m_SourcePaths.size() != 1)
+        return false;
+
+    ShaderSpirv::Program program;
+    if (!ShaderSpirv::Read(ShaderSpirv::GetCookedPath(m_SourcePaths[0]), program))
+        return false;
+
+    // Variants other than the all-features one hash differently and always compile from GLSL
+    if (program.SourceHash != ShaderSpirv::HashSource(fileContent))
+    {
+        if (m_VariantMask == ShaderVariant::AllVariants)
+            GABGL_WARN("Cooked SPIR-V for {0} is out of date, compiling from source", m_Name);
+        return false;
     }
 
-    if (shaderSources.find("FRAGMENT") != shaderSources.end()) {
-        const char* fragmentCode = shaderSources["FRAGMENT"].c_str();
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fragmentCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+    for (const auto& stage : program.Stages)
+    {
+        if (!Utils::GetStageType(stage.Type))
+        {
+            GABGL_WARN("Cooked SPIR-V for {0} has an unknown stage {1}, compiling from source", m_Name, stage.Type);
+            return false;
+        }
     }
 
-    if (shaderSources.find("GEOMETRY") != shaderSources.end()) {
-        const char* geometryCode = shaderSources["GEOMETRY"].c_str();
-        geometry = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometry, 1, &geometryCode, NULL);
-        glCompileShader(geometry);
-        checkCompileErrors(geometry, "GEOMETRY");
+    for (const auto& stage : program.Stages)
+    {
+        std::vector<GLuint> constantIDs, constantValues;
+        for (uint32_t id : stage.ConstantIDs)
+        {
+            auto constant = s_Data.SpecializationConstants.find(id);
+            if (constant == s_Data.SpecializationConstants.end())
+                continue;
+            constantIDs.push_back(id);
+            constantValues.push_back(constant->second);
+        }
+
+        GLuint shader = glCreateShader(stage.Type);
+        glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, stage.Code.data(), (GLsizei)(stage.Code.size() * sizeof(uint32_t)));
+        glSpecializeShaderARB(shader, "main", (GLuint)constantIDs.size(), constantIDs.data(), constantValues.data());
+        glAttachShader(m_ID, shader);
+        m_PendingStages.push_back({ shader, Utils::GetStageType(stage.Type) });
     }
 
-    if (shaderSources.find("TESS_CONTROL") != shaderSources.end()) {
-        const char* tessControlCode = shaderSources["TESS_CONTROL"].c_str();
-        tessControl = glCreateShader(GL_TESS_CONTROL_SHADER);
-        glShaderSource(tessControl, 1, &tessControlCode, NULL);
-        glCompileShader(tessControl);
-        checkCompileErrors(tessControl, "TESS_CONTROL");
+    m_FromSpirv = true;
+    ShaderCache::PrepareProgram(m_ID);
+    glLinkProgram(m_ID);
+    return true;
+}
+
+bool Shader::LoadFromCache(uint64_t cacheKey)
+{
+    m_CacheKey = cacheKey;
+    m_ID = glCreateProgram();
+    m_FromCache = ShaderCache::Load(m_ID, cacheKey);
+    m_State = ShaderState::Compiling;
+    return m_FromCache;
+}
+
+void Shader::SubmitStages(const std::unordered_map<std::string, std::string>& shaderSources)
+{
+    for (const auto& stageInfo : Utils::s_ShaderStages)
+    {
+        auto source = shaderSources.find(stageInfo.Type);
+        if (source == shaderSources.end())
+            continue;
+
+        const char* code = source->second.c_str();
+        GLuint stage = glCreateShader(stageInfo.Stage);
+        glShaderSource(stage, 1, &code, NULL);
+        glCompileShader(stage);
+        glAttachShader(m_ID, stage);
+        m_PendingStages.push_back({ stage, stageInfo.Type });
     }
 
-    if (shaderSources.find("TESS_EVALUATION") != shaderSources.end()) {
-        const char* tessEvaluationCode = shaderSources["TESS_EVALUATION"].c_str();
-        tessEvaluation = glCreateShader(GL_TESS_EVALUATION_SHADER);
-        glShaderSource(tessEvaluation, 1, &tessEvaluationCode, NULL);
-        glCompileShader(tessEvaluation);
-        checkCompileErrors(tessEvaluation, "TESS_EVALUATION");
+    ShaderCache::PrepareProgram(m_ID);
+    glLinkProgram(m_ID);
+}
+
+bool Shader::IsCompileComplete() const
+{
+    if (m_State != ShaderState::Compiling || m_FromCache || !s_Data.ParallelCompile)
+        return true;
+
+    GLint complete = GL_FALSE;
+    glGetProgramiv(m_ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+void Shader::Finish()
+{
+    if (m_State != ShaderState::Compiling)
+        return;
+
+    for (const auto& stage : m_PendingStages)
+    {
+        checkCompileErrors(stage.ID, stage.Type);
+        glDetachShader(m_ID, stage.ID);
+        glDeleteShader(stage.ID);
     }
+    m_PendingStages.clear();
+
+    if (!m_FromCache)
+        checkCompileErrors(m_ID, "PROGRAM");
 
-    if (shaderSources.find("COMPUTE") != shaderSources.end()) {
-        const char* computeCode = shaderSources["COMPUTE"].c_str();
-        compute = glCreateShader(GL_COMPUTE_SHADER);
-        glShaderSource(compute, 1, &computeCode, NULL);
-        glCompileShader(compute);
-        checkCompileErrors(compute, "COMPUTE");
+    GLint linked = GL_FALSE;
+    glGetProgramiv(m_ID, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        m_State = ShaderState::Failed;
+        GABGL_ERROR("Shader {0} failed to build, drawing with the placeholder", m_Name);
+        return;
     }
 
-    // Link shaders into a program
-    this->m_ID = glCreateProgram();
-    if (vertex != 0) glAttachShader(this->m_ID, vertex);
-    if (fragment != 0) glAttachShader(this->m_ID, fragment);
-    if (geometry != 0) glAttachShader(this->m_ID, geometry);
-    if (tessControl != 0) glAttachShader(this->m_ID, tessControl);
-    if (tessEvaluation != 0) glAttachShader(this->m_ID, tessEvaluation);
-    if (compute != 0) glAttachShader(this->m_ID, compute);
-    glLinkProgram(this->m_ID);
-    checkCompileErrors(this->m_ID, "PROGRAM");
-
-    // Validate the program
-    glValidateProgram(this->m_ID);
+    if (!m_FromCache)
+        ShaderCache::Store(m_ID, m_CacheKey);
+    m_Uniforms.Build(m_ID);
+    m_State = ShaderState::Ready;
+
+#ifdef DEBUG
+    // Validation depends on the GL state at the time of the call, so this only catches the obvious
+    glValidateProgram(m_ID);
     GLint isValid;
-    glGetProgramiv(this->m_ID, GL_VALIDATE_STATUS, &isValid);
+    glGetProgramiv(m_ID, GL_VALIDATE_STATUS, &isValid);
     if (!isValid) {
         char infoLog[1024];
-        glGetProgramInfoLog(this->m_ID, 1024, NULL, infoLog);
-        GABGL_ERROR("ERROR::PROGRAM_VALIDATION_ERROR: ", infoLog);
+        glGetProgramInfoLog(m_ID, 1024, NULL, infoLog);
+        GABGL_ERROR("ERROR::PROGRAM_VALIDATION_ERROR: {0}", infoLog);
     }
+#endif
 
-    // Delete shaders as they are now linked
-    if (vertex != 0) glDeleteShader(vertex);
-    if (fragment != 0) glDeleteShader(fragment);
-    if (geometry != 0) glDeleteShader(geometry);
-    if (tessControl != 0) glDeleteShader(tessControl);
-    if (tessEvaluation != 0) glDeleteShader(tessEvaluation);
-    if (compute != 0) glDeleteShader(compute);
+    float milliseconds = m_LoadTimer.ElapsedMillis();
+    ShaderCache::RecordCreation(m_FromCache, milliseconds);
+    GABGL_WARN("Shader {0} {1} in {2} ms", m_Name, m_FromCache ? "loaded from cache" : m_FromSpirv ? "linked from SPIR-V" : "compiled", milliseconds);
 }
 
-void Shader::Load(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+Handle<Shader> Shader::Create(const char* fullshader)
+{
+    Handle<Shader> shader = CreateHandle<Shader>(fullshader);
+    Track(shader);
+    return shader;
+}
+
+Handle<Shader> Shader::Create(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+    Handle<Shader> shader = CreateHandle<Shader>(vertexPath, fragmentPath, geometryPath);
+    Track(shader);
+    return shader;
+}
+
+Handle<Shader> Shader::CreateAsync(const char* fullshader)
+{
+    Handle<Shader> shader = CreateHandle<Shader>();
+    shader->Submit(fullshader);
+    s_Data.Pending.push_back(shader);
+    Track(shader);
+    return shader;
+}
+
+Handle<Shader> Shader::GetVariant(Handle<Shader> handle, uint32_t mask)
 {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
-
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+    Shader* shader = handle.Get();
+    if (shader && shader->m_Fallback)
     {
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
+        handle = shader->m_Fallback;
+        shader = handle.Get();
+    }
+    if (!shader || shader->m_SourcePaths.empty())
+        return handle;
+
+    uint32_t keywordBits = Utils::KeywordBits(shader->m_VariantKeywords);
+    mask &= keywordBits;
+    if (mask == (shader->m_VariantMask & keywordBits))
+        return handle;
+
+    auto cached = shader->m_Variants.find(mask);
+    if (cached != shader->m_Variants.end() && cached->second)
+        return cached->second;
+
+    // Different defines give a different source, so the program cache keeps one binary per variant
+    Handle<Shader> variant = CreateHandle<Shader>();
+    variant->m_VariantMask = mask;
+    variant->m_Fallback = handle;
+    variant->SubmitPaths(shader->m_SourcePaths);
+    variant->m_Name += " [" + ShaderVariant::MaskToString(shader->m_VariantKeywords, mask) + "]";
+    s_Data.Pending.push_back(variant);
+    Track(variant);
+
+    shader->m_Variants[mask] = variant;
+    return variant;
+}
 
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
+void Shader::Track(Handle<Shader> shader)
+{
+    s_Data.Tracked.push_back(shader);
+    for (const auto& dependency : shader->m_Dependencies)
+        FileWatcher::Watch(dependency);
+}
 
-        vShaderFile.close();
-        fShaderFile.close();
+void Shader::InitCompiler()
+{
+    if (GLAD_GL_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        s_Data.ParallelCompile = true;
+    }
+    else if (GLAD_GL_ARB_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        s_Data.ParallelCompile = true;
+    }
+
+    s_Data.Spirv = GLAD_GL_ARB_gl_spirv;
+
+    s_Data.Placeholder = CreateScope<Shader>();
+    s_Data.Placeholder->m_Name = "Placeholder";
+    s_Data.Placeholder->SubmitSource(Utils::s_PlaceholderSource);
+    s_Data.Placeholder->Finish();
+}
 
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+void Shader::SetSpecializationConstant(uint32_t constantID, uint32_t value)
+{
+    s_Data.SpecializationConstants[constantID] = value;
+}
 
-        if (geometryPath != nullptr)
+void Shader::SetSpecializationConstant(uint32_t constantID, float value)
+{
+    s_Data.SpecializationConstants[constantID] = std::bit_cast<uint32_t>(value);
+}
+
+void Shader::ShutdownCompiler()
+{
+    s_Data.Pending.clear();
+    s_Data.Tracked.clear();
+    s_Data.Reloading.clear();
+    s_Data.Placeholder.reset();
+}
+
+uint32_t Shader::PollPending()
+{
+    for (size_t i = 0; i < s_Data.Reloading.size();)
+    {
+        Shader* shader = s_Data.Reloading[i].Get();
+        if (shader && shader->m_Reload && !shader->m_Reload->IsCompileComplete())
         {
-            gShaderFile.open(geometryPath);
-            std::stringstream gShaderStream;
-            gShaderStream << gShaderFile.rdbuf();
-            gShaderFile.close();
-            geometryCode = gShaderStream.str();
+            i++;
+            continue;
         }
+
+        if (shader && shader->m_Reload)
+        {
+            Shader& reload = *shader->m_Reload;
+            reload.Finish();
+            if (reload.IsReady())
+            {
+                // Between frames on the GL thread, so draws see either the old program or the new one.
+                // The old program goes away with the temporary, GL defers the delete until it is idle.
+                std::swap(shader->m_ID, reload.m_ID);
+                std::swap(shader->m_Uniforms, reload.m_Uniforms);
+                std::swap(shader->m_Dependencies, reload.m_Dependencies);
+                std::swap(shader->m_VariantKeywords, reload.m_VariantKeywords);
+                shader->m_FromCache = reload.m_FromCache;
+                shader->m_FromSpirv = reload.m_FromSpirv;
+                shader->m_CacheKey = reload.m_CacheKey;
+                shader->m_State = ShaderState::Ready;
+                for (const auto& dependency : shader->m_Dependencies)
+                    FileWatcher::Watch(dependency);
+                GABGL_INFO("Shader {0} reloaded", shader->m_Name);
+            }
+            else
+                GABGL_ERROR("Shader {0} failed to reload, keeping the previous program", shader->m_Name);
+            shader->m_Reload.reset();
+        }
+
+        s_Data.Reloading[i] = s_Data.Reloading.back();
+        s_Data.Reloading.pop_back();
     }
-    catch (std::ifstream::failure& e)
+
+    if (s_Data.Pending.empty())
+        return 0;
+
+    for (size_t i = 0; i < s_Data.Pending.size();)
     {
-        GABGL_WARN("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: ", e.what());
+        Shader* shader = s_Data.Pending[i].Get();
+        if (shader && !shader->IsCompileComplete())
+        {
+            i++;
+            continue;
+        }
+
+        if (shader)
+            shader->Finish();
+        s_Data.Pending[i] = s_Data.Pending.back();
+        s_Data.Pending.pop_back();
     }
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
 
-    GLuint vertex, fragment;
+    if (s_Data.Pending.empty())
+        Utils::LogShaderCacheSummary();
 
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+    return (uint32_t)s_Data.Pending.size();
+}
 
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+void Shader::Reload(Handle<Shader> handle)
+{
+    Shader* shader = handle.Get();
+    if (!shader || shader->m_SourcePaths.empty())
+        return;
 
-    unsigned int geometry;
-    if (geometryPath != nullptr)
+    // Still on its first build, finish it so the two programs can't get mixed up
+    shader->Finish();
+
+    if (std::find(s_Data.Reloading.begin(), s_Data.Reloading.end(), handle) == s_Data.Reloading.end())
+        s_Data.Reloading.push_back(handle);
+
+    shader->m_Reload = CreateScope<Shader>();
+    shader->m_Reload->m_VariantMask = shader->m_VariantMask;
+    shader->m_Reload->SubmitPaths(shader->m_SourcePaths);
+}
+
+void Shader::ReloadAll()
+{
+    for (auto handle : s_Data.Tracked)
+        Reload(handle);
+}
+
+void Shader::OnFilesChanged(const std::vector<std::string>& changedFiles)
+{
+    if (!s_Data.HotReload)
+        return;
+
+    for (size_t i = 0; i < s_Data.Tracked.size();)
     {
-        const char* gShaderCode = geometryCode.c_str();
-        geometry = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometry, 1, &gShaderCode, NULL);
-        glCompileShader(geometry);
-        checkCompileErrors(geometry, "GEOMETRY");
+        Shader* shader = s_Data.Tracked[i].Get();
+        if (!shader)
+        {
+            s_Data.Tracked[i] = s_Data.Tracked.back();
+            s_Data.Tracked.pop_back();
+            continue;
+        }
+
+        for (const auto& dependency : shader->m_Dependencies)
+        {
+            if (std::find(changedFiles.begin(), changedFiles.end(), dependency) != changedFiles.end())
+            {
+                GABGL_INFO("{0} changed, reloading shader {1}", dependency, shader->m_Name);
+                Reload(s_Data.Tracked[i]);
+                break;
+            }
+        }
+        i++;
     }
+}
 
-    this->m_ID = glCreateProgram();
-    glAttachShader(this->m_ID, vertex);
-    glAttachShader(this->m_ID, fragment);
-    if (geometryPath != nullptr)
-        glAttachShader(this->m_ID, geometry);
-    glLinkProgram(this->m_ID);
-    checkCompileErrors(this->m_ID, "PROGRAM");
+void Shader::SetHotReload(bool enabled)
+{
+    s_Data.HotReload = enabled;
+}
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    if (geometryPath != nullptr)
-        glDeleteShader(geometry);
+bool Shader::IsHotReloadEnabled()
+{
+    return s_Data.HotReload;
+}
+
+std::string Shader::Preprocess(const std::string& path, const std::string& source, std::vector<std::string>& dependencies)
+{
+    std::string normalizedPath = FileWatcher::NormalizePath(path);
+    if (std::find(dependencies.begin(), dependencies.end(), normalizedPath) == dependencies.end())
+        dependencies.push_back(normalizedPath);
+
+    if (source.find("#include") == std::string::npos)
+        return source;
+
+    std::string output;
+    output.reserve(source.size());
+    std::vector<std::string> includeStack;
+    Utils::ExpandIncludes(normalizedPath, source, dependencies, includeStack, output);
+    return output;
+}
+
+void Shader::WaitForPending()
+{
+    if (s_Data.Pending.empty())
+        return;
+
+    for (auto handle : s_Data.Pending)
+    {
+        if (Shader* shader = handle.Get())
+            shader->Finish();
+    }
+    s_Data.Pending.clear();
+
+    Utils::LogShaderCacheSummary();
+}
+
+std::unordered_map<std::string, std::string> Shader::ParseSources(const std::string& fileContent)
+{
+    // Parse the shader file into sections based on #type
+    std::unordered_map<std::string, std::string> shaderSources;
+    const std::string typeToken = "#type";
+    size_t pos = 0;
+    while ((pos = fileContent.find(typeToken, pos)) != std::string::npos) {
+        size_t endOfLine = fileContent.find('\n', pos);
+        std::string type = fileContent.substr(pos + typeToken.length(), endOfLine - pos - typeToken.length());
+        type = type.substr(type.find_first_not_of(" \t\r\n")); // Trim leading whitespace
+        type = type.substr(0, type.find_last_not_of(" \t\r\n") + 1); // Trim trailing whitespace
+        // Section types are case-insensitive, "#type vertex" and "#type VERTEX" are the same stage
+        std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+
+        size_t nextTypePos = fileContent.find(typeToken, endOfLine + 1);
+        if (nextTypePos == std::string::npos)
+            nextTypePos = fileContent.size();
+
+        std::string source = fileContent.substr(endOfLine + 1, nextTypePos - endOfLine - 1);
+        shaderSources[type] = source;
+
+        pos = nextTypePos;
+    }
+
+    return shaderSources;
 }
 
 void Shader::Use() const
 {
-    glUseProgram(this->m_ID);
+    if (m_State == ShaderState::Ready)
+        RendererAPI::UseProgram(m_ID);
+    else if (const Shader* fallback = m_Fallback.Get(); fallback && fallback->IsReady())
+        RendererAPI::UseProgram(fallback->m_ID);
+    else
+        RendererAPI::UseProgram(s_Data.Placeholder && s_Data.Placeholder->IsReady() ? s_Data.Placeholder->m_ID : 0);
 }
 
 GLuint Shader::getID() const
@@ -220,59 +733,64 @@ GLuint Shader::getID() const
     return this->m_ID;
 }
 
-void Shader::setBool(const std::string& name, bool value) const
+void Shader::setBool(UniformName name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(this->m_ID, name.c_str()), (int)value);
+    glUniform1i(GetUniforms().Find(name), (int)value);
 }
 
-void Shader::setInt(const std::string& name, int value) const
+void Shader::setInt(UniformName name, int value) const
 {
-    glUniform1i(glGetUniformLocation(this->m_ID, name.c_str()), value);
+    glUniform1i(GetUniforms().Find(name), value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const
+void Shader::setFloat(UniformName name, float value) const
 {
-    glUniform1f(glGetUniformLocation(this->m_ID, name.c_str()), value);
+    glUniform1f(GetUniforms().Find(name), value);
 }
 
-void Shader::setVec2(const std::string& name, const glm::vec2& value) const
+void Shader::setVec2(UniformName name, const glm::vec2& value) const
 {
-    glUniform2fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(GetUniforms().Find(name), 1, &value[0]);
 }
-void Shader::setVec2(const std::string& name, float x, float y) const
+void Shader::setVec2(UniformName name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(this->m_ID, name.c_str()), x, y);
+    glUniform2f(GetUniforms().Find(name), x, y);
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3& value) const
+void Shader::setVec3(UniformName name, const glm::vec3& value) const
 {
-    glUniform3fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(GetUniforms().Find(name), 1, &value[0]);
 }
-void Shader::setVec3(const std::string& name, float x, float y, float z) const
+void Shader::setVec3(UniformName name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(this->m_ID, name.c_str()), x, y, z);
+    glUniform3f(GetUniforms().Find(name), x, y, z);
 }
 
-void Shader::setVec4(const std::string& name, const glm::vec4& value) const
+void Shader::setVec4(UniformName name, const glm::vec4& value) const
 {
-    glUniform4fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(GetUniforms().Find(name), 1, &value[0]);
 }
-void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const
+void Shader::setVec4(UniformName name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(this->m_ID, name.c_str()), x, y, z, w);
+    glUniform4f(GetUniforms().Find(name), x, y, z, w);
 }
 
-void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
+void Shader::setMat2(UniformName name, const glm::mat2& mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(GetUniforms().Find(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
+void Shader::setMat3(UniformName name, const glm::mat3& mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(GetUniforms().Find(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
+void Shader::setMat4(UniformName name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-}
\ No newline at end of file
+    glUniformMatrix4fv(GetUniforms().Find(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setMat4Array(UniformName name, const glm::mat4* mats, uint32_t count) const
+{
+    glUniformMatrix4fv(GetUniforms().Find(name), (GLsizei)count, GL_FALSE, &mats[0][0][0]);
+}
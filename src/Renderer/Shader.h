@@ -5,39 +5,140 @@
 #include <string>
 #include <fstream>
 #include <sstream>
-#include <iostream>
 #include <unordered_map>
-#include "../Backend/BackendScopeRef.h"
+#include <vector>
+#include "../Backend/BackendLogger.h"
+#include "../Backend/ResourcePool.h"
+#include "UniformCache.h"
+#include "ShaderVariant.h"
+
+enum class ShaderState : uint8_t
+{
+    Empty = 0,
+    Compiling,
+    Ready,
+    Failed
+};
 
 struct Shader
 {
+    Shader() = default;
     Shader(const char* fullshader);
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
-    ~Shader() = default;
+    ~Shader();
 
+    // Blocking, same as Submit() followed by Finish()
     void Load(const char* fullshader);
     void Load(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+
+    // Hands every stage and the link to the driver without reading any status back
+    void Submit(const char* fullshader);
+    void Submit(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    // Non-blocking when the driver exposes KHR_parallel_shader_compile, otherwise always true
+    bool IsCompileComplete() const;
+    // Reads back compile/link results, blocks if the driver is still busy
+    void Finish();
+
+    ShaderState GetState() const { return m_State; }
+    bool IsReady() const { return m_State == ShaderState::Ready; }
+
+    // Keywords from the source's "#pragma variant" lines, bit i of a mask is keyword i
+    const std::vector<std::string>& GetVariantKeywords() const { return m_VariantKeywords; }
+    uint32_t GetVariantMask() const { return m_VariantMask; }
+    uint32_t GetVariantMask(std::initializer_list<std::string_view> keywords) const { return ShaderVariant::GetMask(m_VariantKeywords, keywords); }
+
+    // Splits a combined shader file into its "#type" sections keyed by the upper-case type, no GL involved
+    static std::unordered_map<std::string, std::string> ParseSources(const std::string& fileContent);
+    // Expands #include "file" relative to the including file, guard shared files with #ifndef.
+    // Every file read, including path itself, is appended to dependencies.
+    static std::string Preprocess(const std::string& path, const std::string& source, std::vector<std::string>& dependencies);
+
+    // Binds the placeholder program until the shader is ready
     void Use() const;
     GLuint getID() const;
+    bool IsFromCache() const { return m_FromCache; }
+    bool IsFromSpirv() const { return m_FromSpirv; }
 
-    void setBool(const std::string& name, bool value) const;
-    void setInt(const std::string& name, int value) const;
-    void setFloat(const std::string& name, float value) const;
-    void setVec2(const std::string& name, const glm::vec2& value) const;
-    void setVec2(const std::string& name, float x, float y) const;
-    void setVec3(const std::string& name, const glm::vec3& value) const;
-    void setVec3(const std::string& name, float x, float y, float z) const;
-    void setVec4(const std::string& name, const glm::vec4& value) const;
-    void setVec4(const std::string& name, float x, float y, float z, float w) const;
-    void setMat2(const std::string& name, const glm::mat2& mat) const;
-    void setMat3(const std::string& name, const glm::mat3& mat) const;
-    void setMat4(const std::string& name, const glm::mat4& mat) const;
+    // Locations come from the table built at link time, literals are hashed at compile time
+    void setBool(UniformName name, bool value) const;
+    void setInt(UniformName name, int value) const;
+    void setFloat(UniformName name, float value) const;
+    void setVec2(UniformName name, const glm::vec2& value) const;
+    void setVec2(UniformName name, float x, float y) const;
+    void setVec3(UniformName name, const glm::vec3& value) const;
+    void setVec3(UniformName name, float x, float y, float z) const;
+    void setVec4(UniformName name, const glm::vec4& value) const;
+    void setVec4(UniformName name, float x, float y, float z, float w) const;
+    void setMat2(UniformName name, const glm::mat2& mat) const;
+    void setMat3(UniformName name, const glm::mat3& mat) const;
+    void setMat4(UniformName name, const glm::mat4& mat) const;
+    void setMat4Array(UniformName name, const glm::mat4* mats, uint32_t count) const;
+    GLint getUniformLocation(UniformName name) const { return GetUniforms().Find(name); }
     
-    static Ref<Shader> Create(const char* fullshader) { return CreateRef<Shader>(fullshader); };
-    static Ref<Shader> Create(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr) { return CreateRef<Shader>(vertexPath,fragmentPath,geometryPath); }
+    // Shaders created through these are watched for hot reload
+    static Handle<Shader> Create(const char* fullshader);
+    static Handle<Shader> Create(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    // Submits and returns right away, PollPending() finishes the shader once the driver is done
+    static Handle<Shader> CreateAsync(const char* fullshader);
+    // Compiled on first request and kept per mask. Until it is ready the variant draws
+    // with the all-features shader it came from.
+    static Handle<Shader> GetVariant(Handle<Shader> shader, uint32_t mask);
+
+    // Applies to every cooked SPIR-V stage declaring layout(constant_id = constantID), set them
+    // before shaders are created. The GLSL fallback keeps the defaults written in the source.
+    static void SetSpecializationConstant(uint32_t constantID, uint32_t value);
+    static void SetSpecializationConstant(uint32_t constantID, float value);
+
+    static void InitCompiler();
+    static void ShutdownCompiler();
+    // Call once per frame, returns how many shaders are still compiling
+    static uint32_t PollPending();
+    static void WaitForPending();
+
+    // Rebuilds from the same files in the background, the running program is kept until the new one links
+    static void Reload(Handle<Shader> shader);
+    static void ReloadAll();
+    // Reloads only the shaders that read one of the changed files
+    static void OnFilesChanged(const std::vector<std::string>& changedFiles);
+    static void SetHotReload(bool enabled);
+    static bool IsHotReloadEnabled();
 private:
+    static void Track(Handle<Shader> shader);
+    void SubmitPaths(const std::vector<std::string>& paths);
+    void SubmitSource(const std::string& fileContent);
+    bool LoadFromCache(uint64_t cacheKey);
+    bool SubmitSpirv(const std::string& fileContent);
+    void SubmitStages(const std::unordered_map<std::string, std::string>& shaderSources);
+
+    struct PendingStage
+    {
+        GLuint ID;
+        const char* Type;
+    };
 
-    GLuint m_ID;
+    GLuint m_ID = 0;
+    UniformCache m_Uniforms;
+    bool m_FromCache = false;
+    bool m_FromSpirv = false;
+    ShaderState m_State = ShaderState::Empty;
+    uint64_t m_CacheKey = 0;
+    std::vector<PendingStage> m_PendingStages;
+    std::string m_Name;
+    Timer m_LoadTimer;
+    std::vector<std::string> m_SourcePaths;
+    std::vector<std::string> m_Dependencies;
+    Scope<Shader> m_Reload;
+    std::vector<std::string> m_VariantKeywords;
+    uint32_t m_VariantMask = ShaderVariant::AllVariants;
+    std::unordered_map<uint32_t, Handle<Shader>> m_Variants;
+    Handle<Shader> m_Fallback;
+
+    // A variant still compiling sets uniforms on the shader it falls back to
+    const UniformCache& GetUniforms() const
+    {
+        const Shader* fallback = m_State != ShaderState::Ready ? m_Fallback.Get() : nullptr;
+        return fallback ? fallback->m_Uniforms : m_Uniforms;
+    }
 
     inline void checkCompileErrors(GLuint shader, std::string type)
     {
@@ -49,7 +150,7 @@ private:
             if (!success)
             {
                 glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+                GABGL_ERROR("Shader compilation error of type {0}:\n{1}", type, infoLog);
             }
         }
         else
@@ -58,7 +159,7 @@ private:
             if (!success)
             {
                 glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+                GABGL_ERROR("Program linking error of type {0}:\n{1}", type, infoLog);
             }
         }
     }
@@ -0,0 +1,194 @@
+#include "ShaderCache.h"
+#include "../Backend/BackendLogger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Utils {
+
+	static constexpr uint32_t CacheMagic = 0x43534247; // "GBSC"
+	static constexpr uint32_t CacheVersion = 1;
+
+	struct CacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t Format;
+		uint32_t Length;
+	};
+
+	static uint64_t HashBytes(uint64_t hash, std::string_view bytes)
+	{
+		for (char c : bytes)
+		{
+			hash ^= (uint8_t)c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static const char* GetGLString(GLenum name)
+	{
+		const char* value = reinterpret_cast<const char*>(glGetString(name));
+		return value ? value : "";
+	}
+}
+
+struct ShaderCacheData
+{
+	bool Enabled = false;
+	std::filesystem::path Directory;
+	uint64_t DriverHash = 0;
+
+	ShaderCache::Statistics Stats;
+};
+
+static ShaderCacheData s_Data;
+
+static std::filesystem::path GetCachePath(uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return s_Data.Directory / name;
+}
+
+void ShaderCache::Init(const std::string& directory)
+{
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	if (formatCount == 0)
+	{
+		GABGL_WARN("Driver exposes no program binary formats, shader cache disabled");
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error)
+	{
+		GABGL_WARN("Could not create shader cache directory {0}: {1}", directory, error.message());
+		return;
+	}
+
+	s_Data.Directory = directory;
+	s_Data.DriverHash = 14695981039346656037ull;
+	s_Data.DriverHash = Utils::HashBytes(s_Data.DriverHash, Utils::GetGLString(GL_VENDOR));
+	s_Data.DriverHash = Utils::HashBytes(s_Data.DriverHash, Utils::GetGLString(GL_RENDERER));
+	s_Data.DriverHash = Utils::HashBytes(s_Data.DriverHash, Utils::GetGLString(GL_VERSION));
+	s_Data.Enabled = true;
+}
+
+bool ShaderCache::IsEnabled()
+{
+	return s_Data.Enabled;
+}
+
+uint64_t ShaderCache::ComputeKey(std::string_view source)
+{
+	return Utils::HashBytes(s_Data.DriverHash, source);
+}
+
+void ShaderCache::PrepareProgram(GLuint program)
+{
+	if (s_Data.Enabled)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool ShaderCache::Load(GLuint program, uint64_t key)
+{
+	if (!s_Data.Enabled)
+		return false;
+
+	std::ifstream file(GetCachePath(key), std::ios::binary);
+	if (!file.is_open())
+	{
+		s_Data.Stats.Misses++;
+		return false;
+	}
+
+	Utils::CacheHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	std::vector<char> binary;
+	if (file && header.Magic == Utils::CacheMagic && header.Version == Utils::CacheVersion && header.Key == key)
+	{
+		binary.resize(header.Length);
+		file.read(binary.data(), header.Length);
+	}
+
+	GLint linked = GL_FALSE;
+	if (file && !binary.empty())
+	{
+		glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size());
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	}
+
+	if (!linked)
+	{
+		// Stale or truncated, the driver may also reject binaries after an update with the same strings
+		file.close();
+		std::error_code error;
+		std::filesystem::remove(GetCachePath(key), error);
+		s_Data.Stats.Rejected++;
+		return false;
+	}
+
+	s_Data.Stats.Hits++;
+	return true;
+}
+
+void ShaderCache::Store(GLuint program, uint64_t key)
+{
+	if (!s_Data.Enabled)
+		return;
+
+	GLint linked = GL_FALSE, length = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (!linked || length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	Utils::CacheHeader header{ Utils::CacheMagic, Utils::CacheVersion, key, format, (uint32_t)length };
+
+	// Write next to the final file and rename, a crash mid-write must not leave a truncated binary behind
+	std::filesystem::path path = GetCachePath(key);
+	std::filesystem::path tempPath = path;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			GABGL_WARN("Could not write shader cache entry {0}", tempPath.string());
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), length);
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+		GABGL_WARN("Could not write shader cache entry {0}: {1}", path.string(), error.message());
+}
+
+void ShaderCache::RecordCreation(bool fromCache, float milliseconds)
+{
+	if (fromCache)
+		s_Data.Stats.WarmMs += milliseconds;
+	else
+	{
+		s_Data.Stats.ColdMs += milliseconds;
+		s_Data.Stats.Compiled++;
+	}
+}
+
+const ShaderCache::Statistics& ShaderCache::GetStats()
+{
+	return s_Data.Stats;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Program binaries on disk, one file per key. The key covers the shader source and
+// the GL vendor/renderer/version strings, so a driver update just misses the cache.
+struct ShaderCache
+{
+	static void Init(const std::string& directory = "shader_cache");
+
+	static bool IsEnabled();
+	static uint64_t ComputeKey(std::string_view source);
+
+	// Call before glLinkProgram so the driver keeps the binary around
+	static void PrepareProgram(GLuint program);
+	// Returns false and leaves the program unlinked when there is no usable binary
+	static bool Load(GLuint program, uint64_t key);
+	static void Store(GLuint program, uint64_t key);
+
+	struct Statistics
+	{
+		uint32_t Hits = 0;
+		uint32_t Misses = 0;
+		uint32_t Rejected = 0;
+		uint32_t Compiled = 0;
+		float WarmMs = 0.0f;
+		float ColdMs = 0.0f;
+	};
+
+	// Creation time of a whole Shader, split by whether it came from the cache
+	static void RecordCreation(bool fromCache, float milliseconds);
+	static const Statistics& GetStats();
+};
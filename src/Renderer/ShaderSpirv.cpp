@@ -0,0 +1,128 @@
+#include "ShaderSpirv.h"
+#include "../Backend/BackendLogger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace Utils {
+
+	static constexpr uint32_t SpirvMagic = 0x56534247; // "GBSV"
+	static constexpr uint32_t SpirvVersion = 1;
+
+	struct SpirvHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t SourceHash;
+		uint32_t StageCount;
+	};
+
+	struct SpirvStageHeader
+	{
+		uint32_t Type;
+		uint32_t ConstantCount;
+		uint32_t WordCount;
+	};
+
+	// Guards against a truncated or foreign file asking for a huge allocation
+	static constexpr uint32_t MaxStages = 6;
+	static constexpr uint32_t MaxConstants = 256;
+	static constexpr uint32_t MaxWords = 16 * 1024 * 1024;
+}
+
+uint64_t ShaderSpirv::HashSource(std::string_view source)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : source)
+	{
+		hash ^= (uint8_t)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::string ShaderSpirv::GetCookedPath(const std::string& shaderPath)
+{
+	std::filesystem::path path(shaderPath);
+	return (path.parent_path() / "cooked" / path.stem()).string() + ".spv";
+}
+
+std::vector<uint32_t> ShaderSpirv::FindConstantIDs(const std::string& source)
+{
+	std::vector<uint32_t> constantIDs;
+	const std::string token = "constant_id";
+	size_t pos = 0;
+	while ((pos = source.find(token, pos)) != std::string::npos)
+	{
+		pos += token.size();
+		size_t value = source.find_first_not_of(" \t=", pos);
+		if (value == std::string::npos || source[value] < '0' || source[value] > '9')
+			continue;
+
+		uint32_t id = (uint32_t)std::stoul(source.substr(value, 10));
+		if (std::find(constantIDs.begin(), constantIDs.end(), id) == constantIDs.end())
+			constantIDs.push_back(id);
+	}
+	return constantIDs;
+}
+
+bool ShaderSpirv::Read(const std::string& path, Program& program)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	Utils::SpirvHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.Magic != Utils::SpirvMagic || header.Version != Utils::SpirvVersion || header.StageCount > Utils::MaxStages)
+	{
+		GABGL_WARN("Ignoring cooked shader {0}, unknown format", path);
+		return false;
+	}
+
+	program.SourceHash = header.SourceHash;
+	program.Stages.resize(header.StageCount);
+	for (auto& stage : program.Stages)
+	{
+		Utils::SpirvStageHeader stageHeader{};
+		file.read(reinterpret_cast<char*>(&stageHeader), sizeof(stageHeader));
+		if (!file || stageHeader.ConstantCount > Utils::MaxConstants || stageHeader.WordCount > Utils::MaxWords)
+			break;
+
+		stage.Type = stageHeader.Type;
+		stage.ConstantIDs.resize(stageHeader.ConstantCount);
+		stage.Code.resize(stageHeader.WordCount);
+		file.read(reinterpret_cast<char*>(stage.ConstantIDs.data()), stageHeader.ConstantCount * sizeof(uint32_t));
+		file.read(reinterpret_cast<char*>(stage.Code.data()), stageHeader.WordCount * sizeof(uint32_t));
+	}
+
+	if (!file)
+	{
+		GABGL_WARN("Ignoring cooked shader {0}, file is truncated", path);
+		program.Stages.clear();
+		return false;
+	}
+	return true;
+}
+
+bool ShaderSpirv::Write(const std::string& path, const Program& program)
+{
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	Utils::SpirvHeader header{ Utils::SpirvMagic, Utils::SpirvVersion, program.SourceHash, (uint32_t)program.Stages.size() };
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const auto& stage : program.Stages)
+	{
+		Utils::SpirvStageHeader stageHeader{ stage.Type, (uint32_t)stage.ConstantIDs.size(), (uint32_t)stage.Code.size() };
+		file.write(reinterpret_cast<const char*>(&stageHeader), sizeof(stageHeader));
+		file.write(reinterpret_cast<const char*>(stage.ConstantIDs.data()), stage.ConstantIDs.size() * sizeof(uint32_t));
+		file.write(reinterpret_cast<const char*>(stage.Code.data()), stage.Code.size() * sizeof(uint32_t));
+	}
+	return (bool)file;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// SPIR-V cooked offline by gl_shader_cooker, one file per .glsl next to it in cooked/<name>.spv.
+// The file carries a hash of the preprocessed GLSL it was built from, an edited shader
+// misses until it is cooked again and meanwhile compiles from source.
+struct ShaderSpirv
+{
+	struct Stage
+	{
+		GLenum Type = 0;
+		std::vector<uint32_t> ConstantIDs; // layout(constant_id = N) declared by the stage
+		std::vector<uint32_t> Code;
+	};
+
+	struct Program
+	{
+		uint64_t SourceHash = 0;
+		std::vector<Stage> Stages;
+	};
+
+	// FNV-1a over the source only, unlike the program cache key nothing about the driver goes in
+	static uint64_t HashSource(std::string_view source);
+	static std::string GetCookedPath(const std::string& shaderPath);
+	static std::vector<uint32_t> FindConstantIDs(const std::string& source);
+
+	static bool Read(const std::string& path, Program& program);
+	static bool Write(const std::string& path, const Program& program);
+};
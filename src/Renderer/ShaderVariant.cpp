@@ -0,0 +1,122 @@
+#include "ShaderVariant.h"
+#include "../Backend/BackendLogger.h"
+
+#include <algorithm>
+
+namespace Utils {
+
+	static constexpr std::string_view s_VariantPragma = "#pragma variant";
+
+	// Calls func(lineStart, lineEnd, firstNonBlank) for every line of source
+	template<typename Func>
+	static void ForEachLine(const std::string& source, Func&& func)
+	{
+		size_t lineStart = 0;
+		while (lineStart < source.size())
+		{
+			size_t lineEnd = source.find('\n', lineStart);
+			if (lineEnd == std::string::npos)
+				lineEnd = source.size();
+
+			func(lineStart, lineEnd, std::min(source.find_first_not_of(" \t", lineStart), lineEnd));
+			lineStart = lineEnd + 1;
+		}
+	}
+}
+
+std::vector<std::string> ShaderVariant::ParseKeywords(const std::string& source)
+{
+	std::vector<std::string> keywords;
+	if (source.find(Utils::s_VariantPragma) == std::string::npos)
+		return keywords;
+
+	Utils::ForEachLine(source, [&](size_t lineStart, size_t lineEnd, size_t text)
+	{
+		if (source.compare(text, Utils::s_VariantPragma.size(), Utils::s_VariantPragma) != 0)
+			return;
+
+		size_t pos = text + Utils::s_VariantPragma.size();
+		while (pos < lineEnd)
+		{
+			size_t wordStart = source.find_first_not_of(" \t\r", pos);
+			if (wordStart >= lineEnd)
+				break;
+			size_t wordEnd = std::min(source.find_first_of(" \t\r\n", wordStart), lineEnd);
+			pos = wordEnd;
+
+			std::string keyword = source.substr(wordStart, wordEnd - wordStart);
+			if (std::find(keywords.begin(), keywords.end(), keyword) != keywords.end())
+				continue;
+			if (keywords.size() == MaxKeywords)
+			{
+				GABGL_ERROR("More than {0} variant keywords, {1} is ignored", MaxKeywords, keyword);
+				continue;
+			}
+			keywords.push_back(std::move(keyword));
+		}
+	});
+
+	return keywords;
+}
+
+std::string ShaderVariant::InjectDefines(const std::string& source, const std::vector<std::string>& keywords, uint32_t mask)
+{
+	std::string defines;
+	for (uint32_t i = 0; i < keywords.size(); i++)
+	{
+		if (mask & (1u << i))
+			defines += "#define " + keywords[i] + " 1\n";
+	}
+
+	std::string output;
+	output.reserve(source.size() + defines.size() * 2);
+	bool injected = false;
+
+	Utils::ForEachLine(source, [&](size_t lineStart, size_t lineEnd, size_t text)
+	{
+		// Blanked rather than dropped, unknown pragmas make some drivers warn
+		if (source.compare(text, Utils::s_VariantPragma.size(), Utils::s_VariantPragma) == 0)
+		{
+			output += '\n';
+			return;
+		}
+
+		output.append(source, lineStart, lineEnd - lineStart);
+		output += '\n';
+
+		// #version has to stay first, every "#type" stage carries its own
+		if (source.compare(text, 8, "#version") == 0)
+		{
+			output += defines;
+			injected = true;
+		}
+	});
+
+	return injected ? output : defines + output;
+}
+
+uint32_t ShaderVariant::GetMask(const std::vector<std::string>& keywords, std::initializer_list<std::string_view> enabled)
+{
+	uint32_t mask = 0;
+	for (std::string_view keyword : enabled)
+	{
+		auto it = std::find(keywords.begin(), keywords.end(), keyword);
+		if (it != keywords.end())
+			mask |= 1u << (uint32_t)(it - keywords.begin());
+	}
+	return mask;
+}
+
+std::string ShaderVariant::MaskToString(const std::vector<std::string>& keywords, uint32_t mask)
+{
+	std::string names;
+	for (uint32_t i = 0; i < keywords.size(); i++)
+	{
+		if (!(mask & (1u << i)))
+			continue;
+		if (!names.empty())
+			names += '|';
+		names += keywords[i];
+	}
+	return names.empty() ? "base" : names;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Feature keywords are declared in the shader source:
+//     #pragma variant POINT_LIGHTS SPOT_LIGHTS
+// Bit i of a variant mask defines the i-th declared keyword as 1 after every #version line.
+// AllVariants is the all-features build, the one a plain Load() gives.
+struct ShaderVariant
+{
+	static constexpr uint32_t MaxKeywords = 32;
+	static constexpr uint32_t AllVariants = 0xFFFFFFFF;
+
+	// Keywords in declaration order, duplicates dropped
+	static std::vector<std::string> ParseKeywords(const std::string& source);
+	// Adds the defines for mask and blanks the #pragma variant lines
+	static std::string InjectDefines(const std::string& source, const std::vector<std::string>& keywords, uint32_t mask);
+
+	static uint32_t GetMask(const std::vector<std::string>& keywords, std::initializer_list<std::string_view> enabled);
+	static std::string MaskToString(const std::vector<std::string>& keywords, uint32_t mask);
+};
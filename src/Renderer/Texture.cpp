@@ -1,7 +1,21 @@
 #include "Texture.h"
+#include "ImageKernels.h"
+#include "RendererAPI.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
 #include "../Backend/BackendLogger.h"
+#include "../Backend/MemoryTracker.h"
+#include "../Backend/JobSystem.h"
+#include "../Backend/Profiler.h"
 #include <stb_image.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
 namespace Utils {
 
 	static GLenum ImageFormatToGLDataFormat(ImageFormat format)
@@ -16,6 +30,19 @@ namespace Utils {
 		return 0;
 	}
 
+	static uint32_t GLDataFormatBytesPerPixel(GLenum format)
+	{
+		switch (format)
+		{
+			case GL_RED:  return 1;
+			case GL_RG:   return 2;
+			case GL_RGB:  return 3;
+			case GL_RGBA: return 4;
+		}
+
+		return 4;
+	}
+
 	static GLenum ImageFormatToGLInternalFormat(ImageFormat format)
 	{
 		switch (format)
@@ -28,6 +55,167 @@ namespace Utils {
 		return 0;
 	}
 
+	static bool ChannelsToGLFormats(int channels, GLenum& internalFormat, GLenum& dataFormat)
+	{
+		switch (channels)
+		{
+			case 1: internalFormat = GL_R8;    dataFormat = GL_RED;  return true;
+			case 2: internalFormat = GL_RG8;   dataFormat = GL_RG;   return true;
+			case 3: internalFormat = GL_RGB8;  dataFormat = GL_RGB;  return true;
+			case 4: internalFormat = GL_RGBA8; dataFormat = GL_RGBA; return true;
+		}
+
+		return false;
+	}
+
+	static ImageFormat ChannelsToImageFormat(uint32_t channels)
+	{
+		switch (channels)
+		{
+			case 1: return ImageFormat::R8;
+			case 3: return ImageFormat::RGB8;
+			case 4: return ImageFormat::RGBA8;
+		}
+
+		return ImageFormat::None;
+	}
+
+	struct DecodedImage
+	{
+		Handle<Texture> Target;
+		std::string Path;
+		CookedTexture Cooked;
+		bool Valid = false;
+	};
+
+	// The flip flag is stb's per-thread state, set on every load so no load depends on another's setting
+	static stbi_uc* DecodeImage(const std::string& path, bool flipVertically, int& width, int& height, int& channels)
+	{
+		stbi_set_flip_vertically_on_load_thread(flipVertically);
+		return stbi_load(path.c_str(), &width, &height, &channels, 0);
+	}
+
+	// Cooked through the cache when it is enabled; without it nothing is compressed, cooking on every run would cost more than it saves
+	static TextureCookSettings GetCookSettings(bool flipVertically)
+	{
+		TextureCookSettings settings = TextureCooker::GetDefaultSettings();
+		settings.Compress = TextureCooker::IsEnabled();
+		settings.FlipVertically = flipVertically;
+		return settings;
+	}
+
+	static uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+	{
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+			levels++;
+		return levels;
+	}
+
+	static uint32_t CreateTextureStorage(uint32_t width, uint32_t height, GLenum internalFormat, uint32_t levels = 1)
+	{
+		uint32_t rendererID;
+		glCreateTextures(GL_TEXTURE_2D, 1, &rendererID);
+		glTextureStorage2D(rendererID, levels, internalFormat, width, height);
+
+		glTextureParameteri(rendererID, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTextureParameteri(rendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glTextureParameteri(rendererID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(rendererID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		return rendererID;
+	}
+
+}
+
+struct PendingUpload
+{
+	Utils::DecodedImage Image;
+	uint32_t RendererID = 0;
+	int64_t GPUMemory = 0;
+	uint32_t Level = 0;
+	uint32_t RowsUploaded = 0;
+	// Level GL level 0 holds, see TextureStreamer::CreateStorage()
+	uint32_t BaseLevel = 0;
+	bool Sparse = false;
+};
+
+// Workers push decoded images into Decoded, everything else is main thread only
+struct TextureLoaderData
+{
+	static constexpr uint32_t Segments = ResourcePools::FramesInFlight + 1;
+
+	std::mutex DecodedMutex;
+	std::vector<Utils::DecodedImage> Decoded;
+	std::atomic<uint32_t> Decoding{ 0 };
+
+	std::deque<PendingUpload> Uploads;
+	uint32_t Placeholder = 0;
+
+	uint32_t UploadBudget = Texture::DefaultUploadBudget;
+	uint32_t StagingBuffer = 0;
+	uint32_t SegmentSize = 0;
+	uint32_t Segment = 0;
+	uint8_t* StagingMapped = nullptr;
+	void* Fences[Segments] = {};
+};
+
+static TextureLoaderData s_Loader;
+
+namespace Utils {
+
+	static uint32_t GetPlaceholderTexture()
+	{
+		if (!s_Loader.Placeholder)
+		{
+			uint32_t grey = 0xFF808080;
+			s_Loader.Placeholder = CreateTextureStorage(1, 1, GL_RGBA8);
+			glTextureSubImage2D(s_Loader.Placeholder, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &grey);
+		}
+		return s_Loader.Placeholder;
+	}
+
+	static void WaitForFence(void*& fence)
+	{
+		if (!fence)
+			return;
+
+		if (glClientWaitSync((GLsync)fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+		{
+			GABGL_PROFILE_SCOPE("Texture::WaitForStaging");
+			while (glClientWaitSync((GLsync)fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+		}
+		glDeleteSync((GLsync)fence);
+		fence = nullptr;
+	}
+
+	// Same scheme as UniformRingBuffer: one segment per frame in flight, fenced after use
+	static void CreateStagingRing()
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		s_Loader.SegmentSize = s_Loader.UploadBudget;
+		glCreateBuffers(1, &s_Loader.StagingBuffer);
+		glNamedBufferStorage(s_Loader.StagingBuffer, (GLsizeiptr)s_Loader.SegmentSize * TextureLoaderData::Segments, nullptr, flags);
+		s_Loader.StagingMapped = (uint8_t*)glMapNamedBufferRange(s_Loader.StagingBuffer, 0, (GLsizeiptr)s_Loader.SegmentSize * TextureLoaderData::Segments, flags);
+		GABGL_ASSERT(s_Loader.StagingMapped, "Could not map the texture staging ring!");
+		MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Buffer, (int64_t)s_Loader.SegmentSize * TextureLoaderData::Segments);
+	}
+
+	static void DestroyStagingRing()
+	{
+		if (!s_Loader.StagingBuffer)
+			return;
+
+		for (void*& fence : s_Loader.Fences)
+			WaitForFence(fence);
+		glUnmapNamedBuffer(s_Loader.StagingBuffer);
+		glDeleteBuffers(1, &s_Loader.StagingBuffer);
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Buffer, (int64_t)s_Loader.SegmentSize * TextureLoaderData::Segments);
+		s_Loader.StagingBuffer = 0;
+		s_Loader.StagingMapped = nullptr;
+		s_Loader.SegmentSize = 0;
+	}
+
 }
 
 Texture::Texture(const TextureSpecification& specification)
@@ -35,70 +223,94 @@ Texture::Texture(const TextureSpecification& specification)
 {
 	m_InternalFormat = Utils::ImageFormatToGLInternalFormat(m_Specification.Format);
 	m_DataFormat = Utils::ImageFormatToGLDataFormat(m_Specification.Format);
+	m_MipLevels = m_Specification.GenerateMips ? Utils::GetMipLevelCount(m_Width, m_Height) : 1;
 
-	glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID);
-	glTextureStorage2D(m_RendererID, 1, m_InternalFormat, m_Width, m_Height);
-
-	glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	m_RendererID = Utils::CreateTextureStorage(m_Width, m_Height, m_InternalFormat, m_MipLevels);
 
-	glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	m_GPUMemory = MemoryTracker::GetTextureBytes(m_Width, m_Height, Utils::GLDataFormatBytesPerPixel(m_DataFormat), m_MipLevels);
+	MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, m_GPUMemory);
 }
 
 Texture::Texture(const std::string& path)
+	: Texture(path, TextureLoad::Blocking)
+{
+}
+
+Texture::Texture(const std::string& path, TextureLoad load, bool flipVertically)
 	: m_Path(path)
 {
-	int width, height, channels;
-	stbi_set_flip_vertically_on_load(1);
-	stbi_uc* data = nullptr;
+	GABGL_MEMORY_TAG(Assets);
+
+	if (load == TextureLoad::Async)
 	{
-		data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		m_IsPending = true;
+		m_RendererID = Utils::GetPlaceholderTexture();
+		return;
+	}
+
+	if (TextureCooker::IsEnabled())
+	{
+		CookedTexture cooked;
+		if (TextureCooker::LoadOrCook(path, Utils::GetCookSettings(flipVertically), cooked))
+		{
+			MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, (int64_t)cooked.Data.size());
+			SetCooked(cooked, cooked.CreateGLTexture(), (int64_t)cooked.Data.size());
+		}
+		return;
 	}
 
-	if (data)
+	int width, height, channels;
+	stbi_uc* pixels = Utils::DecodeImage(path, flipVertically, width, height, channels);
+	if (pixels)
 	{
-		m_RawData = data;
+		m_RawData = pixels;
 		m_IsLoaded = true;
 
 		m_Width = width;
 		m_Height = height;
 
-		GLenum internalFormat = 0, dataFormat = 0;
-		if (channels == 4)
-		{
-			internalFormat = GL_RGBA8;
-			dataFormat = GL_RGBA;
-		}
-		else if (channels == 3)
+		// Odd-width RGB rows break the default unpack alignment, and drivers pad 3-byte texels on upload anyway
+		std::vector<uint8_t> expanded;
+		const uint8_t* upload = pixels;
+		if (channels == 3)
 		{
-			internalFormat = GL_RGB8;
-			dataFormat = GL_RGB;
+			expanded.resize((size_t)width * height * 4);
+			ImageKernels::ExpandRGBToRGBA(pixels, expanded.data(), (size_t)width * height);
+			upload = expanded.data();
+			channels = 4;
 		}
 
+		GLenum internalFormat = 0, dataFormat = 0;
+		Utils::ChannelsToGLFormats(channels, internalFormat, dataFormat);
+
 		m_InternalFormat = internalFormat;
 		m_DataFormat = dataFormat;
 
 		GABGL_ASSERT(internalFormat & dataFormat, "Format not supported!");
 
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID);
-		glTextureStorage2D(m_RendererID, 1, internalFormat, m_Width, m_Height);
-
-		glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		m_RendererID = Utils::CreateTextureStorage(m_Width, m_Height, internalFormat);
 
-		glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		m_GPUMemory = MemoryTracker::GetTextureBytes(m_Width, m_Height, Utils::GLDataFormatBytesPerPixel(dataFormat));
+		MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, m_GPUMemory);
 
-		glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, dataFormat, GL_UNSIGNED_BYTE, data);
+		glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, dataFormat, GL_UNSIGNED_BYTE, upload);
 
-		stbi_image_free(data);
+		stbi_image_free(pixels);
 	}
 }
 
 Texture::~Texture()
 {
+	TextureStreamer::Unregister(this);
+
+	// Pending and failed async loads still point at the shared placeholder
+	if (m_RendererID == s_Loader.Placeholder)
+		return;
+
 	glDeleteTextures(1, &m_RendererID);
+	RendererAPI::OnTextureDeleted(m_RendererID);
+	if (m_GPUMemory)
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Texture, m_GPUMemory);
 }
 
 void Texture::SetData(void* data, uint32_t size)
@@ -106,19 +318,211 @@ void Texture::SetData(void* data, uint32_t size)
 	uint32_t bpp = m_DataFormat == GL_RGBA ? 4 : 3;
 	GABGL_ASSERT(size == m_Width * m_Height * bpp, "Data must be entire texture!");
 	glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, m_DataFormat, GL_UNSIGNED_BYTE, data);
+	if (m_MipLevels > 1)
+		glGenerateTextureMipmap(m_RendererID);
+}
+
+void Texture::SetCooked(const CookedTexture& cooked, uint32_t rendererID, int64_t gpuMemory)
+{
+	m_RendererID = rendererID;
+	m_GPUMemory = gpuMemory;
+
+	m_Width = cooked.Width;
+	m_Height = cooked.Height;
+	m_MipLevels = (uint32_t)cooked.Levels.size();
+	GLenum uncompressedFormat;
+	Utils::ChannelsToGLFormats(cooked.Channels, uncompressedFormat, m_DataFormat);
+	m_InternalFormat = cooked.GetInternalFormat();
+	m_Specification.Width = cooked.Width;
+	m_Specification.Height = cooked.Height;
+	m_Specification.Format = Utils::ChannelsToImageFormat(cooked.Channels);
+	m_Specification.GenerateMips = m_MipLevels > 1;
+	m_IsPending = false;
+	m_IsLoaded = true;
 }
 
 void Texture::Bind(uint32_t slot) const
 {
-	glBindTextureUnit(slot, m_RendererID);
+	RendererAPI::BindTextureUnit(slot, m_RendererID);
+}
+
+Handle<Texture> Texture::Create(const TextureSpecification& specification)
+{
+	return CreateHandle<Texture>(specification);
+}
+
+Handle<Texture> Texture::Create(const std::string& path)
+{
+	return CreateHandle<Texture>(path);
+}
+
+Handle<Texture> Texture::CreateAsync(const std::string& path, bool flipVertically)
+{
+	Handle<Texture> texture = CreateHandle<Texture>(path, TextureLoad::Async, flipVertically);
+
+	s_Loader.Decoding.fetch_add(1, std::memory_order_relaxed);
+	TextureCookSettings settings = Utils::GetCookSettings(flipVertically);
+	uint32_t maxSize = TextureStreamer::IsEnabled() ? TextureStreamer::ResidentTailSize : 0;
+	JobSystem::Submit([texture, path, settings, maxSize]()
+	{
+		GABGL_MEMORY_TAG(Assets);
+		Utils::DecodedImage image;
+		image.Target = texture;
+		image.Path = path;
+		image.Valid = TextureCooker::LoadOrCook(path, settings, image.Cooked, maxSize);
+
+		std::lock_guard<std::mutex> lock(s_Loader.DecodedMutex);
+		s_Loader.Decoded.push_back(std::move(image));
+	});
+	return texture;
+}
+
+void Texture::Destroy(Handle<Texture> texture)
+{
+	DestroyHandle(texture);
+}
+
+void Texture::PollPending()
+{
+	GABGL_PROFILE_SCOPE("Texture::PollPending");
+
+	std::vector<Utils::DecodedImage> decoded;
+	{
+		std::lock_guard<std::mutex> lock(s_Loader.DecodedMutex);
+		decoded.swap(s_Loader.Decoded);
+	}
+	s_Loader.Decoding.fetch_sub((uint32_t)decoded.size(), std::memory_order_relaxed);
+
+	for (Utils::DecodedImage& image : decoded)
+	{
+		Texture* texture = image.Target.Get();
+		if (!texture)
+			continue;
+
+		if (!image.Valid)
+		{
+			GABGL_WARN("Could not load texture {0}", image.Path);
+			texture->m_IsPending = false;
+			continue;
+		}
+
+		// A partial load is streamed, the finer levels are left to TextureStreamer
+		PendingUpload upload;
+		if (image.Cooked.FirstLevel > 0)
+			upload.RendererID = TextureStreamer::CreateStorage(image.Cooked, upload.Sparse, upload.BaseLevel);
+		else
+			upload.RendererID = image.Cooked.CreateStorage();
+		upload.Level = image.Cooked.FirstLevel;
+		upload.GPUMemory = (int64_t)image.Cooked.Data.size();
+		MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, upload.GPUMemory);
+		upload.Image = std::move(image);
+		s_Loader.Uploads.push_back(std::move(upload));
+	}
+
+	if (s_Loader.Uploads.empty())
+		return;
+
+	if (!s_Loader.StagingBuffer)
+		Utils::CreateStagingRing();
+
+	s_Loader.Segment = (s_Loader.Segment + 1) % TextureLoaderData::Segments;
+	Utils::WaitForFence(s_Loader.Fences[s_Loader.Segment]);
+
+	uint32_t segmentOffset = s_Loader.Segment * s_Loader.SegmentSize;
+	uint32_t head = 0;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_Loader.StagingBuffer);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	while (!s_Loader.Uploads.empty())
+	{
+		PendingUpload& upload = s_Loader.Uploads.front();
+		const CookedTexture& cooked = upload.Image.Cooked;
+
+		Texture* texture = upload.Image.Target.Get();
+		if (!texture)
+		{
+			glDeleteTextures(1, &upload.RendererID);
+			MemoryTracker::TrackGPUFree(GPUMemoryKind::Texture, upload.GPUMemory);
+			s_Loader.Uploads.pop_front();
+			continue;
+		}
+
+		// Rows (of pixels, or of 4x4 blocks) are tightly packed, a slice is as many whole rows as the segment has room for
+		uint32_t rowBytes = cooked.GetRowBytes(upload.Level);
+		uint32_t rows = std::min(cooked.GetRowCount(upload.Level) - upload.RowsUploaded, (s_Loader.SegmentSize - head) / rowBytes);
+		if (rows == 0)
+			break;
+
+		const uint8_t* source = cooked.Data.data() + cooked.Levels[upload.Level].Offset + (size_t)upload.RowsUploaded * rowBytes;
+		std::memcpy(s_Loader.StagingMapped + segmentOffset + head, source, (size_t)rows * rowBytes);
+		cooked.Upload(upload.RendererID, upload.Level, upload.RowsUploaded, rows, (const void*)(uintptr_t)(segmentOffset + head), upload.BaseLevel);
+		head += rows * rowBytes;
+		upload.RowsUploaded += rows;
+
+		if (upload.RowsUploaded < cooked.GetRowCount(upload.Level))
+			break;
+
+		upload.Level++;
+		upload.RowsUploaded = 0;
+		if (upload.Level < cooked.Levels.size())
+			continue;
+
+		// GL orders the copies before any draw that samples the new texture, so it can be swapped in now
+		texture->SetCooked(cooked, upload.RendererID, upload.GPUMemory);
+		if (cooked.FirstLevel > 0)
+			TextureStreamer::Register(upload.Image.Target, cooked, upload.Sparse);
+		s_Loader.Uploads.pop_front();
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (head > 0)
+		s_Loader.Fences[s_Loader.Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void Texture::SetUploadBudget(uint32_t bytesPerFrame)
+{
+	// A slice is at least one row, the floor keeps the widest texture row within a segment
+	bytesPerFrame = std::max(bytesPerFrame, MinUploadBudget);
+	if (bytesPerFrame == s_Loader.UploadBudget)
+		return;
+
+	Utils::DestroyStagingRing();
+	s_Loader.UploadBudget = bytesPerFrame;
+}
+
+uint32_t Texture::GetUploadBudget()
+{
+	return s_Loader.UploadBudget;
 }
 
-Ref<Texture> Texture::Create(const TextureSpecification& specification)
+uint32_t Texture::GetPendingCount()
 {
-	return CreateRef<Texture>(specification);
+	return s_Loader.Decoding.load(std::memory_order_relaxed) + (uint32_t)s_Loader.Uploads.size();
 }
 
-Ref<Texture> Texture::Create(const std::string& path)
+void Texture::ShutdownLoader()
 {
-	return CreateRef<Texture>(path);
+	{
+		std::lock_guard<std::mutex> lock(s_Loader.DecodedMutex);
+		s_Loader.Decoded.clear();
+	}
+
+	for (PendingUpload& upload : s_Loader.Uploads)
+	{
+		glDeleteTextures(1, &upload.RendererID);
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Texture, upload.GPUMemory);
+	}
+	s_Loader.Uploads.clear();
+
+	Utils::DestroyStagingRing();
+
+	if (s_Loader.Placeholder)
+	{
+		glDeleteTextures(1, &s_Loader.Placeholder);
+		RendererAPI::OnTextureDeleted(s_Loader.Placeholder);
+		s_Loader.Placeholder = 0;
+	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "../Backend/BackendScopeRef.h"
+#include "../Backend/ResourcePool.h"
+#include "TextureCooker.h"
 #include <string>
 #include <glad/glad.h>
 
@@ -21,36 +22,73 @@ struct TextureSpecification
 	bool GenerateMips = true;
 };
 
+enum class TextureLoad
+{
+	Blocking,
+	Async
+};
+
 struct Texture
 {
 	Texture(const TextureSpecification& specification);
 	Texture(const std::string& path);
+	Texture(const std::string& path, TextureLoad load, bool flipVertically = true);
 	~Texture();
 
 	inline const TextureSpecification& GetSpecification() const { return m_Specification; }
 
 	inline uint32_t GetWidth() const { return m_Width; }
 	inline uint32_t GetHeight() const { return m_Height; }
+	inline uint32_t GetMipLevels() const { return m_MipLevels; }
 	inline uint32_t GetRendererID() const { return m_RendererID; }
 	inline const uint8_t* GetRawData() const { return m_RawData; }
 	inline const std::string& GetPath() const { return m_Path; }
 	void SetData(void* data, uint32_t size);
 	void Bind(uint32_t slot = 0) const;
 	inline bool IsLoaded() const { return m_IsLoaded; }
+	// Async load still decoding or uploading, the texture samples as a 1x1 placeholder until then
+	inline bool IsPending() const { return m_IsPending; }
 
 	bool operator==(const Texture& other) const 
 	{
 		return m_RendererID == other.GetRendererID();
 	}
-	static Ref<Texture> Create(const TextureSpecification& specification);
-	static Ref<Texture> Create(const std::string& path);
+	static Handle<Texture> Create(const TextureSpecification& specification);
+	static Handle<Texture> Create(const std::string& path);
+	// Path loads go through TextureCooker when its cache is enabled: block compressed, full mip chain.
+	// CreateAsync returns at once; the file is cooked on the JobSystem and uploaded by PollPending().
+	// With TextureStreamer enabled only the small levels are loaded, finer ones follow on demand
+	static Handle<Texture> CreateAsync(const std::string& path, bool flipVertically = true);
+	static void Destroy(Handle<Texture> texture);
+
+	// Once per frame on the main thread: swaps decoded images in, uploading at most the budget
+	// per frame in row slices through a pixel unpack buffer ring
+	static void PollPending();
+	static void SetUploadBudget(uint32_t bytesPerFrame);
+	static uint32_t GetUploadBudget();
+	// Async loads not swapped in yet
+	static uint32_t GetPendingCount();
+	// Frees the upload ring and the placeholder, after every texture is destroyed
+	static void ShutdownLoader();
+
+	static constexpr uint32_t DefaultUploadBudget = 8 * 1024 * 1024;
+	static constexpr uint32_t MinUploadBudget = 256 * 1024;
+	static constexpr uint32_t NotStreamed = 0xFFFFFFFF;
 private:
+	friend struct TextureStreamer;
+
+	void SetCooked(const CookedTexture& cooked, uint32_t rendererID, int64_t gpuMemory);
+
 	TextureSpecification m_Specification;
 
 	std::string m_Path;
 	bool m_IsLoaded = false;
-	uint32_t m_Width, m_Height;
-	uint32_t m_RendererID;
+	bool m_IsPending = false;
+	uint32_t m_Width = 0, m_Height = 0;
+	uint32_t m_MipLevels = 1;
+	uint32_t m_RendererID = 0;
+	int64_t m_GPUMemory = 0;
+	uint32_t m_StreamIndex = NotStreamed;
 	uint8_t* m_RawData = nullptr;
 	GLenum m_InternalFormat, m_DataFormat;
 };
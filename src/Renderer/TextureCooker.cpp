@@ -0,0 +1,518 @@
+#include "TextureCooker.h"
+#include "ImageKernels.h"
+#include "../Backend/BackendLogger.h"
+#include "../Backend/Profiler.h"
+#include <stb_image.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace Utils {
+
+	static constexpr uint32_t CookedMagic = 0x58544247; // "GBTX"
+	static constexpr uint32_t MaxLevels = 16;
+
+	struct CookedHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t Compression;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Channels;
+		uint32_t LevelCount;
+		uint32_t Reserved;
+		uint64_t DataSize;
+	};
+
+	struct CookedLevelEntry
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	static uint64_t HashBytes(uint64_t hash, const uint8_t* bytes, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static uint64_t GetLevelSize(TextureCompression compression, uint32_t width, uint32_t height, uint32_t channels)
+	{
+		if (compression == TextureCompression::None)
+			return (uint64_t)width * height * channels;
+		return BlockCompression::GetCompressedSize(compression, width, height);
+	}
+
+	static TextureCompression ChooseCompression(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, const TextureCookSettings& settings)
+	{
+		if (!settings.Compress)
+			return TextureCompression::None;
+
+		switch (channels)
+		{
+			case 1: return TextureCompression::BC4;
+			case 2: return TextureCompression::BC5;
+			case 3: return settings.HighQuality ? TextureCompression::BC7 : TextureCompression::BC1;
+		}
+
+		if (settings.HighQuality)
+			return TextureCompression::BC7;
+
+		// Plenty of RGBA files are fully opaque, those get the 4 bpp format
+		size_t pixelCount = (size_t)width * height;
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			if (pixels[i * 4 + 3] != 255)
+				return TextureCompression::BC3;
+		}
+		return TextureCompression::BC1;
+	}
+
+	static bool IsNormalMapPath(const std::string& path)
+	{
+		std::string name = std::filesystem::path(path).filename().string();
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		return name.find("normal") != std::string::npos;
+	}
+
+	static bool ReadFile(const std::string& path, std::vector<uint8_t>& bytes)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return false;
+		std::streamsize size = file.tellg();
+		if (size <= 0)
+			return false;
+		bytes.resize((size_t)size);
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(bytes.data()), size);
+		return (bool)file;
+	}
+}
+
+// LoadOrCook runs on job workers, everything it touches after Init() is read-only or atomic
+struct TextureCookerData
+{
+	bool Enabled = false;
+	std::filesystem::path Directory;
+
+	std::atomic<uint32_t> Hits{ 0 };
+	std::atomic<uint32_t> Misses{ 0 };
+	std::atomic<uint32_t> Rejected{ 0 };
+	std::atomic<uint64_t> SourceBytes{ 0 };
+	std::atomic<uint64_t> CookedBytes{ 0 };
+	std::atomic<uint64_t> LoadMicros{ 0 };
+	std::atomic<uint64_t> CookMicros{ 0 };
+};
+
+static TextureCookerData s_Data;
+
+GLenum CookedTexture::GetInternalFormat() const
+{
+	switch (Compression)
+	{
+		case TextureCompression::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TextureCompression::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case TextureCompression::BC4: return GL_COMPRESSED_RED_RGTC1;
+		case TextureCompression::BC5: return GL_COMPRESSED_RG_RGTC2;
+		case TextureCompression::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case TextureCompression::None: break;
+	}
+
+	switch (Channels)
+	{
+		case 1: return GL_R8;
+		case 2: return GL_RG8;
+		case 3: return GL_RGB8;
+	}
+	return GL_RGBA8;
+}
+
+uint32_t CookedTexture::GetRowBytes(uint32_t level) const
+{
+	if (Compression == TextureCompression::None)
+		return Levels[level].Width * Channels;
+	return (Levels[level].Width + BlockCompression::BlockSize - 1) / BlockCompression::BlockSize * BlockCompression::GetBlockBytes(Compression);
+}
+
+uint32_t CookedTexture::GetFirstLevelWithin(uint32_t maxSize) const
+{
+	if (maxSize == 0)
+		return 0;
+
+	uint32_t level = 0;
+	while (level + 1 < Levels.size() && std::max(Levels[level].Width, Levels[level].Height) > maxSize)
+		level++;
+	return level;
+}
+
+uint32_t CookedTexture::CreateStorage(uint32_t firstLevel, bool sparse) const
+{
+	uint32_t levelCount = (uint32_t)Levels.size() - firstLevel;
+	uint32_t rendererID;
+	glCreateTextures(GL_TEXTURE_2D, 1, &rendererID);
+	if (sparse)
+	{
+		glTextureParameteri(rendererID, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+		glTextureParameteri(rendererID, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+	}
+	glTextureStorage2D(rendererID, (GLsizei)levelCount, GetInternalFormat(), Levels[firstLevel].Width, Levels[firstLevel].Height);
+
+	glTextureParameteri(rendererID, GL_TEXTURE_MIN_FILTER, Levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTextureParameteri(rendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTextureParameteri(rendererID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(rendererID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// stb's one and two channel images are grey and grey plus alpha, not red and red-green
+	if (Channels <= 2)
+	{
+		GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, Channels == 2 ? GL_GREEN : GL_ONE };
+		glTextureParameteriv(rendererID, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	}
+	return rendererID;
+}
+
+void CookedTexture::Upload(uint32_t rendererID, uint32_t level, uint32_t firstRow, uint32_t rowCount, const void* data, uint32_t baseLevel) const
+{
+	const Level& info = Levels[level];
+	uint32_t y = firstRow * GetRowHeight();
+	uint32_t height = std::min(rowCount * GetRowHeight(), info.Height - y);
+
+	if (Compression == TextureCompression::None)
+	{
+		static constexpr GLenum dataFormats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+		glTextureSubImage2D(rendererID, level - baseLevel, 0, y, info.Width, height, dataFormats[Channels - 1], GL_UNSIGNED_BYTE, data);
+	}
+	else
+		glCompressedTextureSubImage2D(rendererID, level - baseLevel, 0, y, info.Width, height, GetInternalFormat(), (GLsizei)rowCount * GetRowBytes(level), data);
+}
+
+uint32_t CookedTexture::CreateGLTexture() const
+{
+	uint32_t rendererID = CreateStorage(FirstLevel);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (uint32_t level = FirstLevel; level < Levels.size(); level++)
+		Upload(rendererID, level, 0, GetRowCount(level), Data.data() + Levels[level].Offset, FirstLevel);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	return rendererID;
+}
+
+void TextureCooker::Init(const std::string& directory)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error)
+	{
+		GABGL_WARN("Could not create texture cache directory {0}: {1}", directory, error.message());
+		return;
+	}
+
+	s_Data.Directory = directory;
+	s_Data.Enabled = true;
+}
+
+bool TextureCooker::IsEnabled()
+{
+	return s_Data.Enabled;
+}
+
+TextureCookSettings TextureCooker::GetDefaultSettings()
+{
+	TextureCookSettings settings;
+	settings.HighQuality = !GLAD_GL_EXT_texture_compression_s3tc;
+	return settings;
+}
+
+uint64_t TextureCooker::ComputeKey(const void* data, size_t size, const TextureCookSettings& settings)
+{
+	const uint8_t fields[] = {
+		(uint8_t)Version, (uint8_t)settings.Compress, (uint8_t)settings.HighQuality,
+		(uint8_t)settings.GenerateMips, (uint8_t)settings.FlipVertically, (uint8_t)settings.SRGB,
+		(uint8_t)settings.NormalMap
+	};
+
+	uint64_t hash = Utils::HashBytes(14695981039346656037ull, fields, sizeof(fields));
+	return Utils::HashBytes(hash, static_cast<const uint8_t*>(data), size);
+}
+
+std::string TextureCooker::GetCachePath(uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.gtex", (unsigned long long)key);
+	return (s_Data.Directory / name).string();
+}
+
+bool TextureCooker::LoadOrCook(const std::string& path, const TextureCookSettings& requested, CookedTexture& cooked, uint32_t maxSize)
+{
+	GABGL_PROFILE_SCOPE("TextureCooker::LoadOrCook");
+	Timer timer;
+
+	std::vector<uint8_t> file;
+	if (!Utils::ReadFile(path, file))
+		return false;
+
+	TextureCookSettings settings = requested;
+	settings.NormalMap = settings.NormalMap || Utils::IsNormalMapPath(path);
+	uint64_t key = ComputeKey(file.data(), file.size(), settings);
+	if (s_Data.Enabled && Read(GetCachePath(key), key, cooked, maxSize))
+	{
+		s_Data.Hits.fetch_add(1, std::memory_order_relaxed);
+		s_Data.SourceBytes.fetch_add((uint64_t)cooked.Width * cooked.Height * cooked.Channels, std::memory_order_relaxed);
+		s_Data.CookedBytes.fetch_add(cooked.Data.size(), std::memory_order_relaxed);
+		s_Data.LoadMicros.fetch_add((uint64_t)(timer.ElapsedMillis() * 1000.0f), std::memory_order_relaxed);
+		return true;
+	}
+
+	int width, height, channels;
+	stbi_set_flip_vertically_on_load_thread(settings.FlipVertically);
+	stbi_uc* pixels = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 0);
+	if (!pixels)
+		return false;
+
+	Cook(pixels, width, height, channels, settings, cooked);
+	stbi_image_free(pixels);
+
+	// Only a stored entry can serve the dropped levels later
+	if (s_Data.Enabled && Write(GetCachePath(key), key, cooked))
+	{
+		cooked.Key = key;
+		cooked.FirstLevel = cooked.GetFirstLevelWithin(maxSize);
+		cooked.Data.resize(cooked.GetDataSize(cooked.FirstLevel));
+		cooked.Data.shrink_to_fit();
+	}
+
+	s_Data.Misses.fetch_add(1, std::memory_order_relaxed);
+	s_Data.SourceBytes.fetch_add((uint64_t)width * height * channels, std::memory_order_relaxed);
+	s_Data.CookedBytes.fetch_add(cooked.Data.size(), std::memory_order_relaxed);
+	s_Data.CookMicros.fetch_add((uint64_t)(timer.ElapsedMillis() * 1000.0f), std::memory_order_relaxed);
+	return true;
+}
+
+void TextureCooker::Cook(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, const TextureCookSettings& settings, CookedTexture& cooked)
+{
+	GABGL_PROFILE_SCOPE("TextureCooker::Cook");
+
+	std::vector<uint8_t> expanded;
+	if (!settings.Compress && channels == 3)
+	{
+		expanded.resize((size_t)width * height * 4);
+		ImageKernels::ExpandRGBToRGBA(pixels, expanded.data(), (size_t)width * height);
+		pixels = expanded.data();
+		channels = 4;
+	}
+
+	cooked.Compression = Utils::ChooseCompression(pixels, width, height, channels, settings);
+	cooked.Width = width;
+	cooked.Height = height;
+	cooked.Channels = channels;
+	cooked.FirstLevel = 0;
+	cooked.Key = 0;
+
+	uint32_t levelCount = 1;
+	if (settings.GenerateMips)
+	{
+		for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+			levelCount++;
+	}
+
+	cooked.Levels.resize(levelCount);
+	uint64_t offset = 0;
+	for (uint32_t level = levelCount; level-- > 0;)
+	{
+		CookedTexture::Level& info = cooked.Levels[level];
+		info.Width = std::max(width >> level, 1u);
+		info.Height = std::max(height >> level, 1u);
+		info.Size = Utils::GetLevelSize(cooked.Compression, info.Width, info.Height, channels);
+		info.Offset = offset;
+		offset += info.Size;
+	}
+	cooked.Data.resize(offset);
+
+	bool normalMap = settings.NormalMap && channels >= 3;
+	bool linearLight = settings.SRGB && channels >= 3 && !normalMap;
+	// The chain is kept premultiplied, each level is straightened again for encoding
+	bool premultiplied = channels == 4 && expanded.empty() && !normalMap && levelCount > 1;
+
+	std::vector<uint8_t> current(pixels, pixels + (size_t)width * height * channels), next, straight;
+	if (premultiplied)
+		ImageKernels::PremultiplyAlpha(current.data(), (size_t)width * height);
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		const CookedTexture::Level& info = cooked.Levels[level];
+		const uint8_t* levelPixels = pixels;
+		if (level > 0)
+		{
+			const CookedTexture::Level& previous = cooked.Levels[level - 1];
+			size_t pixelCount = (size_t)info.Width * info.Height;
+			next.resize(pixelCount * channels);
+			if (linearLight)
+				ImageKernels::DownsampleSRGB(current.data(), previous.Width, previous.Height, channels, next.data());
+			else
+				ImageKernels::Downsample(current.data(), previous.Width, previous.Height, channels, next.data());
+			current.swap(next);
+
+			if (normalMap)
+				ImageKernels::RenormalizeNormals(current.data(), pixelCount, channels);
+			levelPixels = current.data();
+			if (premultiplied)
+			{
+				straight.assign(current.begin(), current.end());
+				ImageKernels::UnpremultiplyAlpha(straight.data(), pixelCount);
+				levelPixels = straight.data();
+			}
+		}
+
+		uint8_t* destination = cooked.Data.data() + info.Offset;
+		if (cooked.Compression == TextureCompression::None)
+			std::memcpy(destination, levelPixels, info.Size);
+		else
+			BlockCompression::Encode(cooked.Compression, levelPixels, info.Width, info.Height, channels, destination);
+	}
+}
+
+bool TextureCooker::Read(const std::string& path, uint64_t key, CookedTexture& cooked, uint32_t maxSize)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	Utils::CookedHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.Magic != Utils::CookedMagic || header.Version != Version || header.Key != key)
+		return false;
+
+	// Anything inconsistent is treated as corrupt and removed, the next load cooks it again
+	auto reject = [&]()
+	{
+		file.close();
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		s_Data.Rejected.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	};
+
+	if (header.LevelCount == 0 || header.LevelCount > Utils::MaxLevels || header.Channels == 0 || header.Channels > 4 ||
+		header.Compression > (uint32_t)TextureCompression::BC7)
+		return reject();
+
+	cooked.Compression = (TextureCompression)header.Compression;
+	cooked.Width = header.Width;
+	cooked.Height = header.Height;
+	cooked.Channels = header.Channels;
+	cooked.Levels.resize(header.LevelCount);
+	for (CookedTexture::Level& level : cooked.Levels)
+	{
+		Utils::CookedLevelEntry entry{};
+		file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+		if (!file || entry.Offset + entry.Size > header.DataSize ||
+			entry.Size != Utils::GetLevelSize(cooked.Compression, entry.Width, entry.Height, cooked.Channels))
+			return reject();
+
+		level = { entry.Width, entry.Height, entry.Offset, entry.Size };
+	}
+
+	if (cooked.Levels.back().Offset != 0 || cooked.GetDataSize(0) != header.DataSize)
+		return reject();
+
+	// Smallest first: the levels kept are the start of the data
+	cooked.FirstLevel = cooked.GetFirstLevelWithin(maxSize);
+	cooked.Key = key;
+	cooked.Data.resize(cooked.GetDataSize(cooked.FirstLevel));
+	file.read(reinterpret_cast<char*>(cooked.Data.data()), (std::streamsize)cooked.Data.size());
+	if (!file)
+		return reject();
+	return true;
+}
+
+bool TextureCooker::ReadLevel(const CookedTexture& cooked, uint32_t level, std::vector<uint8_t>& data)
+{
+	if (!cooked.Key || level >= cooked.Levels.size())
+		return false;
+
+	std::ifstream file(GetCachePath(cooked.Key), std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	Utils::CookedHeader header{};
+	Utils::CookedLevelEntry entry{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	file.seekg(sizeof(header) + level * sizeof(entry));
+	file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+
+	// The entry may have been replaced since the first load, the layout has to match
+	const CookedTexture::Level& info = cooked.Levels[level];
+	if (!file || header.Magic != Utils::CookedMagic || header.Version != Version || header.Key != cooked.Key ||
+		header.LevelCount != cooked.Levels.size() || entry.Offset != info.Offset || entry.Size != info.Size)
+		return false;
+
+	data.resize(info.Size);
+	file.seekg(sizeof(header) + header.LevelCount * sizeof(entry) + info.Offset);
+	file.read(reinterpret_cast<char*>(data.data()), (std::streamsize)info.Size);
+	return (bool)file;
+}
+
+bool TextureCooker::Write(const std::string& path, uint64_t key, const CookedTexture& cooked)
+{
+	Utils::CookedHeader header{ Utils::CookedMagic, Version, key, (uint32_t)cooked.Compression, cooked.Width, cooked.Height,
+		cooked.Channels, (uint32_t)cooked.Levels.size(), 0, cooked.Data.size() };
+
+	// Workers may cook the same file at once, each writes its own temp file and the last rename wins
+	std::filesystem::path tempPath = path;
+	tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			GABGL_WARN("Could not write texture cache entry {0}", tempPath.string());
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (const CookedTexture::Level& level : cooked.Levels)
+		{
+			Utils::CookedLevelEntry entry{ level.Width, level.Height, level.Offset, level.Size };
+			file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		}
+		file.write(reinterpret_cast<const char*>(cooked.Data.data()), (std::streamsize)cooked.Data.size());
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		GABGL_WARN("Could not write texture cache entry {0}: {1}", path, error.message());
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+TextureCooker::Statistics TextureCooker::GetStats()
+{
+	Statistics stats;
+	stats.Hits = s_Data.Hits.load(std::memory_order_relaxed);
+	stats.Misses = s_Data.Misses.load(std::memory_order_relaxed);
+	stats.Rejected = s_Data.Rejected.load(std::memory_order_relaxed);
+	stats.SourceBytes = s_Data.SourceBytes.load(std::memory_order_relaxed);
+	stats.CookedBytes = s_Data.CookedBytes.load(std::memory_order_relaxed);
+	stats.LoadMs = s_Data.LoadMicros.load(std::memory_order_relaxed) / 1000.0f;
+	stats.CookMs = s_Data.CookMicros.load(std::memory_order_relaxed) / 1000.0f;
+	return stats;
+}
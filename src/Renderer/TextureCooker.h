@@ -0,0 +1,107 @@
+#pragma once
+
+#include "BlockCompression.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TextureCookSettings
+{
+	bool Compress = true;
+	bool HighQuality = false; // BC7 for color instead of BC1/BC3
+	bool GenerateMips = true;
+	bool FlipVertically = true;
+	// Color is sRGB encoded: mips of 3 and 4 channel images are averaged in linear light
+	bool SRGB = false;
+	// Mips are renormalized; LoadOrCook() turns it on for files named like normal maps
+	bool NormalMap = false;
+};
+
+// Every mip level of one image in a single allocation. Uncompressed levels keep the source
+// channel count; compressed ones are uploaded in rows of 4x4 blocks. Levels are laid out smallest
+// first, so a partial load keeps FirstLevel and everything smaller with the offsets unchanged.
+struct CookedTexture
+{
+	struct Level
+	{
+		uint32_t Width = 0, Height = 0;
+		uint64_t Offset = 0, Size = 0;
+	};
+
+	TextureCompression Compression = TextureCompression::None;
+	uint32_t Width = 0, Height = 0;
+	uint32_t Channels = 0;
+	std::vector<Level> Levels;
+	std::vector<uint8_t> Data;
+	// Finest level held in Data
+	uint32_t FirstLevel = 0;
+	// Cache entry the levels came from, 0 when nothing was stored
+	uint64_t Key = 0;
+
+	GLenum GetInternalFormat() const;
+	// Pixel rows in one upload row: 4 for block formats, 1 otherwise
+	uint32_t GetRowHeight() const { return Compression == TextureCompression::None ? 1 : BlockCompression::BlockSize; }
+	uint32_t GetRowCount(uint32_t level) const { return (Levels[level].Height + GetRowHeight() - 1) / GetRowHeight(); }
+	uint32_t GetRowBytes(uint32_t level) const;
+
+	// Bytes of Data that hold firstLevel and every smaller level
+	uint64_t GetDataSize(uint32_t firstLevel) const { return Levels[firstLevel].Offset + Levels[firstLevel].Size; }
+	// Smallest level index whose size fits maxSize in both dimensions, 0 when maxSize is 0
+	uint32_t GetFirstLevelWithin(uint32_t maxSize) const;
+
+	// glCreateTextures plus storage for firstLevel and smaller, which become GL levels 0 and up.
+	// Filtering and wrap are set like Texture's. Sparse storage has no pages committed yet
+	uint32_t CreateStorage(uint32_t firstLevel = 0, bool sparse = false) const;
+	// data is a client pointer or an offset into the bound GL_PIXEL_UNPACK_BUFFER. baseLevel is the
+	// level the storage starts at, as passed to CreateStorage()
+	void Upload(uint32_t rendererID, uint32_t level, uint32_t firstRow, uint32_t rowCount, const void* data, uint32_t baseLevel = 0) const;
+	// CreateStorage(FirstLevel) and every level in Data uploaded
+	uint32_t CreateGLTexture() const;
+};
+
+// Derived-data cache for textures. Cooked files live in one directory, named by a key hashed
+// from the source file's bytes and the cook settings, so a copied file still hits and an
+// edited one misses. Levels are stored smallest first, like KTX2, behind a level index.
+struct TextureCooker
+{
+	// Bump when the encoders change, older entries stop matching
+	static constexpr uint32_t Version = 2;
+
+	static void Init(const std::string& directory = "texture_cache");
+	static bool IsEnabled();
+	// What the current driver samples natively, BC7 covers color where S3TC is missing
+	static TextureCookSettings GetDefaultSettings();
+
+	static uint64_t ComputeKey(const void* data, size_t size, const TextureCookSettings& settings);
+	static std::string GetCachePath(uint64_t key);
+
+	// Thread safe. Returns the cached entry, or decodes the file, cooks it and stores the result;
+	// false when the file can't be read or decoded. Without Init() nothing is stored. A maxSize
+	// keeps only the levels that fit it in memory, the rest stay in the cache for ReadLevel().
+	// Files with "normal" in their name are cooked as normal maps.
+	static bool LoadOrCook(const std::string& path, const TextureCookSettings& settings, CookedTexture& cooked, uint32_t maxSize = 0);
+	// RGBA mips are filtered with premultiplied alpha, so transparent texels don't bleed into
+	// visible ones. Uncompressed RGB is expanded to RGBA, drivers convert 3-byte texels on upload
+	static void Cook(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, const TextureCookSettings& settings, CookedTexture& cooked);
+
+	static bool Read(const std::string& path, uint64_t key, CookedTexture& cooked, uint32_t maxSize = 0);
+	// Thread safe. One level of the entry cooked was loaded from, read straight from its offset
+	static bool ReadLevel(const CookedTexture& cooked, uint32_t level, std::vector<uint8_t>& data);
+	static bool Write(const std::string& path, uint64_t key, const CookedTexture& cooked);
+
+	struct Statistics
+	{
+		uint32_t Hits = 0;
+		uint32_t Misses = 0;
+		uint32_t Rejected = 0;
+		uint64_t SourceBytes = 0; // level 0 at the source channel count, what uncooked loading uploads
+		uint64_t CookedBytes = 0; // whole mip chain as loaded
+		float LoadMs = 0.0f;
+		float CookMs = 0.0f;
+	};
+
+	static Statistics GetStats();
+};
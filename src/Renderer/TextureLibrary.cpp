@@ -0,0 +1,244 @@
+#include "TextureLibrary.h"
+#include "../Backend/BackendLogger.h"
+#include "../Backend/JobSystem.h"
+#include "../Backend/Profiler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils {
+
+	// The flip setting is part of both keys, a flipped and an unflipped load are different textures
+	static std::string GetPathKey(const std::string& path, bool flipVertically)
+	{
+		std::error_code error;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+		return (flipVertically ? "1:" : "0:") + (error ? path : canonical.generic_string());
+	}
+
+	// FNV-1a over the file in chunks, 0 when it can't be read
+	static uint64_t HashFile(const std::string& path, bool flipVertically)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return 0;
+
+		uint64_t hash = 14695981039346656037ull;
+		hash = (hash ^ (flipVertically ? 1u : 0u)) * 1099511628211ull;
+
+		char buffer[64 * 1024];
+		while (file)
+		{
+			file.read(buffer, sizeof(buffer));
+			std::streamsize count = file.gcount();
+			for (std::streamsize i = 0; i < count; i++)
+			{
+				hash ^= (uint8_t)buffer[i];
+				hash *= 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+}
+
+struct TextureLibraryData
+{
+	struct Entry
+	{
+		Handle<Texture> Resource;
+		uint32_t RefCount = 0;
+		// 0 until the worker has hashed the file
+		uint64_t ContentKey = 0;
+		// Every path that resolves to this texture
+		std::vector<std::string> PathKeys;
+	};
+
+	struct PathEntry
+	{
+		uint32_t Handle = 0;
+		std::filesystem::file_time_type WriteTime;
+	};
+
+	struct HashResult
+	{
+		Handle<Texture> Resource;
+		uint64_t ContentKey = 0;
+	};
+
+	// By handle value
+	std::unordered_map<uint32_t, Entry> Entries;
+	std::unordered_map<std::string, PathEntry> ByPath;
+	std::unordered_map<uint64_t, uint32_t> ByContent;
+
+	std::mutex HashedMutex;
+	std::vector<HashResult> Hashed;
+
+	TextureLibrary::Statistics Stats;
+};
+
+static TextureLibraryData s_Library;
+
+namespace Utils {
+
+	static void RemoveEntry(uint32_t handle)
+	{
+		auto it = s_Library.Entries.find(handle);
+		if (it == s_Library.Entries.end())
+			return;
+
+		for (const std::string& pathKey : it->second.PathKeys)
+			s_Library.ByPath.erase(pathKey);
+		auto content = s_Library.ByContent.find(it->second.ContentKey);
+		if (content != s_Library.ByContent.end() && content->second == handle)
+			s_Library.ByContent.erase(content);
+		s_Library.Entries.erase(it);
+	}
+
+	// Entry for a key, dropped when its texture was destroyed behind the library's back
+	static TextureLibraryData::Entry* FindLiveEntry(uint32_t handle)
+	{
+		auto it = s_Library.Entries.find(handle);
+		if (it == s_Library.Entries.end())
+			return nullptr;
+
+		if (!it->second.Resource.IsValid())
+		{
+			RemoveEntry(handle);
+			return nullptr;
+		}
+		return &it->second;
+	}
+}
+
+Handle<Texture> TextureLibrary::Load(const std::string& path, TextureLoad load, bool flipVertically)
+{
+	GABGL_PROFILE_SCOPE("TextureLibrary::Load");
+
+	std::string pathKey = Utils::GetPathKey(path, flipVertically);
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+
+	auto byPath = s_Library.ByPath.find(pathKey);
+	if (byPath != s_Library.ByPath.end())
+	{
+		TextureLibraryData::Entry* entry = Utils::FindLiveEntry(byPath->second.Handle);
+		if (entry && byPath->second.WriteTime == writeTime)
+		{
+			entry->RefCount++;
+			s_Library.Stats.PathHits++;
+			return entry->Resource;
+		}
+
+		// The file changed since it was loaded, current owners keep the old texture
+		if (entry)
+			entry->PathKeys.erase(std::remove(entry->PathKeys.begin(), entry->PathKeys.end(), pathKey), entry->PathKeys.end());
+		s_Library.ByPath.erase(pathKey);
+	}
+
+	s_Library.Stats.Misses++;
+	Handle<Texture> texture = load == TextureLoad::Async ? Texture::CreateAsync(path, flipVertically) : CreateHandle<Texture>(path, TextureLoad::Blocking, flipVertically);
+	if (load == TextureLoad::Blocking && !texture->IsLoaded())
+		return texture;
+
+	TextureLibraryData::Entry& entry = s_Library.Entries[texture.Value];
+	entry.Resource = texture;
+	entry.RefCount = 1;
+	entry.PathKeys.push_back(pathKey);
+	s_Library.ByPath[pathKey] = { texture.Value, writeTime };
+
+	// Reading the whole file is the worker's job, duplicates are found once PollPending() sees the hash
+	JobSystem::Submit([texture, path, flipVertically]()
+	{
+		uint64_t contentKey = Utils::HashFile(path, flipVertically);
+		std::lock_guard<std::mutex> lock(s_Library.HashedMutex);
+		s_Library.Hashed.push_back({ texture, contentKey });
+	});
+	return texture;
+}
+
+void TextureLibrary::PollPending()
+{
+	GABGL_PROFILE_SCOPE("TextureLibrary::PollPending");
+
+	std::vector<TextureLibraryData::HashResult> hashed;
+	{
+		std::lock_guard<std::mutex> lock(s_Library.HashedMutex);
+		hashed.swap(s_Library.Hashed);
+	}
+
+	for (const TextureLibraryData::HashResult& result : hashed)
+	{
+		TextureLibraryData::Entry* entry = Utils::FindLiveEntry(result.Resource.Value);
+		if (!entry || !result.ContentKey)
+			continue;
+
+		auto byContent = s_Library.ByContent.find(result.ContentKey);
+		TextureLibraryData::Entry* original = byContent != s_Library.ByContent.end() ? Utils::FindLiveEntry(byContent->second) : nullptr;
+		if (!original)
+		{
+			entry->ContentKey = result.ContentKey;
+			s_Library.ByContent[result.ContentKey] = result.Resource.Value;
+			continue;
+		}
+
+		// Same bytes as a texture already loaded: current owners keep this one until they release
+		// it, later loads of its paths get the original
+		for (const std::string& pathKey : entry->PathKeys)
+		{
+			s_Library.ByPath[pathKey].Handle = original->Resource.Value;
+			original->PathKeys.push_back(pathKey);
+		}
+		entry->PathKeys.clear();
+		s_Library.Stats.ContentHits++;
+	}
+}
+
+void TextureLibrary::Acquire(Handle<Texture> texture)
+{
+	if (TextureLibraryData::Entry* entry = Utils::FindLiveEntry(texture.Value))
+	{
+		entry->RefCount++;
+		return;
+	}
+	if (!texture)
+		return;
+
+	// Created outside the library: its creator's reference is counted too, so this acquire only
+	// destroys it once the creator has released it as well
+	TextureLibraryData::Entry& entry = s_Library.Entries[texture.Value];
+	entry.Resource = texture;
+	entry.RefCount = 2;
+}
+
+void TextureLibrary::Release(Handle<Texture> texture)
+{
+	TextureLibraryData::Entry* entry = Utils::FindLiveEntry(texture.Value);
+	if (entry && --entry->RefCount > 0)
+		return;
+
+	if (entry)
+		Utils::RemoveEntry(texture.Value);
+	Texture::Destroy(texture);
+}
+
+void TextureLibrary::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_Library.HashedMutex);
+		s_Library.Hashed.clear();
+	}
+	s_Library.Entries.clear();
+	s_Library.ByPath.clear();
+	s_Library.ByContent.clear();
+}
+
+TextureLibrary::Statistics TextureLibrary::GetStats()
+{
+	Statistics stats = s_Library.Stats;
+	stats.Textures = (uint32_t)s_Library.Entries.size();
+	return stats;
+}
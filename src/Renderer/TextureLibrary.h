@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <string>
+
+// Process-wide registry of textures loaded from files, so a material or sprite shared by many
+// models and entities is decoded and uploaded once. Lookups go by canonical path and write time.
+// New files are hashed on a worker, and once a file turns out to hold the same bytes as a texture
+// already loaded its path is pointed there, so copies of one image under different names share a
+// texture from their next load on. Entries are weak: the library holds no reference of its own,
+// each Load() or Acquire() is paired with a Release() and the last Release() destroys the texture.
+// Loading a file that is still decoding hands out the same pending texture instead of starting a
+// second decode.
+struct TextureLibrary
+{
+	// Main thread only. A failed blocking load is returned as is and not registered.
+	static Handle<Texture> Load(const std::string& path, TextureLoad load = TextureLoad::Async, bool flipVertically = true);
+	// One more owner of a texture. A texture from Texture::Create() or CreateAsync() is adopted:
+	// its creator keeps a reference and releases it through Release() like every other owner
+	static void Acquire(Handle<Texture> texture);
+	// Handles the library doesn't know are passed to Texture::Destroy
+	static void Release(Handle<Texture> texture);
+	// Main thread, once per frame: matches up the files the workers have hashed since
+	static void PollPending();
+	// Forgets every entry, textures are left to ResourcePools::Shutdown
+	static void Shutdown();
+
+	struct Statistics
+	{
+		uint32_t Textures = 0;
+		uint32_t PathHits = 0;
+		// Files found to duplicate an already loaded texture
+		uint32_t ContentHits = 0;
+		uint32_t Misses = 0;
+	};
+
+	static Statistics GetStats();
+};
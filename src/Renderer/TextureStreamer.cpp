@@ -0,0 +1,440 @@
+#include "TextureStreamer.h"
+#include "RendererAPI.h"
+#include "../Backend/BackendLogger.h"
+#include "../Backend/JobSystem.h"
+#include "../Backend/MemoryTracker.h"
+#include "../Backend/Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct StreamedTexture
+{
+	static constexpr uint32_t NoRequest = 0xFFFFFFFF;
+
+	Handle<Texture> Owner;
+	// Levels and format of the cache entry, without data
+	CookedTexture Layout;
+	bool Sparse = false;
+	// Sparse levels below this are committed one by one, the rest form the mip tail
+	uint32_t SparseLevels = 0;
+
+	uint32_t ResidentLevel = 0;
+	uint32_t TailLevel = 0;
+	uint32_t WantedLevel = 0;
+	uint32_t RequestedLevel = NoRequest;
+	uint64_t LastUsedFrame = 0;
+	bool Loading = false;
+	bool Failed = false;
+};
+
+struct LoadedLevel
+{
+	Handle<Texture> Target;
+	uint32_t Level = 0;
+	std::vector<uint8_t> Data;
+	bool Valid = false;
+};
+
+// Workers push into Loaded, everything else is main thread only
+struct TextureStreamerData
+{
+	static constexpr uint32_t MaxLoadsInFlight = 8;
+
+	bool Enabled = false;
+	uint64_t Budget = TextureStreamer::DefaultBudget;
+	uint64_t Frame = 0;
+
+	std::vector<StreamedTexture> Textures;
+	uint64_t ResidentBytes = 0;
+	// Levels being read, counted against the budget before they arrive
+	uint64_t ReservedBytes = 0;
+
+	std::mutex LoadedMutex;
+	std::vector<LoadedLevel> Loaded;
+	uint32_t LoadsInFlight = 0;
+
+	uint32_t LevelsLoaded = 0;
+	uint32_t LevelsEvicted = 0;
+
+	// Page size at virtual page size index 0, zero when the format can't be sparse
+	std::unordered_map<GLenum, glm::ivec2> SparsePageSizes;
+};
+
+static TextureStreamerData s_Streamer;
+
+namespace Utils {
+
+	static glm::ivec2 GetSparsePageSize(GLenum internalFormat)
+	{
+		// Commitment goes through the DSA entry point, so nothing has to be bound
+		if (!GLAD_GL_ARB_sparse_texture || !GLAD_GL_EXT_direct_state_access)
+			return glm::ivec2(0);
+
+		auto it = s_Streamer.SparsePageSizes.find(internalFormat);
+		if (it != s_Streamer.SparsePageSizes.end())
+			return it->second;
+
+		GLint pageSizes = 0;
+		glm::ivec2 pageSize(0);
+		glGetInternalformativ(GL_TEXTURE_2D, internalFormat, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &pageSizes);
+		if (pageSizes > 0)
+		{
+			// CookedTexture::CreateStorage always picks index 0, the first value of each list
+			glGetInternalformativ(GL_TEXTURE_2D, internalFormat, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageSize.x);
+			glGetInternalformativ(GL_TEXTURE_2D, internalFormat, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageSize.y);
+		}
+		return s_Streamer.SparsePageSizes[internalFormat] = pageSize;
+	}
+
+	static bool IsSparseSupported(const CookedTexture& cooked)
+	{
+		// Sparse storage must be a whole number of pages, anything else fails to allocate
+		glm::ivec2 pageSize = GetSparsePageSize(cooked.GetInternalFormat());
+		if (pageSize.x <= 0 || pageSize.y <= 0)
+			return false;
+
+		const CookedTexture::Level& top = cooked.Levels[0];
+		return top.Width % (uint32_t)pageSize.x == 0 && top.Height % (uint32_t)pageSize.y == 0;
+	}
+
+	static void CommitLevel(uint32_t rendererID, const CookedTexture& layout, uint32_t level, bool commit)
+	{
+		const CookedTexture::Level& info = layout.Levels[level];
+		glTexturePageCommitmentEXT(rendererID, level, 0, 0, 0, info.Width, info.Height, 1, commit ? GL_TRUE : GL_FALSE);
+	}
+
+	static uint64_t GetResidentBytes(const StreamedTexture& entry)
+	{
+		return entry.Layout.GetDataSize(entry.ResidentLevel);
+	}
+}
+
+StreamedTexture* TextureStreamer::GetEntry(Texture* texture)
+{
+	if (!texture || texture->m_StreamIndex >= s_Streamer.Textures.size())
+		return nullptr;
+
+	StreamedTexture& entry = s_Streamer.Textures[texture->m_StreamIndex];
+	return entry.Owner.Get() == texture ? &entry : nullptr;
+}
+
+void TextureStreamer::SetResidentLevel(StreamedTexture& entry, Texture& texture, uint32_t level, const uint8_t* data)
+{
+	const CookedTexture& layout = entry.Layout;
+	uint32_t previous = entry.ResidentLevel;
+	bool growing = level < previous;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (entry.Sparse)
+	{
+		if (growing)
+		{
+			if (level < entry.SparseLevels)
+				Utils::CommitLevel(texture.m_RendererID, layout, level, true);
+			layout.Upload(texture.m_RendererID, level, 0, layout.GetRowCount(level), data);
+			glTextureParameteri(texture.m_RendererID, GL_TEXTURE_BASE_LEVEL, level);
+		}
+		else
+		{
+			// Clamped first, so nothing samples the pages being released
+			glTextureParameteri(texture.m_RendererID, GL_TEXTURE_BASE_LEVEL, level);
+			for (uint32_t evicted = previous; evicted < std::min(level, entry.SparseLevels); evicted++)
+				Utils::CommitLevel(texture.m_RendererID, layout, evicted, false);
+		}
+	}
+	else
+	{
+		// Immutable storage can't change size: the kept levels move to a new texture on the GPU
+		uint32_t rendererID = layout.CreateStorage(level);
+		for (uint32_t kept = std::max(level, previous); kept < layout.Levels.size(); kept++)
+		{
+			const CookedTexture::Level& info = layout.Levels[kept];
+			glCopyImageSubData(texture.m_RendererID, GL_TEXTURE_2D, kept - previous, 0, 0, 0,
+				rendererID, GL_TEXTURE_2D, kept - level, 0, 0, 0, info.Width, info.Height, 1);
+		}
+		if (growing)
+			layout.Upload(rendererID, level, 0, layout.GetRowCount(level), data, level);
+
+		glDeleteTextures(1, &texture.m_RendererID);
+		RendererAPI::OnTextureDeleted(texture.m_RendererID);
+		texture.m_RendererID = rendererID;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	int64_t delta = (int64_t)layout.GetDataSize(level) - (int64_t)layout.GetDataSize(previous);
+	if (delta > 0)
+		MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, delta);
+	else
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Texture, -delta);
+	texture.m_GPUMemory += delta;
+	s_Streamer.ResidentBytes += delta;
+	entry.ResidentLevel = level;
+}
+
+void TextureStreamer::ApplyLoadedLevels()
+{
+	std::vector<LoadedLevel> loaded;
+	{
+		std::lock_guard<std::mutex> lock(s_Streamer.LoadedMutex);
+		loaded.swap(s_Streamer.Loaded);
+	}
+
+	for (LoadedLevel& level : loaded)
+	{
+		s_Streamer.LoadsInFlight--;
+
+		Texture* texture = level.Target.Get();
+		StreamedTexture* entry = GetEntry(texture);
+		if (!entry)
+			continue;
+
+		entry->Loading = false;
+		s_Streamer.ReservedBytes -= entry->Layout.Levels[level.Level].Size;
+		if (!level.Valid)
+		{
+			// The cache entry is gone or was replaced, the texture keeps what it has
+			GABGL_WARN("Could not stream level {0} of {1}", level.Level, texture->GetPath());
+			entry->Failed = true;
+			continue;
+		}
+
+		// An eviction since the request leaves a gap the level can't fill
+		if (level.Level + 1 != entry->ResidentLevel)
+			continue;
+
+		SetResidentLevel(*entry, *texture, level.Level, level.Data.data());
+		s_Streamer.LevelsLoaded++;
+	}
+}
+
+// Evicts until incoming more bytes fit, least recently drawn first. Textures drawn last frame
+// only lose levels finer than they need; except skips the texture making room
+bool TextureStreamer::MakeRoom(uint64_t incoming, const StreamedTexture* except)
+{
+	if (s_Streamer.ResidentBytes + s_Streamer.ReservedBytes + incoming <= s_Streamer.Budget)
+		return true;
+
+	std::vector<StreamedTexture*> candidates;
+	for (StreamedTexture& entry : s_Streamer.Textures)
+	{
+		uint32_t floor = entry.LastUsedFrame == s_Streamer.Frame ? entry.WantedLevel : entry.TailLevel;
+		if (&entry != except && !entry.Loading && entry.ResidentLevel < floor)
+			candidates.push_back(&entry);
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const StreamedTexture* a, const StreamedTexture* b)
+	{
+		return a->LastUsedFrame < b->LastUsedFrame;
+	});
+
+	for (StreamedTexture* entry : candidates)
+	{
+		uint32_t floor = entry->LastUsedFrame == s_Streamer.Frame ? entry->WantedLevel : entry->TailLevel;
+		s_Streamer.LevelsEvicted += floor - entry->ResidentLevel;
+		SetResidentLevel(*entry, *entry->Owner, floor, nullptr);
+
+		if (s_Streamer.ResidentBytes + s_Streamer.ReservedBytes + incoming <= s_Streamer.Budget)
+			return true;
+	}
+	return false;
+}
+
+// The next finer level of the textures furthest from what they need, within the upload
+// budget; a visible texture that doesn't fit stays at its coarser levels
+void TextureStreamer::RequestLevels()
+{
+	std::vector<StreamedTexture*> wanting;
+	for (StreamedTexture& entry : s_Streamer.Textures)
+	{
+		if (entry.LastUsedFrame == s_Streamer.Frame && entry.WantedLevel < entry.ResidentLevel && !entry.Loading && !entry.Failed)
+			wanting.push_back(&entry);
+	}
+	std::sort(wanting.begin(), wanting.end(), [](const StreamedTexture* a, const StreamedTexture* b)
+	{
+		return a->ResidentLevel - a->WantedLevel > b->ResidentLevel - b->WantedLevel;
+	});
+
+	uint64_t requested = 0;
+	for (StreamedTexture* entry : wanting)
+	{
+		uint32_t level = entry->ResidentLevel - 1;
+		uint64_t size = entry->Layout.Levels[level].Size;
+		if (s_Streamer.LoadsInFlight >= TextureStreamerData::MaxLoadsInFlight || (requested > 0 && requested + size > Texture::GetUploadBudget()))
+			break;
+		if (!MakeRoom(size, entry))
+			break;
+
+		entry->Loading = true;
+		s_Streamer.ReservedBytes += size;
+		s_Streamer.LoadsInFlight++;
+		requested += size;
+
+		JobSystem::Submit([target = entry->Owner, layout = entry->Layout, level]()
+		{
+			GABGL_MEMORY_TAG(Assets);
+			LoadedLevel loaded;
+			loaded.Target = target;
+			loaded.Level = level;
+			loaded.Valid = TextureCooker::ReadLevel(layout, level, loaded.Data);
+
+			std::lock_guard<std::mutex> lock(s_Streamer.LoadedMutex);
+			s_Streamer.Loaded.push_back(std::move(loaded));
+		});
+	}
+}
+
+void TextureStreamer::Init(uint64_t budgetBytes)
+{
+	s_Streamer.Budget = budgetBytes;
+	s_Streamer.Enabled = TextureCooker::IsEnabled();
+	if (!s_Streamer.Enabled)
+		GABGL_WARN("Texture streaming needs the texture cache, textures load every level");
+}
+
+void TextureStreamer::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_Streamer.LoadedMutex);
+		s_Streamer.Loaded.clear();
+	}
+	s_Streamer.Textures.clear();
+	s_Streamer.SparsePageSizes.clear();
+	s_Streamer.ResidentBytes = s_Streamer.ReservedBytes = 0;
+	s_Streamer.LoadsInFlight = 0;
+	s_Streamer.Enabled = false;
+}
+
+bool TextureStreamer::IsEnabled()
+{
+	return s_Streamer.Enabled;
+}
+
+void TextureStreamer::ReportUsage(Handle<Texture> texture, const glm::vec2& screenPixels)
+{
+	StreamedTexture* entry = GetEntry(texture.Get());
+	if (!entry)
+		return;
+
+	// Texels per pixel along the denser axis, each halving is one level coarser
+	float ratio = std::max(entry->Layout.Width / std::max(screenPixels.x, 1.0f), entry->Layout.Height / std::max(screenPixels.y, 1.0f));
+	uint32_t level = ratio > 1.0f ? (uint32_t)std::log2(ratio) : 0;
+	entry->RequestedLevel = std::min(entry->RequestedLevel, level);
+}
+
+void TextureStreamer::Update()
+{
+	GABGL_PROFILE_SCOPE("TextureStreamer::Update");
+
+	if (!s_Streamer.Enabled)
+		return;
+
+	ApplyLoadedLevels();
+
+	s_Streamer.Frame++;
+	for (StreamedTexture& entry : s_Streamer.Textures)
+	{
+		if (entry.RequestedLevel == StreamedTexture::NoRequest)
+			continue;
+
+		entry.WantedLevel = std::min(entry.RequestedLevel, entry.TailLevel);
+		entry.LastUsedFrame = s_Streamer.Frame;
+		entry.RequestedLevel = StreamedTexture::NoRequest;
+	}
+
+	MakeRoom(0, nullptr);
+	RequestLevels();
+}
+
+void TextureStreamer::SetBudget(uint64_t bytes)
+{
+	s_Streamer.Budget = bytes;
+}
+
+uint64_t TextureStreamer::GetBudget()
+{
+	return s_Streamer.Budget;
+}
+
+TextureStreamer::Statistics TextureStreamer::GetStats()
+{
+	Statistics stats;
+	stats.Textures = (uint32_t)s_Streamer.Textures.size();
+	stats.LoadsInFlight = s_Streamer.LoadsInFlight;
+	stats.ResidentBytes = s_Streamer.ResidentBytes;
+	for (const StreamedTexture& entry : s_Streamer.Textures)
+		stats.FullBytes += entry.Layout.GetDataSize(0);
+	stats.LevelsLoaded = s_Streamer.LevelsLoaded;
+	stats.LevelsEvicted = s_Streamer.LevelsEvicted;
+	return stats;
+}
+
+uint32_t TextureStreamer::CreateStorage(const CookedTexture& cooked, bool& sparse, uint32_t& baseLevel)
+{
+	sparse = Utils::IsSparseSupported(cooked);
+	if (!sparse)
+	{
+		baseLevel = cooked.FirstLevel;
+		return cooked.CreateStorage(cooked.FirstLevel);
+	}
+
+	// Every level is addressed directly, the tail is committed once and stays
+	baseLevel = 0;
+	uint32_t rendererID = cooked.CreateStorage(0, true);
+	GLint sparseLevels = 0;
+	glGetTextureParameteriv(rendererID, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels);
+	for (uint32_t level = std::min((uint32_t)sparseLevels, cooked.FirstLevel); level < cooked.Levels.size(); level++)
+		Utils::CommitLevel(rendererID, cooked, level, true);
+	glTextureParameteri(rendererID, GL_TEXTURE_BASE_LEVEL, cooked.FirstLevel);
+	return rendererID;
+}
+
+void TextureStreamer::Register(Handle<Texture> texture, const CookedTexture& cooked, bool sparse)
+{
+	StreamedTexture entry;
+	entry.Owner = texture;
+	entry.Layout.Compression = cooked.Compression;
+	entry.Layout.Width = cooked.Width;
+	entry.Layout.Height = cooked.Height;
+	entry.Layout.Channels = cooked.Channels;
+	entry.Layout.Levels = cooked.Levels;
+	entry.Layout.Key = cooked.Key;
+	entry.Sparse = sparse;
+	entry.ResidentLevel = entry.TailLevel = entry.WantedLevel = cooked.FirstLevel;
+	entry.LastUsedFrame = s_Streamer.Frame;
+
+	if (sparse)
+	{
+		GLint sparseLevels = 0;
+		glGetTextureParameteriv(texture->m_RendererID, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels);
+		entry.SparseLevels = (uint32_t)sparseLevels;
+	}
+
+	texture->m_StreamIndex = (uint32_t)s_Streamer.Textures.size();
+	s_Streamer.ResidentBytes += Utils::GetResidentBytes(entry);
+	s_Streamer.Textures.push_back(std::move(entry));
+}
+
+void TextureStreamer::Unregister(Texture* texture)
+{
+	StreamedTexture* entry = GetEntry(texture);
+	if (!entry)
+		return;
+
+	s_Streamer.ResidentBytes -= Utils::GetResidentBytes(*entry);
+	if (entry->Loading)
+		s_Streamer.ReservedBytes -= entry->Layout.Levels[entry->ResidentLevel - 1].Size;
+
+	uint32_t index = texture->m_StreamIndex;
+	texture->m_StreamIndex = Texture::NotStreamed;
+	if (index + 1 != s_Streamer.Textures.size())
+	{
+		s_Streamer.Textures[index] = std::move(s_Streamer.Textures.back());
+		if (Texture* moved = s_Streamer.Textures[index].Owner.Get())
+			moved->m_StreamIndex = index;
+	}
+	s_Streamer.Textures.pop_back();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <glm/glm.hpp>
+
+struct StreamedTexture;
+
+// Keeps VRAM bounded by the levels textures are actually drawn at. Async loads of cooked textures
+// start with only the levels up to ResidentTailSize; renderers report how large each texture
+// appears on screen, and finer levels are read one at a time from the texture cache as they are
+// needed. Over the budget, the least recently drawn textures drop back towards their tail.
+//
+// With GL_ARB_sparse_texture the full chain is reserved once and levels are committed and
+// decommitted in place, sampling clamped by GL_TEXTURE_BASE_LEVEL. Without it the texture is
+// reallocated with just the resident levels and the ones it keeps are copied on the GPU.
+struct TextureStreamer
+{
+	static constexpr uint64_t DefaultBudget = 256ull * 1024 * 1024;
+	// Levels this size and smaller are loaded with the texture and never evicted
+	static constexpr uint32_t ResidentTailSize = 128;
+
+	static void Init(uint64_t budgetBytes = DefaultBudget);
+	// After every texture is destroyed
+	static void Shutdown();
+	static bool IsEnabled();
+
+	// From renderers while drawing: the on-screen size in pixels of one repeat of the texture
+	static void ReportUsage(Handle<Texture> texture, const glm::vec2& screenPixels);
+	// Once per frame on the main thread, after Texture::PollPending(). Turns the last frame's
+	// reports into level loads and evictions and uploads the levels read since
+	static void Update();
+
+	static void SetBudget(uint64_t bytes);
+	static uint64_t GetBudget();
+
+	struct Statistics
+	{
+		uint32_t Textures = 0;
+		uint32_t LoadsInFlight = 0;
+		uint64_t ResidentBytes = 0;
+		// What the same textures take with every level resident
+		uint64_t FullBytes = 0;
+		uint32_t LevelsLoaded = 0;
+		uint32_t LevelsEvicted = 0;
+	};
+
+	static Statistics GetStats();
+
+private:
+	friend struct Texture;
+
+	// Storage for a partial cooked load, sparse when the format allows and the top level is a whole
+	// number of pages. baseLevel is the level GL level 0 holds, for CookedTexture::Upload()
+	static uint32_t CreateStorage(const CookedTexture& cooked, bool& sparse, uint32_t& baseLevel);
+	static void Register(Handle<Texture> texture, const CookedTexture& cooked, bool sparse);
+	static void Unregister(Texture* texture);
+
+	static StreamedTexture* GetEntry(Texture* texture);
+	// Moves the finest resident level to level. Growing is one level at a time with its data,
+	// shrinking drops any number of levels
+	static void SetResidentLevel(StreamedTexture& entry, Texture& texture, uint32_t level, const uint8_t* data);
+	static void ApplyLoadedLevels();
+	static bool MakeRoom(uint64_t incoming, const StreamedTexture* except);
+	static void RequestLevels();
+};
@@ -0,0 +1,109 @@
+#include "UniformCache.h"
+#include "../Backend/BackendLogger.h"
+
+void UniformCache::Build(GLuint program)
+{
+	Clear();
+	m_Program = program;
+
+	GLint uniformCount = 0, maxNameLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	struct Uniform
+	{
+		std::string Name;
+		GLint Size;
+	};
+	std::vector<Uniform> uniforms;
+	uniforms.reserve(uniformCount);
+
+	uint32_t nameCount = 0;
+	std::vector<char> nameBuffer(maxNameLength + 1);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+		// Members of uniform blocks have no location
+		std::string name(nameBuffer.data(), length);
+		if (glGetUniformLocation(program, name.c_str()) == -1)
+			continue;
+
+		uniforms.push_back({ name, size });
+		nameCount += size + 1;
+	}
+
+	uint32_t capacity = 16;
+	while (capacity < nameCount * 2)
+		capacity *= 2;
+	m_Entries.resize(capacity);
+	m_Mask = capacity - 1;
+#ifdef DEBUG
+	m_Names.resize(capacity);
+#endif
+
+	for (const auto& uniform : uniforms)
+	{
+		// Arrays come back as "name[0]", register the bare name and every element
+		bool isArray = uniform.Name.size() > 3 && uniform.Name.compare(uniform.Name.size() - 3, 3, "[0]") == 0;
+		if (!isArray)
+		{
+			Insert(HashUniformName(uniform.Name), glGetUniformLocation(program, uniform.Name.c_str()), uniform.Name);
+			continue;
+		}
+
+		std::string baseName = uniform.Name.substr(0, uniform.Name.size() - 3);
+		Insert(HashUniformName(baseName), glGetUniformLocation(program, uniform.Name.c_str()), baseName);
+		for (GLint element = 0; element < uniform.Size; element++)
+		{
+			std::string elementName = baseName + "[" + std::to_string(element) + "]";
+			GLint location = glGetUniformLocation(program, elementName.c_str());
+			if (location != -1)
+				Insert(HashUniformName(elementName), location, elementName);
+		}
+	}
+}
+
+void UniformCache::Clear()
+{
+	m_Entries.clear();
+	m_Mask = 0;
+	m_Count = 0;
+	m_Program = 0;
+#ifdef DEBUG
+	m_Names.clear();
+#endif
+}
+
+void UniformCache::Insert(uint32_t hash, GLint location, const std::string& name)
+{
+	uint32_t i = hash & m_Mask;
+	for (; m_Entries[i].Location != -1; i = (i + 1) & m_Mask)
+	{
+		// Two names sharing a hash would silently alias, refuse the second one
+		if (m_Entries[i].Hash == hash)
+		{
+			GABGL_ERROR("Uniform {0} collides with another uniform of program {1}, it will not be cached", name, m_Program);
+			return;
+		}
+	}
+
+	m_Entries[i] = { hash, location };
+	m_Count++;
+#ifdef DEBUG
+	m_Names[i] = name;
+#endif
+}
+
+#ifdef DEBUG
+void UniformCache::Validate(UniformName name, uint32_t slot) const
+{
+	if (slot == UINT32_MAX)
+		GABGL_WARN("Uniform {0} is not active in program {1}", name.Name, m_Program);
+	else if (m_Names[slot] != name.Name)
+		GABGL_ERROR("Uniform {0} resolved to {1} in program {2}, their hashes collide", name.Name, m_Names[slot], m_Program);
+}
+#endif
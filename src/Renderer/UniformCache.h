@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// FNV-1a, constexpr so literal uniform names are hashed at compile time
+constexpr uint32_t HashUniformName(std::string_view name)
+{
+	uint32_t hash = 2166136261u;
+	for (char c : name)
+	{
+		hash ^= (uint8_t)c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+struct UniformName
+{
+	uint32_t Hash;
+	std::string_view Name;
+
+	template<size_t N>
+	consteval UniformName(const char (&name)[N])
+		: Hash(HashUniformName(std::string_view(name, N - 1))), Name(name, N - 1) {}
+
+	// Names built at runtime have to opt in, they pay for the hash on every call
+	explicit UniformName(std::string_view name)
+		: Hash(HashUniformName(name)), Name(name) {}
+};
+
+// Open addressed table of every active uniform, filled once after linking.
+// Array uniforms are registered per element and under their bare name.
+struct UniformCache
+{
+	void Build(GLuint program);
+	void Clear();
+
+	GLint Find(UniformName name) const
+	{
+		if (m_Entries.empty())
+			return -1;
+
+		for (uint32_t i = name.Hash & m_Mask;; i = (i + 1) & m_Mask)
+		{
+			const Entry& entry = m_Entries[i];
+			if (entry.Location == -1)
+				break;
+			if (entry.Hash == name.Hash)
+			{
+#ifdef DEBUG
+				Validate(name, i);
+#endif
+				return entry.Location;
+			}
+		}
+
+#ifdef DEBUG
+		Validate(name, UINT32_MAX);
+#endif
+		return -1;
+	}
+
+	uint32_t GetUniformCount() const { return m_Count; }
+
+private:
+	void Insert(uint32_t hash, GLint location, const std::string& name);
+#ifdef DEBUG
+	void Validate(UniformName name, uint32_t slot) const;
+#endif
+
+	struct Entry
+	{
+		uint32_t Hash = 0;
+		GLint Location = -1;
+	};
+
+	std::vector<Entry> m_Entries;
+	uint32_t m_Mask = 0;
+	uint32_t m_Count = 0;
+	GLuint m_Program = 0;
+#ifdef DEBUG
+	std::vector<std::string> m_Names;
+#endif
+};
@@ -5,6 +5,7 @@
 #include "SceneCamera.h"
 
 #include <glm/glm.hpp>
+#include <type_traits>
 #include <glm/gtc/matrix_transform.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -69,10 +70,14 @@ struct CameraComponent
     CameraComponent(const CameraComponent&) = default;
 };
 
+// Each sprite owns one TextureLibrary reference to its texture. The scene acquires one when a
+// sprite is added, including copies from Scene::Copy and DuplicateEntity, and releases it when
+// the sprite is removed, its entity destroyed or the scene torn down. To change the texture,
+// release the old one and assign the result of TextureLibrary::Load(), which is already owned.
 struct SpriteComponent
 {
     glm::vec4 Color = glm::vec4(1);
-    Ref<Texture> Texture;
+    Handle<Texture> Texture;
     float TilingFactor = 1.0f;
 
     SpriteComponent() = default;
@@ -80,6 +85,7 @@ struct SpriteComponent
     SpriteComponent(const glm::vec4& color)
         : Color(color) {}
 };
+static_assert(std::is_trivially_copyable_v<SpriteComponent>, "SpriteComponent is copied around by value, keep it POD-like");
 
 struct MeshComponent
 {
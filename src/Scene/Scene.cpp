@@ -2,11 +2,34 @@
 #include "Components.hpp"
 #include "Entity.hpp"
 #include <glm/glm.hpp>
+#include "../Renderer/Renderer.h"
 #include "../Renderer/Renderer2D.h"
+#include "../Renderer/TextureLibrary.h"
+#include "../Backend/MemoryTracker.h"
+#include "../Backend/Profiler.h"
 
-Scene::Scene(){}
+// Every sprite holds its own library reference, see SpriteComponent
+static void AcquireSpriteTexture(entt::registry& registry, entt::entity entity)
+{
+	TextureLibrary::Acquire(registry.get<SpriteComponent>(entity).Texture);
+}
 
-Scene::~Scene(){}
+static void ReleaseSpriteTexture(entt::registry& registry, entt::entity entity)
+{
+	TextureLibrary::Release(registry.get<SpriteComponent>(entity).Texture);
+}
+
+Scene::Scene()
+{
+	m_Registry.on_construct<SpriteComponent>().connect<&AcquireSpriteTexture>();
+	m_Registry.on_destroy<SpriteComponent>().connect<&ReleaseSpriteTexture>();
+}
+
+Scene::~Scene()
+{
+	// The registry's destructor doesn't signal, removing the sprites first releases their textures
+	m_Registry.clear<SpriteComponent>();
+}
 
 template<typename... Component>
 static void CopyComponent(entt::registry& dst, entt::registry& src, const std::unordered_map<UUID, entt::entity>& enttMap)
@@ -48,6 +71,8 @@ static void CopyComponentIfExists(ComponentGroup<Component...>, Entity dst, Enti
 
 Ref<Scene> Scene::Copy(Ref<Scene> other)
 {
+	GABGL_MEMORY_TAG(Scene);
+
 	Ref<Scene> newScene = CreateRef<Scene>();
 
 	newScene->m_ViewportWidth = other->m_ViewportWidth;
@@ -80,6 +105,8 @@ Entity Scene::CreateEntity(const std::string& name)
 
 Entity Scene::CreateEntityWithUUID(UUID uuid, const std::string& name)
 {
+	GABGL_MEMORY_TAG(Scene);
+
 	Entity entity = { m_Registry.create(), this };
 	entity.AddComponent<IDComponent>(uuid);
 	entity.AddComponent<TransformComponent>();
@@ -155,6 +182,7 @@ void Scene::OnUpdateRuntime(DeltaTime dt)
 
 	if (mainCamera)
 	{
+		Renderer::BeginScene(*mainCamera, cameraTransform);
 		Renderer2D::BeginScene(*mainCamera, cameraTransform);
 
 		// Draw sprites
@@ -289,6 +317,9 @@ void Scene::OnPhysics3DStop()
 
 void Scene::RenderScene(EditorCamera& camera)
 {
+	GABGL_PROFILE_SCOPE("Scene::RenderScene");
+
+	Renderer::BeginScene(camera);
 	Renderer2D::BeginScene(camera);
 
 	//// Draw sprites
@@ -1,4 +1,8 @@
 #include "Engine.h"
+#include "Backend/FrameTelemetry.h"
+#include "Renderer/GLIntercept.h"
+
+#include <cstring>
 
 // Prevent accidentally selecting integrated GPU
 extern "C" {
@@ -6,7 +10,23 @@ extern "C" {
 	__declspec(dllexport) unsigned __int32 NvOptimusEnablement = 0x1;
 }
 
-int main()
+int main(int argc, char** argv)
 {
-	Engine engine;
+	// --telemetry <file.csv|file.json> dumps frame timings on exit
+	// --gl-stats counts every GL call per frame and profiler zone
+	const char* telemetryPath = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc)
+			telemetryPath = argv[++i];
+		else if (strcmp(argv[i], "--gl-stats") == 0)
+			GLIntercept::SetEnabled(true);
+	}
+
+	{
+		Engine engine;
+	}
+
+	if (telemetryPath)
+		FrameTelemetry::Export(telemetryPath);
 }
@@ -1,6 +1,7 @@
 #include "Engine.h"
 #include "Window.h"
 #include "Scene.h"
+#include "../src/Backend/FrameArena.h"
 #include <cassert>
 
 /*#include <TracyClient.cpp> // PROFILER //*/
@@ -10,10 +11,12 @@
 void Engine::Run() {
 
     Window::Init();
+    FrameArena::Init();
     Scene scene;
 
     while (Window::WindowIsOpen() && Window::WindowHasNotBeenForceClosed())
     {
+        FrameArena::BeginFrame();
         Window::BeginFrame();
 
         if(!scene.isLoadingDone()){
@@ -7,9 +7,11 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
-#include <iostream>
 #include "../Input/Input.h"
 #include "../Utilities.hpp"
+#include "../../src/Backend/BackendLogger.h"
+#include "../../src/Backend/MemoryTracker.h"
+#include "../../src/Renderer/RendererAPI.h"
 
 
 static unsigned int quadVAO = 0;
@@ -28,7 +30,7 @@ static void renderQuad()
         // setup plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        RendererAPI::BindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -36,9 +38,9 @@ static void renderQuad()
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    RendererAPI::BindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    RendererAPI::BindVertexArray(0);
 }
 
 
@@ -83,7 +85,7 @@ bool bloomFBO::Init(unsigned int windowWidth, unsigned int windowHeight, unsigne
 	glm::ivec2 mipIntSize((int)windowWidth, (int)windowHeight);
 	// Safety check
 	if (windowWidth > (unsigned int)INT_MAX || windowHeight > (unsigned int)INT_MAX) {
-		std::cerr << "Window size conversion overflow - cannot build bloom FBO!" << std::endl;
+		GABGL_ERROR("Window size conversion overflow - cannot build bloom FBO!");
 		return false;
 	}
 
@@ -107,7 +109,8 @@ bool bloomFBO::Init(unsigned int windowWidth, unsigned int windowHeight, unsigne
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-		std::cout << "Created bloom mip " << mipIntSize.x << 'x' << mipIntSize.y << std::endl;
+		MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, MemoryTracker::GetTextureBytes((uint32_t)mipSize.x, (uint32_t)mipSize.y, 4));
+		GABGL_TRACE("Created bloom mip {0}x{1}", mipIntSize.x, mipIntSize.y);
 		mMipChain.emplace_back(mip);
 	}
 
@@ -136,6 +139,7 @@ void bloomFBO::Destroy()
 {
 	for (int i = 0; i < (int)mMipChain.size(); i++) {
 		glDeleteTextures(1, &mMipChain[i].texture);
+		MemoryTracker::TrackGPUFree(GPUMemoryKind::Texture, MemoryTracker::GetTextureBytes((uint32_t)mMipChain[i].size.x, (uint32_t)mMipChain[i].size.y, 4));
 		mMipChain[i].texture = 0;
 	}
 	glDeleteFramebuffers(1, &mFBO);
@@ -158,6 +162,7 @@ void bloomFBO::Resize(unsigned int windowWidth, unsigned int windowHeight, unsig
     // Clear the existing mip chain
     for (int i = 0; i < (int)mMipChain.size(); i++) {
         glDeleteTextures(1, &mMipChain[i].texture);
+        MemoryTracker::TrackGPUFree(GPUMemoryKind::Texture, MemoryTracker::GetTextureBytes((uint32_t)mMipChain[i].size.x, (uint32_t)mMipChain[i].size.y, 4));
         mMipChain[i].texture = 0;
     }
     mMipChain.clear(); // Clear the vector to start fresh
@@ -185,7 +190,8 @@ void bloomFBO::Resize(unsigned int windowWidth, unsigned int windowHeight, unsig
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-        std::cout << "Resized bloom mip " << mipIntSize.x << 'x' << mipIntSize.y << std::endl;
+        MemoryTracker::TrackGPUAlloc(GPUMemoryKind::Texture, MemoryTracker::GetTextureBytes((uint32_t)mipSize.x, (uint32_t)mipSize.y, 4));
+        GABGL_TRACE("Resized bloom mip {0}x{1}", mipIntSize.x, mipIntSize.y);
         mMipChain.emplace_back(mip);
     }
 
@@ -247,7 +253,7 @@ bool BloomRenderer::Init()
   glDrawBuffers(2, attachments);
   // finally check if framebuffer is complete
   if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-      std::cout << "Framebuffer not complete!" << std::endl;
+      GABGL_ERROR("Framebuffer not complete!");
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
   // ping-pong-framebuffer for blurring
@@ -265,7 +271,7 @@ bool BloomRenderer::Init()
       glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pingpongColorbuffers[i], 0);
       // also check if framebuffers are complete (no need for depth buffer)
       if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-          std::cout << "Framebuffer not complete!" << std::endl;
+          GABGL_ERROR("Framebuffer not complete!");
   }
 
 	mSrcViewportSize = glm::ivec2(Window::GetWindowWidth(), Window::GetWindowHeight());
@@ -275,7 +281,7 @@ bool BloomRenderer::Init()
 	const unsigned int num_bloom_mips = 6; // TODO: Play around with this value
 	bool status = mFBO.Init(Window::GetWindowWidth(), Window::GetWindowHeight(), num_bloom_mips);
 	if (!status) {
-		std::cerr << "Failed to initialize bloom FBO - cannot create bloom renderer!\n";
+		GABGL_ERROR("Failed to initialize bloom FBO - cannot create bloom renderer!");
 		return false;
 	}
 
@@ -283,12 +289,12 @@ bool BloomRenderer::Init()
 	// Downsample
   mDownsampleShader.Use();
   mDownsampleShader.setInt("srcTexture", 0);
-  glUseProgram(0);
+  RendererAPI::UseProgram(0);
 
   // Upsample
   mUpsampleShader.Use();
   mUpsampleShader.setInt("srcTexture", 0);
-  glUseProgram(0);
+  RendererAPI::UseProgram(0);
 
   return true;
 }
@@ -302,6 +308,7 @@ void BloomRenderer::Destroy()
 
 void BloomRenderer::RenderDownsamples(unsigned int srcTexture)
 {
+	GABGL_PROFILE_GPU_SCOPE("Bloom Downsample");
 	const std::vector<bloomMip>& mipChain = mFBO.MipChain();
 
 	mDownsampleShader.Use();
@@ -333,11 +340,12 @@ void BloomRenderer::RenderDownsamples(unsigned int srcTexture)
 		if (i == 0) { mDownsampleShader.setInt("mipLevel", 1); }
 	}
 
-	glUseProgram(0);
+	RendererAPI::UseProgram(0);
 }
 
 void BloomRenderer::RenderUpsamples(float filterRadius)
 {
+	GABGL_PROFILE_GPU_SCOPE("Bloom Upsample");
 	const std::vector<bloomMip>& mipChain = mFBO.MipChain();
 
 	mUpsampleShader.Use();
@@ -370,7 +378,7 @@ void BloomRenderer::RenderUpsamples(float filterRadius)
 	/*glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);*/
 	glDisable(GL_BLEND);
 
-	glUseProgram(0);
+	RendererAPI::UseProgram(0);
 }
 
 void BloomRenderer::RenderBloomTexture(float filterRadius)
@@ -398,7 +406,7 @@ void BloomRenderer::Resize(int newWidth, int newHeight) {
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, newWidth, newHeight);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "ERROR::FRAMEBUFFER:: Framebuffer is not complete after resizing!" << '\n';
+        GABGL_ERROR("Framebuffer is not complete after resizing!");
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -5,6 +5,7 @@
 #include "Window.h"
 #include "glad/glad.h"
 #include "Renderer.h"
+#include "../../src/Renderer/RendererAPI.h"
 
 struct Framebuffer
 {
@@ -15,6 +16,7 @@ struct Framebuffer
 
   ~Framebuffer(){
     glDeleteVertexArrays(1, &_VAO);
+    RendererAPI::OnVertexArrayDeleted(_VAO);
     glDeleteBuffers(1, &_VBO);
     glDeleteFramebuffers(1, &_FBO);
     glDeleteRenderbuffers(1, &_RBO);
@@ -116,7 +118,7 @@ private:
         // setup plane VAO
         glGenVertexArrays(1, &_VAO);
         glGenBuffers(1, &_VBO);
-        glBindVertexArray(_VAO);
+        RendererAPI::BindVertexArray(_VAO);
         glBindBuffer(GL_ARRAY_BUFFER, _VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -124,9 +126,9 @@ private:
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
-    glBindVertexArray(_VAO);
+    RendererAPI::BindVertexArray(_VAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    RendererAPI::BindVertexArray(0);
   }
 
 
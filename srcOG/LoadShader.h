@@ -7,6 +7,9 @@
 #include <sstream>
 #include <iostream>
 #include <unordered_map>
+#include "../src/Renderer/UniformCache.h"
+#include "../src/Renderer/ShaderVariant.h"
+#include "../src/Renderer/RendererAPI.h"
 
 struct Shader {
 
@@ -16,7 +19,8 @@ struct Shader {
       this->~Shader();
     }
     
-    void Load(const char* fullshader)
+    // variantMask picks which "#pragma variant" keywords get defined, all of them by default
+    void Load(const char* fullshader, uint32_t variantMask = ShaderVariant::AllVariants)
     {
       std::ifstream shaderFile(fullshader);
       shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -30,6 +34,10 @@ struct Shader {
           return;
       }
 
+      m_VariantKeywords = ShaderVariant::ParseKeywords(fileContent);
+      if (!m_VariantKeywords.empty())
+          fileContent = ShaderVariant::InjectDefines(fileContent, m_VariantKeywords, variantMask);
+
       // Parse the shader file into sections based on #type
       std::unordered_map<std::string, std::string> shaderSources;
       const std::string typeToken = "#type";
@@ -111,6 +119,7 @@ struct Shader {
       if (compute != 0) glAttachShader(this->m_ID, compute);
       glLinkProgram(this->m_ID);
       checkCompileErrors(this->m_ID, "PROGRAM");
+      m_Uniforms.Build(this->m_ID);
 
       // Validate the program
       glValidateProgram(this->m_ID);
@@ -204,6 +213,7 @@ struct Shader {
             glAttachShader(this->m_ID, geometry);
         glLinkProgram(this->m_ID);
         checkCompileErrors(this->m_ID, "PROGRAM");
+        m_Uniforms.Build(this->m_ID);
         
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -213,7 +223,7 @@ struct Shader {
 
     void Use() const
     {
-        glUseProgram(this->m_ID);
+        RendererAPI::UseProgram(this->m_ID);
     }
 
     GLuint getID() const 
@@ -221,66 +231,77 @@ struct Shader {
       return this->m_ID;
     }
 
-    void setBool(const std::string& name, bool value) const
+    void setBool(UniformName name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(this->m_ID, name.c_str()), (int)value);
+        glUniform1i(m_Uniforms.Find(name), (int)value);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
+    void setInt(UniformName name, int value) const
     {
-        glUniform1i(glGetUniformLocation(this->m_ID, name.c_str()), value);
+        glUniform1i(m_Uniforms.Find(name), value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setFloat(UniformName name, float value) const
     {
-        glUniform1f(glGetUniformLocation(this->m_ID, name.c_str()), value);
+        glUniform1f(m_Uniforms.Find(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+    void setVec2(UniformName name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(m_Uniforms.Find(name), 1, &value[0]);
     }
-    void setVec2(const std::string& name, float x, float y) const
+    void setVec2(UniformName name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(this->m_ID, name.c_str()), x, y);
+        glUniform2f(m_Uniforms.Find(name), x, y);
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void setVec3(UniformName name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(m_Uniforms.Find(name), 1, &value[0]);
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    void setVec3(UniformName name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(this->m_ID, name.c_str()), x, y, z);
+        glUniform3f(m_Uniforms.Find(name), x, y, z);
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void setVec4(UniformName name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(m_Uniforms.Find(name), 1, &value[0]);
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w) const
+    void setVec4(UniformName name, float x, float y, float z, float w) const
     {
-        glUniform4f(glGetUniformLocation(this->m_ID, name.c_str()), x, y, z, w);
+        glUniform4f(m_Uniforms.Find(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void setMat2(UniformName name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(m_Uniforms.Find(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void setMat3(UniformName name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(m_Uniforms.Find(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat4(UniformName name, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(m_Uniforms.Find(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4Array(UniformName name, const glm::mat4* mats, uint32_t count) const
+    {
+        glUniformMatrix4fv(m_Uniforms.Find(name), (GLsizei)count, GL_FALSE, &mats[0][0][0]);
+    }
+
+    uint32_t GetVariantMask(std::initializer_list<std::string_view> keywords) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(this->m_ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        return ShaderVariant::GetMask(m_VariantKeywords, keywords);
     }
 
 private:
 
     GLuint m_ID;
+    UniformCache m_Uniforms;
+    std::vector<std::string> m_VariantKeywords;
 
     void checkCompileErrors(GLuint shader, std::string type)
     {
@@ -1,7 +1,31 @@
 #pragma once
 #include <iostream>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "glad/glad.h"
 #include "stb_image.h"
+#include "../src/Renderer/ImageKernels.h"
+
+// Uploads level 0 of the bound GL_TEXTURE_2D. RGB is expanded to RGBA, drivers pad 3-byte texels
+// anyway, and 1 and 2 channel rows are unpacked byte aligned so odd widths don't skew
+inline void UploadTextureImage(const unsigned char* data, int width, int height, int nrComponents) {
+    std::vector<unsigned char> expanded;
+    if (nrComponents == 3) {
+        expanded.resize((size_t)width * height * 4);
+        ImageKernels::ExpandRGBToRGBA(data, expanded.data(), (size_t)width * height);
+        data = expanded.data();
+        nrComponents = 4;
+    }
+
+    GLenum format = (nrComponents == 1) ? GL_RED : (nrComponents == 2) ? GL_RG : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
 
 inline unsigned int loadTexture(const char* path){
     unsigned int textureID;
@@ -11,16 +35,8 @@ inline unsigned int loadTexture(const char* path){
     unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
     if (data)
     {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        UploadTextureImage(data, width, height, nrComponents);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -39,18 +55,75 @@ inline unsigned int loadTexture(const char* path){
     return textureID;
 }
 
+// Model textures are shared by the whole process: every model, mesh and material asking for the
+// same file gets the same GL texture. Files are matched by canonical path and then by a hash of
+// their bytes, so one image copied next to several models is uploaded once as well.
+struct SharedTextures {
+    std::unordered_map<std::string, unsigned int> byPath;
+    std::unordered_map<uint64_t, unsigned int> byContent;
+};
+
+inline SharedTextures& GetSharedTextures() {
+    static SharedTextures s_SharedTextures;
+    return s_SharedTextures;
+}
+
+// FNV-1a over the file, 0 when it can't be read
+inline uint64_t HashTextureFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        return 0;
+
+    uint64_t hash = 14695981039346656037ull;
+    char buffer[64 * 1024];
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        for (std::streamsize i = 0; i < file.gcount(); ++i) {
+            hash ^= (uint8_t)buffer[i];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+inline unsigned int LoadTextureFile(const std::string& filename);
+
 inline unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma = false) {
     std::string filename = directory + '/' + path;
+    SharedTextures& shared = GetSharedTextures();
+
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(filename, error);
+    std::string pathKey = error ? filename : canonical.generic_string();
+    auto byPath = shared.byPath.find(pathKey);
+    if (byPath != shared.byPath.end())
+        return byPath->second;
+
+    uint64_t contentKey = HashTextureFile(filename);
+    auto byContent = shared.byContent.find(contentKey);
+    if (contentKey && byContent != shared.byContent.end()) {
+        shared.byPath[pathKey] = byContent->second;
+        return byContent->second;
+    }
 
+    unsigned int textureID = LoadTextureFile(filename);
+    if (textureID && contentKey) {
+        shared.byPath[pathKey] = textureID;
+        shared.byContent[contentKey] = textureID;
+    }
+    return textureID;
+}
+
+// Always decodes and uploads, 0 when the file can't be loaded
+inline unsigned int LoadTextureFile(const std::string& filename) {
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
     int width, height, nrComponents;
     unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
     if (data) {
-        GLenum format = (nrComponents == 1) ? GL_RED : (nrComponents == 3) ? GL_RGB : GL_RGBA;
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        UploadTextureImage(data, width, height, nrComponents);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -60,8 +133,9 @@ inline unsigned int TextureFromFile(const char* path, const std::string& directo
 
         stbi_image_free(data);
     } else {
-        std::cerr << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        std::cerr << "Texture failed to load at path: " << filename << std::endl;
+        glDeleteTextures(1, &textureID);
+        textureID = 0;
     }
 
     return textureID;
@@ -73,12 +147,10 @@ inline unsigned int TextureFromMemory(const unsigned char* data, size_t dataSize
     // Load the texture from memory
     unsigned char* imageData = stbi_load_from_memory(data, static_cast<int>(dataSize), &width, &height, &nrComponents, 0);
     if (imageData) {
-        GLenum format = (nrComponents == 1) ? GL_RED : (nrComponents == 3) ? GL_RGB : GL_RGBA;
-
         unsigned int textureID;
         glGenTextures(1, &textureID);
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, imageData);
+        UploadTextureImage(imageData, width, height, nrComponents);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
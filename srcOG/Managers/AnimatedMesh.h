@@ -14,7 +14,9 @@
 #include "../LoadTexture.h"
 #include "Assimp_glm_helpers.h"
 #include "Animdata.h"
+#include "../../src/Backend/MemoryTracker.h"
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <map>
@@ -36,6 +38,7 @@ struct AnimatedMesh {
     AnimatedMesh() = default;
     AnimatedMesh(const std::string& path, bool gamma = false) 
         : gammaCorrection(gamma), scene(nullptr) {
+        GABGL_MEMORY_TAG(Assets);
         loadModel(path);
     }
 
@@ -127,6 +130,16 @@ private:
             mat->GetTexture(type, i, &str);
 
             if (str.C_Str()[0] == '*') {
+                // Embedded textures belong to this file, meshes sharing a material reuse the upload
+                auto loaded = std::find_if(texturesLoaded.begin(), texturesLoaded.end(),
+                    [&](const Texture& texture) { return texture.path == str.C_Str(); });
+                if (loaded != texturesLoaded.end()) {
+                    Texture embeddedTexture = *loaded;
+                    embeddedTexture.type = typeName;
+                    textures.emplace_back(embeddedTexture);
+                    continue;
+                }
+
                 const aiTexture* texture = scene->GetEmbeddedTexture(str.C_Str());
                 if (texture) {
                     GLuint textureID;
@@ -137,9 +150,10 @@ private:
                     embeddedTexture.type = typeName;
                     embeddedTexture.path = str.C_Str();
                     textures.emplace_back(embeddedTexture);
+                    texturesLoaded.emplace_back(embeddedTexture);
                 }
             } else {
-                // Handle external textures
+                // External textures are shared across models by TextureFromFile
                 Texture externalTexture;
                 externalTexture.id = TextureFromFile(str.C_Str(), directory);
                 externalTexture.type = typeName;
@@ -16,7 +16,7 @@ struct AnimatedModel {
 
     AnimatedModel() = default;
 
-    AnimatedModel(const std::string& modelpath) : loadmodel(modelpath), animation(modelpath, &loadmodel) {}
+    AnimatedModel(const std::string& modelpath) : loadmodel(modelpath), animation(modelpath, loadmodel.GetBoneInfoMap(), loadmodel.GetBoneCount()) {}
 
     ~AnimatedModel() noexcept = default;
 
@@ -27,7 +27,6 @@ struct AnimatedModel {
         if(Input::KeyPressed(KEY_1)) animation.SetAnimationByName("WALK");
 
         _shader.Use();
-        _shader.setVec3("viewPos", this->camera.Position);
 
         // light properties
         _shader.setFloat("light.constant", 1.0f);
@@ -37,16 +36,8 @@ struct AnimatedModel {
         // material properties
         _shader.setFloat("material.shininess", 5.0f);
 
-        glm::mat4 projection = glm::perspective(glm::radians(this->camera.Zoom), Window::getAspectRatio(), 0.001f, 2000.0f);
-        _shader.setMat4("projection", projection);
-
-        glm::mat4 view = this->camera.GetViewMatrix();
-        _shader.setMat4("view", view);
-
-        auto transforms = animation.GetFinalBoneMatrices();
-        for (size_t i = 0; i < transforms.size(); ++i) {
-            _shader.setMat4("finalBonesMatrices[" + std::to_string(i) + "]", transforms[i]);
-        }
+        const auto& transforms = animation.GetFinalBoneMatrices();
+        _shader.setMat4Array("finalBonesMatrices", transforms.data(), (uint32_t)transforms.size());
 
         Utilities::Transform transform;
         transform.position = position;
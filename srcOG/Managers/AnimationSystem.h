@@ -1,13 +1,18 @@
 #pragma once
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <string>
 #include <vector>
 #include <map>
 #include <glm/glm.hpp>
+#include <assimp/Importer.hpp>
 #include <assimp/scene.h>
+#include <assimp/postprocess.h>
 #include "Bone.h"
 #include "Animdata.h"
-#include "AnimatedMesh.h"
+#include "../../src/Backend/BackendLogger.h"
 
 struct AssimpNodeData
 {
@@ -30,10 +35,9 @@ struct AnimationSystem {
     ~AnimationSystem() = default;
 
     AnimationSystem() = default;
-    AnimationSystem(const std::string& animationPath, AnimatedMesh* model) : model(model), m_CurrentAnimationIndex(0)
+    // Only needs the bone table of the skinned mesh, so it can be built without a GL context
+    AnimationSystem(const std::string& animationPath, std::map<std::string, BoneInfo>& boneInfoMap, int& boneCount) : m_CurrentAnimationIndex(0)
     {
-        assert(model);
-
         Assimp::Importer importer;
         scene = importer.ReadFile(animationPath, aiProcess_Triangulate);
 
@@ -49,11 +53,11 @@ struct AnimationSystem {
             animData.ticksPerSecond = animation->mTicksPerSecond;
 
             ReadHierarchyData(animData.hierarchy, scene->mRootNode);
-            ReadMissingBones(animation, *model);
+            ReadMissingBones(animation, boneInfoMap, boneCount);
 
             animData.bones = m_Bones;
 
-            std::cout << "Animation at index: " << i << " " << animData.name << '\n';
+            GABGL_INFO("Animation at index: {0} {1}", i, animData.name);
 
             m_ProcessedAnimations.emplace_back(animData);
         }
@@ -102,7 +106,7 @@ struct AnimationSystem {
             int animationIndex = std::distance(m_ProcessedAnimations.begin(), it);
             SetAnimationbyIndex(animationIndex); 
         } else {
-            std::cerr << "Animation not found: " << animationName << '\n';
+            GABGL_WARN("Animation not found: {0}", animationName);
         }
     }
 
@@ -139,7 +143,7 @@ struct AnimationSystem {
         }
     }
 
-    std::vector<glm::mat4> GetFinalBoneMatrices() const
+    const std::vector<glm::mat4>& GetFinalBoneMatrices() const
     {
         return m_FinalBoneMatrices;
     }
@@ -176,7 +180,6 @@ private:
     bool m_IsBlending = false;
     int m_NextAnimationIndex = -1;
     std::vector<AnimationData> m_ProcessedAnimations;
-    AnimatedMesh* model;
     const aiScene* scene = nullptr;
     int m_CurrentAnimationIndex;
     float m_Duration;
@@ -202,7 +205,7 @@ private:
         {
             if (src->mChildren[i] == nullptr) 
             {
-                std::cerr << "Null child node found at index " << i << std::endl;
+                GABGL_WARN("Null child node found at index {0}", i);
                 continue;  // Skip if child node is null
             }
 
@@ -212,12 +215,9 @@ private:
         }
     }
 
-    void ReadMissingBones(const aiAnimation* animation, AnimatedMesh& model)
+    void ReadMissingBones(const aiAnimation* animation, std::map<std::string, BoneInfo>& boneInfoMap, int& boneCount)
     {
         assert(animation);  
-        assert(&model);
-        auto& boneInfoMap = model.GetBoneInfoMap();
-        int& boneCount = model.GetBoneCount();
 
         m_Bones.clear();
         boneCount = 0;
@@ -19,6 +19,7 @@ struct EnvironmentMap {
     {
         glDeleteBuffers(1, &_VBO);
         glDeleteVertexArrays(1, &_VAO);
+        RendererAPI::OnVertexArrayDeleted(_VAO);
         glDeleteTextures(1, &_texture);
     }
 
@@ -26,7 +27,7 @@ struct EnvironmentMap {
     {
         glGenVertexArrays(1, &_VAO);
         glGenBuffers(1, &_VBO);
-        glBindVertexArray(_VAO);
+        RendererAPI::BindVertexArray(_VAO);
         glBindBuffer(GL_ARRAY_BUFFER, _VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -41,9 +42,9 @@ struct EnvironmentMap {
             "../res/skybox/NightSky_Front.png",
             "../res/skybox/NightSky_Back.png"
         };
-        stbi_set_flip_vertically_on_load(false);
+        stbi_set_flip_vertically_on_load_thread(false);
         _texture = loadCubemap(faces);
-        stbi_set_flip_vertically_on_load(true);
+        stbi_set_flip_vertically_on_load_thread(true);
 
         puts("EnvMap loaded");
     }
@@ -52,16 +53,12 @@ struct EnvironmentMap {
     {
         glDepthFunc(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
         _shader.Use();
-        glm::mat4 projection = glm::perspective(glm::radians(this->_camera.Zoom), Window::getAspectRatio(), 0.001f, 2000.0f);
-        glm::mat4 view = glm::mat4(glm::mat3(this->_camera.GetViewMatrix())); // remove translation from the view matrix
-        _shader.setMat4("view", view);
-        _shader.setMat4("projection", projection);
         // skybox cube
-        glBindVertexArray(_VAO);
+        RendererAPI::BindVertexArray(_VAO);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_CUBE_MAP, _texture);
         glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
+        RendererAPI::BindVertexArray(0);
         glDepthFunc(GL_LESS); // set depth function back to default
     }
 
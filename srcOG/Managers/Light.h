@@ -17,6 +17,7 @@ struct Light{
     ~Light() noexcept {
         glDeleteBuffers(1, &_VBO);
         glDeleteVertexArrays(1, &_VAO);
+        RendererAPI::OnVertexArrayDeleted(_VAO);
     }
 
     glm::vec4 setLightColor(const glm::vec4& color){
@@ -29,7 +30,7 @@ struct Light{
         glGenVertexArrays(1, &_VAO);
         glGenBuffers(1, &_VBO);
 
-        glBindVertexArray(_VAO);
+        RendererAPI::BindVertexArray(_VAO);
 
         glBindBuffer(GL_ARRAY_BUFFER, _VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -45,13 +46,10 @@ struct Light{
     void Render(const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f))
     { 
         _shader.Use();
-        glm::mat4 projection = glm::perspective(glm::radians(this->_camera.Zoom), Window::getAspectRatio(), 0.001f, 2000.0f);
-        _shader.setMat4("projection", projection);
-        _shader.setMat4("view", this->_camera.GetViewMatrix());
 
         _shader.setVec4("lightColor",lightColor);
 
-        glBindVertexArray(_VAO);
+        RendererAPI::BindVertexArray(_VAO);
 
         Utilities::Transform transform;
         transform.position = position;
@@ -7,6 +7,7 @@
 #include <memory>
 #include "Light.h"
 #include "../LoadSSBO.h" 
+#include "../../src/Backend/FrameArena.h"
 #include "glad/glad.h"
 #include "glm/fwd.hpp"
 #include <optional>
@@ -125,7 +126,7 @@ private:
         
         size_t alignedVec4Size = 16; // vec3 aligned to vec4 size (12 bytes data + 4 bytes padding)
         size_t bufferSizePositions = numLights * alignedVec4Size;
-        std::vector<int8_t> bufferPositions(bufferSizePositions);
+        FrameVector<int8_t> bufferPositions(bufferSizePositions);
 
         for (size_t i = 0; i < lights.size(); ++i) {
             std::memcpy(bufferPositions.data() + (i * alignedVec4Size), &lights[i].second.position, sizeof(glm::vec3));
@@ -133,7 +134,7 @@ private:
         ssboPositions.Update(bufferSizePositions, bufferPositions.data());
 
         size_t bufferSizeTypes = numLights * sizeof(int32_t);
-        std::vector<int32_t> bufferTypes(numLights);
+        FrameVector<int32_t> bufferTypes(numLights);
 
         for (size_t i = 0; i < lights.size(); ++i) {
             bufferTypes[i] = static_cast<int32_t>(lights[i].second.type);
@@ -141,7 +142,7 @@ private:
         ssboTypes.Update(bufferSizeTypes, bufferTypes.data());
 
         size_t bufferSizeColors = numLights * sizeof(glm::vec4);
-        std::vector<int8_t> bufferColors(bufferSizeColors);
+        FrameVector<int8_t> bufferColors(bufferSizeColors);
         for (size_t i = 0; i < lights.size(); ++i) {
             std::memcpy(bufferColors.data() + (i * sizeof(glm::vec4)), &lights[i].second.color, sizeof(glm::vec4));
         }
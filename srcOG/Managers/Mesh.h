@@ -5,26 +5,16 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include <meshoptimizer.h>
-
+#include "MeshOptimize.h"
 #include "../LoadShader.h"
 #include "../PhysX.h"
+#include "../../src/Backend/MemoryTracker.h"
+#include "../../src/Renderer/Buffer.h"
 
 #include <string>
 #include <vector>
 #include <array>
-
-#define MAX_BONE_INFLUENCE 4
-
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
-    glm::vec3 Tangent;
-    glm::vec3 Bitangent;
-    int m_BoneIDs[MAX_BONE_INFLUENCE];
-    float m_Weights[MAX_BONE_INFLUENCE];
-};
+#include <cstdio>
 
 struct Texture {
     unsigned int id;
@@ -32,12 +22,36 @@ struct Texture {
     std::string path;
 };
 
+// Every mesh shares one vertex/index buffer pair and VAO, a draw is a base vertex/index into it
+inline Handle<GeometryBuffer> GetMeshGeometryHandle()
+{
+    static Handle<GeometryBuffer> s_Geometry = GeometryBuffer::Create({
+        { ShaderDataType::Float3, "aPos" },
+        { ShaderDataType::Float3, "aNormal" },
+        { ShaderDataType::Float2, "aTexCoords" },
+        { ShaderDataType::Float3, "tangent" },
+        { ShaderDataType::Float3, "bitangent" },
+        { ShaderDataType::Int4,   "boneIds" },
+        { ShaderDataType::Float4, "weights" }
+    }, 256 * 1024, 1024 * 1024);
+    GABGL_ASSERT(s_Geometry->GetLayout().GetStride() == sizeof(Vertex), "Mesh geometry layout does not match Vertex!");
+    return s_Geometry;
+}
+
+inline GeometryBuffer& GetMeshGeometry()
+{
+    return *GetMeshGeometryHandle();
+}
+
 struct Mesh {
 
     std::vector<Vertex> vertices;
     std::vector<GLuint> indices;
     std::vector<Texture> textures;
-    GLuint VAO;
+    uint32_t geometryID = GeometryBuffer::InvalidMesh;
+    // Local space bounds, the indirect path culls with them on the GPU
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
 
     PxTriangleMesh* physxMesh = nullptr;
 
@@ -50,30 +64,45 @@ struct Mesh {
     }
 
     void Draw(const Shader& shader) {
-        std::unordered_map<std::string, GLuint> textureCounters = {
-            {"texture_diffuse", 1},
-            {"texture_specular", 1},
-            {"texture_normal", 1},
-            {"texture_height", 1}
-        };
+        BindTextures(textures, shader);
+
+        // The state cache drops the VAO bind when the previous mesh already used the shared one
+        GeometryBuffer& geometry = GetMeshGeometry();
+        geometry.Bind();
+        geometry.Draw(geometryID);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // Also used by ModelManager for indirect batches, which share one texture set
+    static void BindTextures(const std::vector<Texture>& textures, const Shader& shader) {
+        static constexpr const char* textureTypes[] = { "texture_diffuse", "texture_specular", "texture_normal", "texture_height" };
+        GLuint textureCounters[std::size(textureTypes)] = { 1, 1, 1, 1 };
+
+        char uniformName[64];
 
         for (GLuint i = 0; i < textures.size(); i++) {
             glActiveTexture(GL_TEXTURE0 + i);
 
-            std::string number = std::to_string(textureCounters[textures[i].type]++);
-            shader.setInt(textures[i].type + number, i);
+            size_t t = 0;
+            while (t < std::size(textureTypes) && textures[i].type != textureTypes[t])
+                t++;
+
+            if (t < std::size(textureTypes)) {
+                std::snprintf(uniformName, sizeof(uniformName), "%s%u", textureTypes[t], textureCounters[t]++);
+            }
+            else {
+                // Other types are numbered from 0 in the order they appear, as they always were
+                GLuint number = 0;
+                for (GLuint j = 0; j < i; j++)
+                    number += textures[j].type == textures[i].type;
+                std::snprintf(uniformName, sizeof(uniformName), "%s%u", textures[i].type.c_str(), number);
+            }
+            shader.setInt(UniformName(uniformName), i);
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
-
-        // Draw the mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<GLuint>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-        glActiveTexture(GL_TEXTURE0);
     }
 
 private:
-    GLuint VBO, EBO;
 
     void createPhysXMesh() {
         
@@ -111,81 +140,18 @@ private:
 
     void optimizeMesh()
     {
-        meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
-
-        meshopt_optimizeOverdraw(
-            indices.data(), 
-            indices.data(), 
-            indices.size(), 
-            &vertices[0].Position.x, 
-            vertices.size(), 
-            sizeof(Vertex), 
-            1.05f // Overdraw threshold (1.0 = minimal overdraw)
-        );
-
-        std::vector<Vertex> optimizedVertices(vertices.size());
-        meshopt_optimizeVertexFetch(
-            optimizedVertices.data(), 
-            indices.data(), 
-            indices.size(), 
-            vertices.data(), 
-            vertices.size(), 
-            sizeof(Vertex)
-        );
-
-        vertices = std::move(optimizedVertices);
+        ::optimizeMesh(vertices, indices);
     }
 
     void setupMesh()
     {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-
-        // Load data into vertex buffers
-        bindAndBufferData(GL_ARRAY_BUFFER, VBO, vertices.size() * sizeof(Vertex), &vertices[0]);
-        bindAndBufferData(GL_ELEMENT_ARRAY_BUFFER, EBO, indices.size() * sizeof(unsigned int), &indices[0]);
-
-        // Set up vertex attributes
-        setupVertexAttributes();
-
-        glBindVertexArray(0);
-    }
-
-    void bindAndBufferData(GLenum bufferType, unsigned int& buffer, GLsizeiptr size, const void* data)
-    {
-        glBindBuffer(bufferType, buffer);
-        glBufferData(bufferType, size, data, GL_STATIC_DRAW);
-    }
-
-    void setupVertexAttributes()
-    {
-        struct Attribute {
-            GLint size;
-            GLenum type;
-            GLboolean normalized;
-            size_t offset;
-        };
-
-        std::array<Attribute, 7> attributes = { {
-            {3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position)},
-            {3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Normal)},
-            {2, GL_FLOAT, GL_FALSE, offsetof(Vertex, TexCoords)},
-            {3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Tangent)},
-            {3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Bitangent)},
-            {4, GL_INT, GL_FALSE, offsetof(Vertex, m_BoneIDs)},
-            {4, GL_FLOAT, GL_FALSE, offsetof(Vertex, m_Weights)}
-        } };
-
-        for (size_t i = 0; i < attributes.size(); ++i) {
-            glEnableVertexAttribArray(static_cast<GLuint>(i));
-            if (attributes[i].type == GL_INT) {
-                glVertexAttribIPointer(static_cast<GLuint>(i), attributes[i].size, attributes[i].type, sizeof(Vertex), (void*)attributes[i].offset);
-            } else {
-                glVertexAttribPointer(static_cast<GLuint>(i), attributes[i].size, attributes[i].type, attributes[i].normalized, sizeof(Vertex), (void*)attributes[i].offset);
+        if (!vertices.empty()) {
+            boundsMin = boundsMax = vertices[0].Position;
+            for (const Vertex& vertex : vertices) {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
             }
         }
+        geometryID = GetMeshGeometry().Upload(vertices.data(), (uint32_t)vertices.size(), indices.data(), (uint32_t)indices.size());
     }
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <meshoptimizer.h>
+
+#include <vector>
+
+#define MAX_BONE_INFLUENCE 4
+
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+    glm::vec3 Tangent;
+    glm::vec3 Bitangent;
+    int m_BoneIDs[MAX_BONE_INFLUENCE];
+    float m_Weights[MAX_BONE_INFLUENCE];
+};
+
+// Kept free of GL so it can be run (and benchmarked) without a context
+inline void optimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
+
+    meshopt_optimizeOverdraw(
+        indices.data(), 
+        indices.data(), 
+        indices.size(), 
+        &vertices[0].Position.x, 
+        vertices.size(), 
+        sizeof(Vertex), 
+        1.05f // Overdraw threshold (1.0 = minimal overdraw)
+    );
+
+    std::vector<Vertex> optimizedVertices(vertices.size());
+    meshopt_optimizeVertexFetch(
+        optimizedVertices.data(), 
+        indices.data(), 
+        indices.size(), 
+        vertices.data(), 
+        vertices.size(), 
+        sizeof(Vertex)
+    );
+
+    vertices = std::move(optimizedVertices);
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "AnimatedModel.h"
 #include "StaticModel.h"
+#include "../../src/Renderer/IndirectDraw.h"
+#include <map>
 #include <optional>
 
 struct ModelManager {
@@ -13,6 +15,7 @@ struct ModelManager {
 
         std::unique_ptr<StaticModel> newModel = std::make_unique<StaticModel>(modelpath);
         vec_staticModels.emplace_back(std::move(newModel), modelData);
+        RegisterIndirect(vec_staticModels.back());
     }
 
     void AddModelAnimated(const std::string& modelpath, const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f))
@@ -44,6 +47,11 @@ struct ModelManager {
             modelData.scale = newScale.value();
         }
 
+        if (indirectList) {
+            glm::mat4 transform = ToMatrix(modelData);
+            for (uint32_t object : modelData.indirectObjects)
+                indirectList->SetTransform(object, transform);
+        }
     }
   
     void EditAnimatedModel(int index, const std::optional<glm::vec3>& newPosition = std::nullopt, const std::optional<glm::vec3>& newRotation = std::nullopt, const std::optional<glm::vec3>& newScale = std::nullopt)
@@ -72,6 +80,10 @@ struct ModelManager {
     void RemoveStaticModel(int index)
     {
         if (index >= 0 && index < vec_staticModels.size()) {
+            if (indirectList) {
+                for (uint32_t object : vec_staticModels[index].second.indirectObjects)
+                    indirectList->RemoveObject(object);
+            }
             vec_staticModels.erase(vec_staticModels.begin() + index);
         }
     }
@@ -83,11 +95,30 @@ struct ModelManager {
         }
     }
 
-    void RenderModels()
+    void RenderModels(const glm::mat4& viewProjection)
     {
-        // Render static models
-        for (const auto& modelPair : vec_staticModels) {
-            modelPair.first->Render(modelPair.second.position, modelPair.second.rotation, modelPair.second.scale);
+        // Render static models, one culled multi-draw per texture set when the GPU can do it.
+        // Until the cull program has compiled they are drawn one by one instead
+        if (indirectList && indirectList->IsReady()) {
+            indirectList->Cull(viewProjection);
+
+            Shader& shader = Utilities::g_shaders.modelIndirect;
+            shader.Use();
+            shader.setFloat("light.constant", 1.0f);
+            shader.setFloat("light.linear", 0.09f);
+            shader.setFloat("light.quadratic", 0.032f);
+            shader.setFloat("material.shininess", 32.0f);
+
+            for (const auto& [key, batch] : indirectBatches) {
+                Mesh::BindTextures(batch.textures, shader);
+                indirectList->Draw(batch.batch);
+            }
+            glActiveTexture(GL_TEXTURE0);
+        }
+        else {
+            for (const auto& modelPair : vec_staticModels) {
+                modelPair.first->Render(modelPair.second.position, modelPair.second.rotation, modelPair.second.scale);
+            }
         }
 
         // Render animated models
@@ -102,8 +133,51 @@ struct ModelManager {
         glm::vec3 position;
         glm::vec3 scale;
         glm::vec3 rotation;
+        std::vector<uint32_t> indirectObjects;
+    };
+
+    struct IndirectBatch
+    {
+        uint32_t batch;
+        std::vector<Texture> textures;
     };
 
     std::vector<std::pair<std::unique_ptr<StaticModel>, ModelData>> vec_staticModels;
     std::vector<std::pair<std::unique_ptr<AnimatedModel>, ModelData>> vec_animatedModels;
+
+    Handle<IndirectDrawList> indirectList;
+    // Keyed by texture ids, meshes with the same textures share a batch
+    std::map<std::vector<GLuint>, IndirectBatch> indirectBatches;
+
+private:
+
+    static glm::mat4 ToMatrix(const ModelData& modelData)
+    {
+        Utilities::Transform transform;
+        transform.position = modelData.position;
+        transform.rotation = modelData.rotation;
+        transform.scale = modelData.scale;
+        return transform.to_mat4();
+    }
+
+    void RegisterIndirect(std::pair<std::unique_ptr<StaticModel>, ModelData>& modelPair)
+    {
+        if (!IndirectDrawList::IsSupported())
+            return;
+        if (!indirectList)
+            indirectList = IndirectDrawList::Create(GetMeshGeometryHandle());
+
+        glm::mat4 transform = ToMatrix(modelPair.second);
+        for (const Mesh& mesh : modelPair.first->GetMeshes()) {
+            std::vector<GLuint> key;
+            for (const Texture& texture : mesh.textures)
+                key.push_back(texture.id);
+
+            auto batch = indirectBatches.find(key);
+            if (batch == indirectBatches.end())
+                batch = indirectBatches.emplace(std::move(key), IndirectBatch{ indirectList->AddBatch(), mesh.textures }).first;
+
+            modelPair.second.indirectObjects.push_back(indirectList->AddObject(batch->second.batch, mesh.geometryID, transform, mesh.boundsMin, mesh.boundsMax));
+        }
+    }
 };
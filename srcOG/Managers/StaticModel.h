@@ -19,6 +19,7 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map> 
+#include "../../src/Backend/MemoryTracker.h"
 
 
 struct StaticModel {
@@ -27,6 +28,7 @@ struct StaticModel {
 
     StaticModel(const std::string& modelpath, bool gamma = false) : gammaCorrection(gamma)
     {
+        GABGL_MEMORY_TAG(Assets);
         loadModel(modelpath);
     }
 
@@ -35,7 +37,6 @@ struct StaticModel {
     void Render(const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f))
     {
         _shader.Use();
-        _shader.setVec3("viewPos", this->_camera.Position);
 
         // light properties
         _shader.setFloat("light.constant", 1.0f);
@@ -45,11 +46,6 @@ struct StaticModel {
         // material properties
         _shader.setFloat("material.shininess", 32.0f);
         
-        glm::mat4 projection = glm::perspective(glm::radians(this->_camera.Zoom), Window::getAspectRatio(), 0.001f, 2000.0f);
-        _shader.setMat4("projection", projection);
-
-        _shader.setMat4("view", this->_camera.GetViewMatrix());
-
         Utilities::Transform transform;
         transform.position = position;
         transform.rotation = rotation;
@@ -68,12 +64,13 @@ struct StaticModel {
             mesh.Draw(shader);
     }
 
+    const std::vector<Mesh>& GetMeshes() const { return meshes; }
+
 private:
 
     Camera& _camera = Window::_camera;
     Shader& _shader = Utilities::g_shaders.model;
 
-    std::unordered_map<std::string, Texture> textures_loaded; 
     std::vector<Mesh> meshes;
     std::string directory;
     bool gammaCorrection;
@@ -162,20 +159,13 @@ private:
             mat->GetTexture(type, i, &str);
             std::string texturePath = str.C_Str();
 
-            // Check if texture is already loaded
-            if (textures_loaded.find(texturePath) != textures_loaded.end()) {
-                textures.emplace_back(textures_loaded[texturePath]);
-                continue;
-            }
-
-            // Load texture
+            // TextureFromFile shares one GL texture per file across every model
             Texture texture;
             texture.id = TextureFromFile(texturePath.c_str(), directory);
             texture.type = typeName;
             texture.path = texturePath;
 
             textures.emplace_back(texture);
-            textures_loaded[texturePath] = texture;
         }
     }
 };
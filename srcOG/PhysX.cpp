@@ -1,21 +1,36 @@
 #include "PhysX.h"
-#include <iostream>
 #include <vector>
 #include "Input/Input.h"
+#include "../src/Backend/BackendLogger.h"
+#include "../src/Backend/FrameArena.h"
+#include "../src/Backend/MemoryTracker.h"
+#include <new>
 
 namespace PhysX {
 
     struct UserErrorCallback : public PxErrorCallback
     {
         virtual void reportError(PxErrorCode::Enum /*code*/, const char* message, const char* file, int line) {
-            std::cout << file << " line " << line << ": " << message << "\n";
-            std::cout << "\n";
+            GABGL_ERROR("{0} line {1}: {2}", file, line, message);
         }
     }gErrorCallback;
 
     #define PVD_HOST "127.0.0.1"
 
-    PxDefaultAllocator		gAllocator;
+    // Routes PhysX heap traffic through operator new so it shows up under the Physics tag
+    struct TrackedAllocator : public PxAllocatorCallback
+    {
+        void* allocate(size_t size, const char*, const char*, int) override {
+            MemoryTagScope tag(MemoryTag::Physics);
+            return ::operator new(size, std::align_val_t(16), std::nothrow);
+        }
+
+        void deallocate(void* ptr) override {
+            ::operator delete(ptr, std::align_val_t(16));
+        }
+    };
+
+    TrackedAllocator		gAllocator;
     PxFoundation*			gFoundation = nullptr;
     PxPhysics*				gPhysics	= nullptr;
     PxDefaultCpuDispatcher*	gDispatcher = nullptr;
@@ -34,9 +49,11 @@ namespace PhysX {
 
 void PhysX::Init()
 {
+    GABGL_MEMORY_TAG(Physics);
+
     gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
     if (!gFoundation) {
-        std::cout << "PxCreateFoundation failed!\n";
+        GABGL_CRITICAL("PxCreateFoundation failed!");
     }
     gPvd = PxCreatePvd(*gFoundation);
     PxPvdTransport* transport = PxDefaultPvdSocketTransportCreate(PVD_HOST, 5425, 10);
@@ -44,7 +61,7 @@ void PhysX::Init()
 
     gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale(), true, gPvd);
     if (!gPhysics) {
-      std::cout << "PxCreatePhysics failed!\n";
+      GABGL_CRITICAL("PxCreatePhysics failed!");
     }
 
     PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
@@ -84,10 +101,11 @@ void PhysX::RenderActors(const Shader& shader, unsigned int vao)
     PxU32 nbActors = gScene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC);
     if(nbActors)
     {
-      std::vector<PxRigidActor*> actors(nbActors);
-      gScene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC, reinterpret_cast<PxActor**>(&actors[0]), nbActors);
+      PxRigidActor** actors = FrameArena::Allocate<PxRigidActor*>(nbActors);
+      gScene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC, reinterpret_cast<PxActor**>(actors), nbActors);
 
-      for (PxRigidActor* actor : actors){
+      for (PxU32 i = 0; i < nbActors; i++){
+        PxRigidActor* actor = actors[i];
         const PxU32 nbShapes = actor->getNbShapes();
         PxShape* shapes[32];
         actor->getShapes(shapes,nbShapes);
@@ -106,7 +124,7 @@ void PhysX::RenderActors(const Shader& shader, unsigned int vao)
             glm::mat4 model = Utilities::PxMat44ToGlmMat4(actor->getGlobalPose()) * transform.to_mat4();
 
             shader.setMat4("model",model);
-            glBindVertexArray(vao);
+            RendererAPI::BindVertexArray(vao);
             glDrawArrays(GL_TRIANGLES, 0, 36);
           }
         }
@@ -57,7 +57,7 @@ void Scene::Init()
 {
   Utilities::Timer timer;
 
-  stbi_set_flip_vertically_on_load(true);
+  stbi_set_flip_vertically_on_load_thread(true);
 
   // Init subsystems
   Input::Init();
@@ -66,6 +66,7 @@ void Scene::Init()
   PhysX::Init();
 
   Utilities::BakeShaders();
+  frameUniforms = UniformBuffer::Create(sizeof(FrameUniforms), UniformBinding::Frame);
   Utilities::LoadSounds();
 
   editor.Init();
@@ -80,7 +81,7 @@ void Scene::Init()
         glGenVertexArrays(1, &_VAO);
         glGenBuffers(1, &_VBO);
 
-        glBindVertexArray(_VAO);
+        RendererAPI::BindVertexArray(_VAO);
 
         glBindBuffer(GL_ARRAY_BUFFER, _VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -97,6 +98,16 @@ void Scene::Init()
 
 void Scene::Render()
 {
+    // Camera data goes up once here, the model, light and skybox shaders all read the Frame block
+    Camera& camera = Window::_camera;
+    FrameUniforms frame;
+    frame.View = camera.GetViewMatrix();
+    frame.Projection = glm::perspective(glm::radians(camera.Zoom), Window::getAspectRatio(), 0.001f, 2000.0f);
+    frame.ViewProjection = frame.Projection * frame.View;
+    frame.CameraPosition = glm::vec4(camera.Position, 1.0f);
+    frame.Time = glm::vec4((float)glfwGetTime(), Window::getDeltaTime(), 0.0f, 0.0f);
+    frameUniforms->SetData(&frame, sizeof(FrameUniforms));
+
     bloom.Bind();
     glEnable(GL_DEPTH_TEST);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -106,7 +117,7 @@ void Scene::Render()
     glFrontFace(GL_CW);
 
     lightManager.RenderLights();
-    modelManager.RenderModels();
+    modelManager.RenderModels(frame.ViewProjection);
 
     PhysX::RenderActors(Utilities::g_shaders.model,_VAO);
     PhysX::raycastAndApplyForce(PhysX::getScene(), Window::_camera.Position, Window::_camera.Front, 250.0f);
@@ -5,6 +5,7 @@
 #include "Managers/LightManager.h"
 #include "Managers/ModelManager.h"
 #include "SceneEditor.h"
+#include "../src/Renderer/Buffer.h"
 
 struct Scene {
 
@@ -24,4 +25,5 @@ private:
     SceneEditor editor;
     EnvironmentMap envmap;
     BloomRenderer bloom;
+    Handle<UniformBuffer> frameUniforms;
 };
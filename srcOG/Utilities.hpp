@@ -18,6 +18,7 @@ namespace Utilities {
   struct Shaders 
   {
     Shader model;
+    Shader modelIndirect;
     Shader skybox;
     Shader animated;
     Shader light;
@@ -39,6 +40,8 @@ namespace Utilities {
   inline void BakeShaders()
   {
     g_shaders.model.Load("../res/shaders/model.glsl");
+    // Same shader reading its transform from the IndirectDrawList object buffer
+    g_shaders.modelIndirect.Load("../res/shaders/model.glsl", ~g_shaders.model.GetVariantMask({ "PER_DRAW_TRANSFORM" }));
     g_shaders.animated.Load("../res/shaders/anim_model.glsl");
     g_shaders.skybox.Load("../res/shaders/skybox.glsl");
     g_shaders.light.Load("../res/shaders/light.glsl");
@@ -0,0 +1,264 @@
+#include "../src/Backend/BackendLogger.h"
+#include "../src/Renderer/Shader.h"
+#include "../src/Renderer/ShaderSpirv.h"
+#include "../src/Renderer/ShaderVariant.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Offline shader cooking, run by the cook_shaders build target.
+//
+//   gl_shader_cooker [--glslang path] [--spirv-opt path] <shader directory>
+//
+// Every "#type" section of every .glsl in the directory is validated as GLSL, a failure fails
+// the build. The sections are then compiled to SPIR-V for OpenGL and written to
+// cooked/<name>.spv, which Shader loads instead of the source when GL_ARB_gl_spirv is present.
+// Shaders with uniforms outside a block and without an explicit location can't be expressed in
+// OpenGL SPIR-V, those are skipped and keep compiling from GLSL at runtime.
+
+namespace Utils {
+
+	struct CookerConfig
+	{
+		std::string Glslang = "glslangValidator";
+		std::string SpirvOpt;
+		std::filesystem::path ShaderDir;
+	};
+
+	struct CookerStage
+	{
+		const char* Type;
+		const char* Extension;
+		GLenum Stage;
+	};
+
+	static constexpr CookerStage s_CookerStages[] = {
+		{ "VERTEX",          "vert", GL_VERTEX_SHADER },
+		{ "FRAGMENT",        "frag", GL_FRAGMENT_SHADER },
+		{ "GEOMETRY",        "geom", GL_GEOMETRY_SHADER },
+		{ "TESS_CONTROL",    "tesc", GL_TESS_CONTROL_SHADER },
+		{ "TESS_EVALUATION", "tese", GL_TESS_EVALUATION_SHADER },
+		{ "COMPUTE",         "comp", GL_COMPUTE_SHADER },
+	};
+
+	static bool ParseArgs(int argc, char** argv, CookerConfig& config)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			bool hasValue = i + 1 < argc;
+			if (arg == "--glslang" && hasValue)
+				config.Glslang = argv[++i];
+			else if (arg == "--spirv-opt" && hasValue)
+				config.SpirvOpt = argv[++i];
+			else if (arg.rfind("--", 0) != 0 && config.ShaderDir.empty())
+				config.ShaderDir = arg;
+			else
+				return false;
+		}
+		return !config.ShaderDir.empty();
+	}
+
+	static std::string Quote(const std::filesystem::path& path)
+	{
+		return "\"" + path.string() + "\"";
+	}
+
+	static bool Run(const std::string& command)
+	{
+#ifdef _WIN32
+		// cmd.exe strips the outer quotes of a command line that starts with one
+		return std::system(("\"" + command + "\"").c_str()) == 0;
+#else
+		return std::system(command.c_str()) == 0;
+#endif
+	}
+
+	static bool ReadText(const std::filesystem::path& path, std::string& content)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+			return false;
+		std::stringstream stream;
+		stream << file.rdbuf();
+		content = stream.str();
+		return true;
+	}
+
+	static bool WriteText(const std::filesystem::path& path, const std::string& content)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		file << content;
+		return (bool)file;
+	}
+
+	static bool ReadWords(const std::filesystem::path& path, std::vector<uint32_t>& words)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return false;
+		std::streamsize size = file.tellg();
+		if (size <= 0 || size % sizeof(uint32_t) != 0)
+			return false;
+		words.resize((size_t)size / sizeof(uint32_t));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(words.data()), size);
+		return (bool)file;
+	}
+
+	enum class CookResult
+	{
+		Cooked,
+		Skipped,
+		Failed
+	};
+
+	static CookResult CookShader(const CookerConfig& config, const std::filesystem::path& shaderPath, const std::filesystem::path& workDir)
+	{
+		std::string fileContent;
+		if (!ReadText(shaderPath, fileContent))
+		{
+			std::cerr << shaderPath.string() << ": could not read\n";
+			return CookResult::Failed;
+		}
+
+		// Exactly what Shader::Submit builds for the all-features variant, so the hashes agree
+		std::vector<std::string> dependencies;
+		std::string source = Shader::Preprocess(shaderPath.string(), fileContent, dependencies);
+		std::vector<std::string> keywords = ShaderVariant::ParseKeywords(source);
+		if (!keywords.empty())
+			source = ShaderVariant::InjectDefines(source, keywords, ShaderVariant::AllVariants);
+
+		auto sections = Shader::ParseSources(source);
+		if (sections.empty())
+		{
+			std::cerr << shaderPath.string() << ": no #type sections\n";
+			return CookResult::Failed;
+		}
+
+		ShaderSpirv::Program program;
+		program.SourceHash = ShaderSpirv::HashSource(source);
+
+		bool valid = true, spirv = true;
+		std::string stem = shaderPath.stem().string();
+		for (const auto& stageInfo : s_CookerStages)
+		{
+			auto section = sections.find(stageInfo.Type);
+			if (section == sections.end())
+				continue;
+			// Whatever is left afterwards has a type this table doesn't know
+			std::string stageSource = std::move(section->second);
+			sections.erase(section);
+
+			std::filesystem::path stagePath = workDir / (stem + "." + stageInfo.Extension + ".glsl");
+			std::filesystem::path spirvPath = workDir / (stem + "." + stageInfo.Extension + ".spv");
+			std::filesystem::path logPath = workDir / (stem + "." + stageInfo.Extension + ".log");
+			if (!WriteText(stagePath, stageSource))
+			{
+				std::cerr << stagePath.string() << ": could not write\n";
+				return CookResult::Failed;
+			}
+
+			std::string stageArg = std::string(" -S ") + stageInfo.Extension + " ";
+			if (!Run(Quote(config.Glslang) + stageArg + Quote(stagePath)))
+			{
+				std::cerr << shaderPath.string() << ": " << stageInfo.Type << " stage failed to compile\n";
+				valid = false;
+				continue;
+			}
+
+			if (!spirv)
+				continue;
+			if (!Run(Quote(config.Glslang) + " -G" + stageArg + "-o " + Quote(spirvPath) + " " + Quote(stagePath) + " > " + Quote(logPath) + " 2>&1"))
+			{
+				std::cout << shaderPath.string() << ": " << stageInfo.Type << " stage is not valid OpenGL SPIR-V, keeping GLSL (see " << logPath.string() << ")\n";
+				spirv = false;
+				continue;
+			}
+			if (!config.SpirvOpt.empty() && !Run(Quote(config.SpirvOpt) + " -O --target-env=opengl4.5 " + Quote(spirvPath) + " -o " + Quote(spirvPath)))
+				std::cout << shaderPath.string() << ": spirv-opt failed on the " << stageInfo.Type << " stage, keeping the unoptimized module\n";
+
+			ShaderSpirv::Stage stage;
+			stage.Type = stageInfo.Stage;
+			stage.ConstantIDs = ShaderSpirv::FindConstantIDs(stageSource);
+			if (!ReadWords(spirvPath, stage.Code))
+			{
+				std::cerr << spirvPath.string() << ": could not read the SPIR-V module\n";
+				return CookResult::Failed;
+			}
+			program.Stages.push_back(std::move(stage));
+		}
+
+		for (const auto& [type, section] : sections)
+		{
+			std::cerr << shaderPath.string() << ": unknown shader type " << type << "\n";
+			valid = false;
+		}
+
+		std::string cookedPath = ShaderSpirv::GetCookedPath(shaderPath.string());
+		if (!valid || !spirv)
+		{
+			// A cook left over from an older version of the file would only be rejected by hash
+			std::error_code error;
+			std::filesystem::remove(cookedPath, error);
+			return valid ? CookResult::Skipped : CookResult::Failed;
+		}
+
+		if (!ShaderSpirv::Write(cookedPath, program))
+		{
+			std::cerr << cookedPath << ": could not write\n";
+			return CookResult::Failed;
+		}
+		return CookResult::Cooked;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Utils::CookerConfig config;
+	if (!Utils::ParseArgs(argc, argv, config))
+	{
+		std::cerr << "usage: gl_shader_cooker [--glslang path] [--spirv-opt path] <shader directory>\n";
+		return 1;
+	}
+
+	Log::Init();
+
+	std::error_code error;
+	std::filesystem::path workDir = std::filesystem::temp_directory_path(error) / "gl_shader_cooker";
+	std::filesystem::create_directories(workDir, error);
+	if (error)
+	{
+		std::cerr << "could not create " << workDir.string() << ": " << error.message() << "\n";
+		return 1;
+	}
+
+	uint32_t cooked = 0, skipped = 0, failed = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(config.ShaderDir, error))
+	{
+		// Only top-level files are shaders, include/ holds fragments that don't build on their own
+		if (!entry.is_regular_file() || entry.path().extension() != ".glsl")
+			continue;
+
+		switch (Utils::CookShader(config, entry.path(), workDir))
+		{
+		case Utils::CookResult::Cooked:  cooked++;  break;
+		case Utils::CookResult::Skipped: skipped++; break;
+		case Utils::CookResult::Failed:  failed++;  break;
+		}
+	}
+
+	if (error)
+	{
+		std::cerr << "could not list " << config.ShaderDir.string() << ": " << error.message() << "\n";
+		return 1;
+	}
+
+	std::cout << "Shaders: " << cooked << " cooked to SPIR-V, " << skipped << " kept as GLSL, " << failed << " failed\n";
+	return failed > 0 ? 1 : 0;
+}